@@ -284,6 +284,7 @@ cmd_ac_init(void)
 
     log_ac = autocomplete_new();
     autocomplete_add(log_ac, "maxsize");
+    autocomplete_add(log_ac, "flush");
     autocomplete_add(log_ac, "rotate");
     autocomplete_add(log_ac, "shared");
     autocomplete_add(log_ac, "where");
@@ -713,6 +714,7 @@ cmd_ac_init(void)
     autocomplete_add(plugins_ac, "unload");
     autocomplete_add(plugins_ac, "reload");
     autocomplete_add(plugins_ac, "python_version");
+    autocomplete_add(plugins_ac, "stats");
 
     filepath_ac = autocomplete_new();
 
@@ -787,6 +789,14 @@ cmd_ac_remove_alias_value(char *value)
     }
 }
 
+void
+cmd_ac_mark_used(const char *const value)
+{
+    if (commands_ac) {
+        autocomplete_mark_used(commands_ac, value);
+    }
+}
+
 void
 cmd_ac_remove(const char *const value)
 {
@@ -857,7 +867,11 @@ cmd_ac_complete(ProfWin *window, const char *const input)
     // autocomplete command
     if ((strncmp(input, "/", 1) == 0) && (!str_contains(input, strlen(input), ' '))) {
         char *found = NULL;
-        found = autocomplete_complete(commands_ac, input, TRUE);
+        if (prefs_get_boolean(PREF_COMPLETION_FUZZY)) {
+            found = autocomplete_complete_fuzzy(commands_ac, input, TRUE);
+        } else {
+            found = autocomplete_complete(commands_ac, input, TRUE);
+        }
         if (found) {
             return found;
         }
@@ -1240,7 +1254,7 @@ _cmd_ac_complete_params(ProfWin *window, const char *const input)
 
     // autocomplete boolean settings
     gchar *boolean_choices[] = { "/beep", "/intype", "/states", "/outtype", "/flash", "/splash", "/chlog", "/grlog",
-        "/history", "/vercheck", "/privileges", "/wrap", "/winstidy", "/carbons", "/encwarn",
+        "/history", "/vercheck", "/privileges", "/wrap", "/fuzzy", "/winstidy", "/carbons", "/encwarn",
         "/lastactivity" };
 
     for (i = 0; i < ARRAY_SIZE(boolean_choices); i++) {
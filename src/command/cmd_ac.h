@@ -51,6 +51,8 @@ void cmd_ac_remove(const char *const value);
 void cmd_ac_remove_help(const char *const value);
 void cmd_ac_remove_alias_value(char *value);
 
+void cmd_ac_mark_used(const char *const value);
+
 gboolean cmd_ac_exists(char *cmd);
 
 void cmd_ac_add_form_fields(DataForm *form);
@@ -866,6 +866,26 @@ static struct cmd_t command_defs[] =
             "/sendfile ~/images/sweet_cat.jpg")
     },
 
+    { "/search",
+        parse_args_with_freetext, 1, 1, NULL,
+        CMD_NOSUBFUNCS
+        CMD_MAINFUNC(cmd_search)
+        CMD_TAGS(
+            CMD_TAG_CHAT,
+            CMD_TAG_GROUPCHAT)
+        CMD_SYN(
+            "/search <text>")
+        CMD_DESC(
+            "Search the chat and room logs of the current account. "
+            "Lines containing all of the words are shown, most recent last. "
+            "Logs written before the index existed are indexed in the background after connecting.")
+        CMD_ARGS(
+            { "<text>", "The words to search for." })
+        CMD_EXAMPLES(
+            "/search meeting",
+            "/search release notes")
+    },
+
     { "/lastactivity",
         parse_args, 0, 1, NULL,
         CMD_NOSUBFUNCS
@@ -1245,6 +1265,23 @@ static struct cmd_t command_defs[] =
         CMD_NOEXAMPLES
     },
 
+    { "/fuzzy",
+        parse_args, 1, 1, &cons_fuzzy_setting,
+        CMD_NOSUBFUNCS
+        CMD_MAINFUNC(cmd_fuzzy)
+        CMD_TAGS(
+            CMD_TAG_UI)
+        CMD_SYN(
+            "/fuzzy on|off")
+        CMD_DESC(
+            "Fuzzy tab completion of commands, contacts, room occupants and bookmarked rooms. "
+            "When enabled, any item containing the typed characters in order is offered, "
+            "best matches and most used items first.")
+        CMD_ARGS(
+            { "on|off", "Enable or disable fuzzy completion." })
+        CMD_NOEXAMPLES
+    },
+
     { "/time",
         parse_args, 1, 3, &cons_time_setting,
         CMD_NOSUBFUNCS
@@ -1304,6 +1341,23 @@ static struct cmd_t command_defs[] =
         CMD_NOEXAMPLES
     },
 
+    { "/maxfps",
+        parse_args, 1, 1, &cons_maxfps_setting,
+        CMD_NOSUBFUNCS
+        CMD_MAINFUNC(cmd_maxfps)
+        CMD_TAGS(
+            CMD_TAG_UI)
+        CMD_SYN(
+            "/maxfps <frames>")
+        CMD_DESC(
+            "Maximum number of times per second the screen is redrawn. "
+            "The screen is only redrawn when something has changed.")
+        CMD_ARGS(
+            { "<frames>", "Frames per second (1-100), default: 30." })
+        CMD_EXAMPLES(
+            "/maxfps 10")
+    },
+
     { "/notify",
         parse_args_with_freetext, 0, 4, NULL,
         CMD_NOSUBFUNCS
@@ -1729,14 +1783,16 @@ static struct cmd_t command_defs[] =
             "/log where",
             "/log rotate on|off",
             "/log maxsize <bytes>",
-            "/log shared on|off")
+            "/log shared on|off",
+            "/log flush <seconds>")
         CMD_DESC(
             "Manage profanity log settings.")
         CMD_ARGS(
             { "where",           "Show the current log file location." },
             { "rotate on|off",   "Rotate log, default on." },
             { "maxsize <bytes>", "With rotate enabled, specifies the max log size, defaults to 1048580 (1MB)." },
-            { "shared on|off",   "Share logs between all instances, default: on. When off, the process id will be included in the log filename." })
+            { "shared on|off",   "Share logs between all instances, default: on. When off, the process id will be included in the log filename." },
+            { "flush <seconds>", "Write chat and room logs to disk at most every <seconds>, defaults to 0 (after every message)." })
         CMD_NOEXAMPLES
     },
 
@@ -1988,7 +2044,8 @@ static struct cmd_t command_defs[] =
             "/plugins unload <plugin>",
             "/plugins load <plugin>",
             "/plugins reload [<plugin>]",
-            "/plugins python_version")
+            "/plugins python_version",
+            "/plugins stats")
         CMD_DESC(
             "Manage plugins. Passing no arguments lists currently loaded plugins.")
         CMD_ARGS(
@@ -1996,7 +2053,8 @@ static struct cmd_t command_defs[] =
             { "load <plugin>",       "Load a plugin that already exists in the plugin directory." },
             { "unload <plugin>",     "Unload a loaded plugin." },
             { "reload [<plugin>]",   "Reload a plugin, passing no argument will reload all plugins." },
-            { "python_version",      "Show the Python interpreter version." })
+            { "python_version",      "Show the Python interpreter version." },
+            { "stats",               "Show how many plugins handle each stanza hook, and the time spent in them." })
         CMD_EXAMPLES(
             "/plugins install /home/steveharris/Downloads/metal.py",
             "/plugins load browser.py",
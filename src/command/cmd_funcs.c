@@ -66,6 +66,7 @@
 #include "tools/autocomplete.h"
 #include "tools/parser.h"
 #include "tools/tinyurl.h"
+#include "tools/log_index.h"
 #include "plugins/plugins.h"
 #include "ui/ui.h"
 #include "ui/window_list.h"
@@ -92,6 +93,8 @@
 #include "plugins/python_plugins.h"
 #endif
 
+#define SEARCH_MAX_RESULTS 50
+
 static void _update_presence(const resource_presence_t presence,
     const char *const show, gchar **args);
 static void _cmd_set_boolean_preference(gchar *arg, const char *const command,
@@ -124,6 +127,9 @@ cmd_process_input(ProfWin *window, char *inp)
         char *question_mark = strchr(command, '?');
         if (question_mark) {
             *question_mark = '\0';
+        }
+        cmd_ac_mark_used(command);
+        if (question_mark) {
             char *fakeinp;
             if (asprintf(&fakeinp, "/help %s", command+1)) {
                 result = _cmd_execute(window, "/help", fakeinp);
@@ -4544,6 +4550,38 @@ cmd_sendfile(ProfWin *window, const char *const command, gchar **args)
     return TRUE;
 }
 
+gboolean
+cmd_search(ProfWin *window, const char *const command, gchar **args)
+{
+    jabber_conn_status_t conn_status = connection_get_status();
+
+    if (conn_status != JABBER_CONNECTED) {
+        cons_show("You are not currently connected.");
+        return TRUE;
+    }
+
+    GSList *results = log_index_search(args[0], SEARCH_MAX_RESULTS);
+    if (results == NULL) {
+        cons_show("No log lines found matching: %s", args[0]);
+    } else {
+        cons_show("Log lines matching: %s", args[0]);
+        GSList *curr = results;
+        while (curr) {
+            LogIndexResult *result = curr->data;
+            cons_show("  %s %s%s: %s", result->date, result->room ? "room " : "", result->jid, result->line);
+            curr = g_slist_next(curr);
+        }
+        g_slist_free_full(results, (GDestroyNotify)log_index_free_result);
+    }
+
+    if (log_index_backfilling()) {
+        cons_show("Older logs are still being indexed, results may be incomplete.");
+    }
+    cons_alert();
+
+    return TRUE;
+}
+
 gboolean
 cmd_lastactivity(ProfWin *window, const char *const command, gchar **args)
 {
@@ -4898,6 +4936,14 @@ cmd_wrap(ProfWin *window, const char *const command, gchar **args)
     return TRUE;
 }
 
+gboolean
+cmd_fuzzy(ProfWin *window, const char *const command, gchar **args)
+{
+    _cmd_set_boolean_preference(args[0], command, "Fuzzy completion", PREF_COMPLETION_FUZZY);
+
+    return TRUE;
+}
+
 gboolean
 cmd_time(ProfWin *window, const char *const command, gchar **args)
 {
@@ -5546,6 +5592,23 @@ cmd_inpblock(ProfWin *window, const char *const command, gchar **args)
     return TRUE;
 }
 
+gboolean
+cmd_maxfps(ProfWin *window, const char *const command, gchar **args)
+{
+    int intval = 0;
+    char *err_msg = NULL;
+    gboolean res = strtoi_range(args[0], &intval, 1, 100, &err_msg);
+    if (res) {
+        prefs_set_max_fps(intval);
+        cons_show("Maximum redraw rate set to %d frames per second.", intval);
+    } else {
+        cons_show(err_msg);
+        free(err_msg);
+    }
+
+    return TRUE;
+}
+
 gboolean
 cmd_log(ProfWin *window, const char *const command, gchar **args)
 {
@@ -5571,6 +5634,29 @@ cmd_log(ProfWin *window, const char *const command, gchar **args)
         return TRUE;
     }
 
+    if (strcmp(subcmd, "flush") == 0) {
+        if (value == NULL) {
+            cons_bad_cmd_usage(command);
+            return TRUE;
+        }
+
+        int intval = 0;
+        char *err_msg = NULL;
+        gboolean res = strtoi_range(value, &intval, 0, INT_MAX, &err_msg);
+        if (res) {
+            prefs_set_chlog_flush(intval);
+            if (intval == 0) {
+                cons_show("Chat logs will be flushed after every message.");
+            } else {
+                cons_show("Chat log flush interval set to %d seconds.", intval);
+            }
+        } else {
+            cons_show(err_msg);
+            free(err_msg);
+        }
+        return TRUE;
+    }
+
     if (strcmp(subcmd, "rotate") == 0) {
         if (value == NULL) {
             cons_bad_cmd_usage(command);
@@ -6166,6 +6252,16 @@ cmd_plugins(ProfWin *window, const char *const command, gchar **args)
 #endif
         return TRUE;
 
+    } else if (g_strcmp0(args[0], "stats") == 0) {
+        cons_show("Plugin stanza hooks:");
+        int i;
+        for (i = 0; i < PLUGIN_HOOK_COUNT; i++) {
+            const PluginHookStats *stats = plugins_get_hook_stats(i);
+            cons_show("  %-32s plugins: %d, calls: %u, total: %.3fms", stats->name, stats->subscribers, stats->calls,
+                stats->elapsed * 1000);
+        }
+        return TRUE;
+
     } else {
         GList *plugins = plugins_loaded_list();
         if (plugins == NULL) {
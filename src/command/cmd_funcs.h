@@ -88,6 +88,7 @@ gboolean cmd_connect(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_decline(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_disco(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_sendfile(ProfWin *window, const char *const command, gchar **args);
+gboolean cmd_search(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_lastactivity(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_disconnect(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_dnd(ProfWin *window, const char *const command, gchar **args);
@@ -146,9 +147,11 @@ gboolean cmd_role(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_privileges(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_presence(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_wrap(ProfWin *window, const char *const command, gchar **args);
+gboolean cmd_fuzzy(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_time(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_resource(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_inpblock(ProfWin *window, const char *const command, gchar **args);
+gboolean cmd_maxfps(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_encwarn(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_script(ProfWin *window, const char *const command, gchar **args);
 gboolean cmd_export(ProfWin *window, const char *const command, gchar **args);
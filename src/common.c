@@ -509,30 +509,40 @@ prof_occurrences(const char *const needle, const char *const haystack, int offse
         return *result;
     }
 
+    size_t needle_len = strlen(needle);
+    if (needle_len == 0) {
+        return *result;
+    }
+
+    gchar *needle_last_ch = g_utf8_offset_to_pointer(needle, g_utf8_strlen(needle, -1) - 1);
+    int needle_last_ch_len = mblen(needle_last_ch, MB_CUR_MAX);
+
+    GSList *found = NULL;
     gchar *haystack_curr = g_utf8_offset_to_pointer(haystack, offset);
-    if (g_str_has_prefix(haystack_curr, needle)) {
-        if (whole_word) {
-            gchar *needle_last_ch = g_utf8_offset_to_pointer(needle, g_utf8_strlen(needle, -1)- 1);
-            int needle_last_ch_len = mblen(needle_last_ch, MB_CUR_MAX);
-
-            gchar *haystack_before_ch = g_utf8_prev_char(haystack_curr);
-            gchar *haystack_after_ch = g_utf8_next_char(haystack_curr + strlen(needle) - needle_last_ch_len);
-
-            gunichar before = g_utf8_get_char(haystack_before_ch);
-            gunichar after = g_utf8_get_char(haystack_after_ch);
-            if (!g_unichar_isalnum(before) && !g_unichar_isalnum(after)) {
-                *result = g_slist_append(*result, GINT_TO_POINTER(offset));
+    while (*haystack_curr != '\0') {
+        if (strncmp(haystack_curr, needle, needle_len) == 0) {
+            if (whole_word) {
+                gunichar before = 0;
+                if (haystack_curr != haystack) {
+                    before = g_utf8_get_char(g_utf8_prev_char(haystack_curr));
+                }
+                gchar *haystack_after_ch = g_utf8_next_char(haystack_curr + needle_len - needle_last_ch_len);
+                gunichar after = g_utf8_get_char(haystack_after_ch);
+
+                if (!g_unichar_isalnum(before) && !g_unichar_isalnum(after)) {
+                    found = g_slist_prepend(found, GINT_TO_POINTER(offset));
+                }
+            } else {
+                found = g_slist_prepend(found, GINT_TO_POINTER(offset));
             }
-        } else {
-            *result = g_slist_append(*result, GINT_TO_POINTER(offset));
         }
-    }
 
-    offset++;
-    if (g_strcmp0(g_utf8_offset_to_pointer(haystack, offset), "\0") != 0) {
-        *result = prof_occurrences(needle, haystack, offset, whole_word, result);
+        offset++;
+        haystack_curr = g_utf8_next_char(haystack_curr);
     }
 
+    *result = g_slist_concat(*result, g_slist_reverse(found));
+
     return *result;
 }
 
@@ -43,6 +43,7 @@
 #define FILE_PLUGIN_SETTINGS "plugin_settings"
 #define FILE_PLUGIN_THEMES "plugin_themes"
 #define FILE_CAPSCACHE "capscache"
+#define FILE_CAPSCACHE_BIN "capscache.bin"
 
 #define DIR_THEMES "themes"
 #define DIR_ICONS "icons"
@@ -51,6 +52,8 @@
 #define DIR_OTR "otr"
 #define DIR_PGP "pgp"
 #define DIR_PLUGINS "plugins"
+#define DIR_SEARCH "search"
+#define DIR_ROSTER "roster"
 
 void files_create_directories(void);
 
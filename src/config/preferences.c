@@ -37,6 +37,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <assert.h>
 
 #include <glib.h>
 #include <glib/gstdio.h>
@@ -61,15 +62,32 @@
 #define PREF_GROUP_MUC "muc"
 
 #define INPBLOCK_DEFAULT 1000
+#define MAXFPS_DEFAULT 30
+
+// typed values read from the key file, cleared whenever the preferences change
+typedef struct pref_cache_t {
+    gboolean bool_cached;
+    gboolean bool_value;
+    gboolean string_cached;
+    char *string_value;
+} PrefCache;
 
 static char *prefs_loc;
 static GKeyFile *prefs;
+static PrefCache pref_cache[PREF_COUNT];
+
+// read once per frame by the redraw throttle, 0 when not cached
+static gint max_fps_cache = 0;
 gint log_maxsize = 0;
 
 static Autocomplete boolean_choice_ac;
 static Autocomplete room_trigger_ac;
 
+// incremented whenever the room trigger list changes
+static guint room_trigger_generation = 0;
+
 static void _save_prefs(void);
+static void _pref_cache_clear(void);
 static const char* _get_group(preference_t pref);
 static const char* _get_key(preference_t pref);
 static gboolean _get_default_boolean(preference_t pref);
@@ -85,6 +103,7 @@ prefs_load(void)
         g_chmod(prefs_loc, S_IRUSR | S_IWUSR);
     }
 
+    _pref_cache_clear();
     prefs = g_key_file_new();
     g_key_file_load_from_file(prefs, prefs_loc, G_KEY_FILE_KEEP_COMMENTS, NULL);
 
@@ -150,6 +169,7 @@ prefs_load(void)
     autocomplete_add(boolean_choice_ac, "off");
 
     room_trigger_ac = autocomplete_new();
+    room_trigger_generation++;
     gsize len = 0;
     gchar **triggers = g_key_file_get_string_list(prefs, PREF_GROUP_NOTIFICATIONS, "room.trigger.list", &len, NULL);
 
@@ -165,6 +185,7 @@ prefs_close(void)
 {
     autocomplete_free(boolean_choice_ac);
     autocomplete_free(room_trigger_ac);
+    _pref_cache_clear();
     g_key_file_free(prefs);
     prefs = NULL;
 }
@@ -207,28 +228,6 @@ prefs_do_chat_notify(gboolean current_win)
     }
 }
 
-GList*
-prefs_message_get_triggers(const char *const message)
-{
-    GList *result = NULL;
-
-    char *message_lower = g_utf8_strdown(message, -1);
-    gsize len = 0;
-    gchar **triggers = g_key_file_get_string_list(prefs, PREF_GROUP_NOTIFICATIONS, "room.trigger.list", &len, NULL);
-    int i;
-    for (i = 0; i < len; i++) {
-        char *trigger_lower = g_utf8_strdown(triggers[i], -1);
-        if (g_strrstr(message_lower, trigger_lower)) {
-            result = g_list_append(result, strdup(triggers[i]));
-        }
-        g_free(trigger_lower);
-    }
-    g_strfreev(triggers);
-    g_free(message_lower);
-
-    return result;
-}
-
 gboolean
 prefs_do_room_notify(gboolean current_win, const char *const roomjid, const char *const mynick,
     const char *const theirnick, const char *const message, gboolean mention, gboolean trigger_found)
@@ -387,15 +386,23 @@ prefs_reset_room_notify(const char *const roomjid)
 gboolean
 prefs_get_boolean(preference_t pref)
 {
+    assert(pref < PREF_COUNT);
+    PrefCache *cached = &pref_cache[pref];
+    if (cached->bool_cached) {
+        return cached->bool_value;
+    }
+
     const char *group = _get_group(pref);
     const char *key = _get_key(pref);
-    gboolean def = _get_default_boolean(pref);
 
     if (!g_key_file_has_key(prefs, group, key, NULL)) {
-        return def;
+        cached->bool_value = _get_default_boolean(pref);
+    } else {
+        cached->bool_value = g_key_file_get_boolean(prefs, group, key, NULL);
     }
+    cached->bool_cached = TRUE;
 
-    return g_key_file_get_boolean(prefs, group, key, NULL);
+    return cached->bool_value;
 }
 
 void
@@ -407,24 +414,34 @@ prefs_set_boolean(preference_t pref, gboolean value)
     _save_prefs();
 }
 
-char*
-prefs_get_string(preference_t pref)
+// the returned string is owned by the preferences cache and is only valid
+// until the next prefs_set_* call or prefs_load/prefs_close
+const char*
+prefs_peek_string(preference_t pref)
 {
+    assert(pref < PREF_COUNT);
+    PrefCache *cached = &pref_cache[pref];
+    if (cached->string_cached) {
+        return cached->string_value;
+    }
+
     const char *group = _get_group(pref);
     const char *key = _get_key(pref);
-    char *def = _get_default_string(pref);
 
     char *result = g_key_file_get_string(prefs, group, key, NULL);
-
     if (result == NULL) {
-        if (def) {
-            return g_strdup(def);
-        } else {
-            return NULL;
-        }
-    } else {
-        return result;
+        result = g_strdup(_get_default_string(pref));
     }
+    cached->string_value = result;
+    cached->string_cached = TRUE;
+
+    return cached->string_value;
+}
+
+char*
+prefs_get_string(preference_t pref)
+{
+    return g_strdup(prefs_peek_string(pref));
 }
 
 void
@@ -530,6 +547,19 @@ prefs_set_max_log_size(gint value)
     _save_prefs();
 }
 
+gint
+prefs_get_chlog_flush(void)
+{
+    return g_key_file_get_integer(prefs, PREF_GROUP_LOGGING, "flush", NULL);
+}
+
+void
+prefs_set_chlog_flush(gint value)
+{
+    g_key_file_set_integer(prefs, PREF_GROUP_LOGGING, "flush", value);
+    _save_prefs();
+}
+
 gint
 prefs_get_inpblock(void)
 {
@@ -548,6 +578,30 @@ prefs_set_inpblock(gint value)
     _save_prefs();
 }
 
+gint
+prefs_get_max_fps(void)
+{
+    if (max_fps_cache > 0) {
+        return max_fps_cache;
+    }
+
+    int val = g_key_file_get_integer(prefs, PREF_GROUP_UI, "maxfps", NULL);
+    if (val <= 0) {
+        max_fps_cache = MAXFPS_DEFAULT;
+    } else {
+        max_fps_cache = val;
+    }
+
+    return max_fps_cache;
+}
+
+void
+prefs_set_max_fps(gint value)
+{
+    g_key_file_set_integer(prefs, PREF_GROUP_UI, "maxfps", value);
+    _save_prefs();
+}
+
 gint
 prefs_get_reconnect(void)
 {
@@ -1053,6 +1107,7 @@ prefs_add_room_notify_trigger(const char * const text)
 
     if (res) {
         autocomplete_add(room_trigger_ac, text);
+        room_trigger_generation++;
     }
 
     return res;
@@ -1066,11 +1121,18 @@ prefs_remove_room_notify_trigger(const char * const text)
 
     if (res) {
         autocomplete_remove(room_trigger_ac, text);
+        room_trigger_generation++;
     }
 
     return res;
 }
 
+guint
+prefs_get_room_notify_triggers_generation(void)
+{
+    return room_trigger_generation;
+}
+
 GList*
 prefs_get_room_notify_triggers(void)
 {
@@ -1173,9 +1235,24 @@ prefs_free_aliases(GList *aliases)
     g_list_free_full(aliases, (GDestroyNotify)_free_alias);
 }
 
+static void
+_pref_cache_clear(void)
+{
+    int i = 0;
+    for (i = 0; i < PREF_COUNT; i++) {
+        g_free(pref_cache[i].string_value);
+        pref_cache[i].string_value = NULL;
+        pref_cache[i].string_cached = FALSE;
+        pref_cache[i].bool_cached = FALSE;
+    }
+    max_fps_cache = 0;
+}
+
 static void
 _save_prefs(void)
 {
+    _pref_cache_clear();
+
     gsize g_data_size;
     gchar *g_prefs_data = g_key_file_to_data(prefs, &g_data_size, NULL);
     gchar *base = g_path_get_basename(prefs_loc);
@@ -1215,6 +1292,7 @@ _get_group(preference_t pref)
         case PREF_MUC_PRIVILEGES:
         case PREF_PRESENCE:
         case PREF_WRAP:
+        case PREF_COMPLETION_FUZZY:
         case PREF_WINS_AUTO_TIDY:
         case PREF_TIME_CONSOLE:
         case PREF_TIME_CHAT:
@@ -1414,6 +1492,8 @@ _get_key(preference_t pref)
             return "presence";
         case PREF_WRAP:
             return "wrap";
+        case PREF_COMPLETION_FUZZY:
+            return "completion.fuzzy";
         case PREF_WINS_AUTO_TIDY:
             return "wins.autotidy";
         case PREF_TIME_CONSOLE:
@@ -57,6 +57,9 @@ static GHashTable *bold_items;
 static GHashTable *str_to_pair;
 static GHashTable *defaults;
 
+// resolved curses attributes, indexed by theme_item_t
+static int *attrs_table;
+
 struct colour_string_t {
     char *str;
     NCURSES_COLOR_T colour;
@@ -66,6 +69,8 @@ static void _load_preferences(void);
 void _theme_list_dir(const gchar *const dir, GSList **result);
 static GString* _theme_find(const char *const theme_name);
 static gboolean _theme_load_file(const char *const theme_name);
+static void _theme_build_attrs(void);
+static int _theme_resolve_attrs(theme_item_t attrs);
 
 void
 theme_init(const char *const theme_name)
@@ -151,6 +156,8 @@ theme_init(const char *const theme_name)
     g_hash_table_insert(defaults, strdup("roster.room.trigger"),     strdup("green"));
     g_hash_table_insert(defaults, strdup("roster.room.mention"),     strdup("green"));
     g_hash_table_insert(defaults, strdup("occupants.header"),        strdup("yellow"));
+
+    _theme_build_attrs();
 }
 
 gboolean
@@ -174,6 +181,7 @@ theme_load(const char *const theme_name)
 {
     if (_theme_load_file(theme_name)) {
         _load_preferences();
+        _theme_build_attrs();
         return TRUE;
     } else {
         return FALSE;
@@ -250,6 +258,8 @@ theme_close(void)
         g_hash_table_destroy(defaults);
         defaults = NULL;
     }
+    free(attrs_table);
+    attrs_table = NULL;
 }
 
 static void
@@ -353,6 +363,8 @@ theme_init_colours(void)
     _theme_init_pair(78, COLOR_YELLOW, COLOR_MAGENTA,   "yellow_magenta");
     _theme_init_pair(79, COLOR_YELLOW, COLOR_WHITE,     "yellow_white");
     _theme_init_pair(80, COLOR_YELLOW, COLOR_YELLOW,    "yellow_yellow");
+
+    _theme_build_attrs();
 }
 
 static void
@@ -706,6 +718,33 @@ theme_free_string(char *str)
 
 int
 theme_attrs(theme_item_t attrs)
+{
+    if (attrs_table == NULL) {
+        return 0;
+    }
+
+    return attrs_table[attrs];
+}
+
+// resolve every theme item against the current theme and colour pairs,
+// the new table replaces the old one only once it is complete
+static void
+_theme_build_attrs(void)
+{
+    int *table = malloc(sizeof(int) * THEME_COUNT);
+
+    int i = 0;
+    for (i = 0; i < THEME_COUNT; i++) {
+        table[i] = _theme_resolve_attrs(i);
+    }
+
+    int *old = attrs_table;
+    attrs_table = table;
+    free(old);
+}
+
+static int
+_theme_resolve_attrs(theme_item_t attrs)
 {
     int result = 0;
 
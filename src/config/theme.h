@@ -130,7 +130,8 @@ typedef enum {
     THEME_BLACK,
     THEME_BLACK_BOLD,
     THEME_MAGENTA,
-    THEME_MAGENTA_BOLD
+    THEME_MAGENTA_BOLD,
+    THEME_COUNT
 } theme_item_t;
 
 void theme_init(const char *const theme_name);
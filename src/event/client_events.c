@@ -39,7 +39,9 @@
 
 #include "log.h"
 #include "config/preferences.h"
+#include "event/server_events.h"
 #include "plugins/plugins.h"
+#include "tools/log_index.h"
 #include "ui/window_list.h"
 #include "ui/ui.h"
 #include "xmpp/xmpp.h"
@@ -54,6 +56,11 @@
 #include "pgp/gpg.h"
 #endif
 
+#ifdef HAVE_LIBGPGME
+// counts presences sent, one still being signed is dropped when this moves on
+static int presence_sign_seq = 0;
+#endif
+
 jabber_conn_status_t
 cl_ev_connect_jid(const char *const jid, const char *const passwd, const char *const altdomain, const int port, const char *const tls_policy)
 {
@@ -83,6 +90,14 @@ cl_ev_disconnect(void)
     cons_show("%s logged out successfully.", jidp->barejid);
     jid_destroy(jidp);
 
+#ifdef HAVE_LIBGPGME
+    // show and log messages still held for decryption before their windows close
+    sv_ev_pgp_release_all();
+
+    // drop presences still being signed
+    presence_sign_seq++;
+#endif
+
     ui_disconnected();
     ui_close_all_wins();
     session_disconnect();
@@ -90,35 +105,59 @@ cl_ev_disconnect(void)
     muc_invites_clear();
     chat_sessions_clear();
     tlscerts_clear_current();
+    log_index_on_disconnect();
 #ifdef HAVE_LIBGPGME
     p_gpg_on_disconnect();
 #endif
 }
 
+#ifdef HAVE_LIBGPGME
+typedef struct presence_sign_t {
+    resource_presence_t presence_type;
+    int idle_secs;
+    int seq;
+} PresenceSign;
+
+static void
+_cl_ev_presence_signed(const char *const signed_status, void *userdata)
+{
+    // a newer presence replaces this one, its status is the one signed last
+    PresenceSign *sign = userdata;
+    if (sign->seq == presence_sign_seq && connection_get_status() == JABBER_CONNECTED) {
+        presence_send(sign->presence_type, sign->idle_secs, (char*)signed_status);
+    }
+}
+#endif
+
 void
 cl_ev_presence_send(const resource_presence_t presence_type, const int idle_secs)
 {
-    char *signed_status = NULL;
-
 #ifdef HAVE_LIBGPGME
     char *account_name = session_get_account_name();
     ProfAccount *account = accounts_get_account(account_name);
     if (account->pgp_keyid) {
+        // the presence is sent late, once the gpg workers have signed the status,
+        // unless a newer presence or a disconnect comes first
+        PresenceSign *sign = malloc(sizeof(PresenceSign));
+        sign->presence_type = presence_type;
+        sign->idle_secs = idle_secs;
+        sign->seq = ++presence_sign_seq;
         char *msg = connection_get_presence_msg();
-        signed_status = p_gpg_sign(msg, account->pgp_keyid);
+        p_gpg_sign_async(msg, account->pgp_keyid, _cl_ev_presence_signed, sign, free);
+        account_free(account);
+        return;
     }
     account_free(account);
 #endif
 
-    presence_send(presence_type, idle_secs, signed_status);
-
-    free(signed_status);
+    presence_send(presence_type, idle_secs, NULL);
 }
 
 void
 cl_ev_send_msg(ProfChatWin *chatwin, const char *const msg, const char *const oob_url)
 {
     chat_state_active(chatwin->state);
+    roster_contact_mark_used(chatwin->barejid);
 
     gboolean request_receipt = FALSE;
     if (prefs_get_boolean(PREF_RECEIPTS_REQUEST)) {
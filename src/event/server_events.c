@@ -46,6 +46,7 @@
 #include "config/scripts.h"
 #include "event/client_events.h"
 #include "plugins/plugins.h"
+#include "tools/log_index.h"
 #include "ui/window_list.h"
 #include "xmpp/muc.h"
 #include "xmpp/chat_session.h"
@@ -61,6 +62,36 @@
 
 #include "ui/ui.h"
 
+#ifdef HAVE_LIBGPGME
+// a message from a contact, held while it or an earlier one is decrypted
+typedef struct pgp_incoming_t {
+    char *barejid;
+    char *resource;
+    char *message;
+    GDateTime *timestamp;
+    gboolean new_win;
+    gboolean outgoing;
+    // a plain message to pass through otr
+    gboolean otr;
+    // waiting for the gpg workers, decrypted is set when they finish
+    gboolean decrypting;
+    char *decrypted;
+    // the queue and the decrypt job each hold a reference
+    int refs;
+} PGPIncoming;
+
+// barejid to a queue of held messages, so that messages from a contact are
+// shown in the order they arrived
+static GHashTable *pgp_held;
+
+static gboolean _sv_ev_pgp_holding(const char *const barejid);
+static PGPIncoming* _sv_ev_pgp_hold(const char *const barejid, const char *const resource, const char *const message,
+    GDateTime *timestamp, gboolean new_win, gboolean outgoing);
+void sv_ev_pgp_release_all(void);
+static void _sv_ev_pgp_decrypt(const char *const barejid, const char *const resource, const char *const message,
+    const char *const pgp_message, GDateTime *timestamp, gboolean new_win, gboolean outgoing);
+#endif
+
 void
 sv_ev_login_account_success(char *account_name, gboolean secured)
 {
@@ -75,6 +106,7 @@ sv_ev_login_account_success(char *account_name, gboolean secured)
 #ifdef HAVE_LIBGPGME
     p_gpg_on_connect(account->jid);
 #endif
+    log_index_on_connect(account->jid);
 
     ui_handle_login_account_success(account, secured);
 
@@ -163,6 +195,11 @@ sv_ev_lost_connection(void)
 {
     cons_show_error("Lost connection.");
 
+#ifdef HAVE_LIBGPGME
+    // decrypt results for this session are dropped, show what is held now
+    sv_ev_pgp_release_all();
+#endif
+
 #ifdef HAVE_LIBOTR
     GSList *recipients = wins_get_chat_recipients();
     GSList *curr = recipients;
@@ -184,6 +221,7 @@ sv_ev_lost_connection(void)
     chat_sessions_clear();
     ui_disconnected();
     roster_destroy();
+    log_index_on_disconnect();
 #ifdef HAVE_LIBGPGME
     p_gpg_on_disconnect();
 #endif
@@ -254,21 +292,18 @@ sv_ev_room_message(const char *const room_jid, const char *const nick, const cha
         return;
     }
 
+    muc_nick_mark_used(room_jid, nick);
+
     char *new_message = plugins_pre_room_message_display(room_jid, nick, message);
     char *mynick = muc_nick(mucwin->roomjid);
 
     gboolean whole_word = prefs_get_boolean(PREF_NOTIFY_MENTION_WHOLE_WORD);
     gboolean case_sensitive = prefs_get_boolean(PREF_NOTIFY_MENTION_CASE_SENSITIVE);
-    char *message_search = case_sensitive ? strdup(new_message) : g_utf8_strdown(new_message, -1);
-    char *mynick_search = case_sensitive ? strdup(mynick) : g_utf8_strdown(mynick, -1);
 
     GSList *mentions = NULL;
-    mentions = prof_occurrences(mynick_search, message_search, 0, whole_word, &mentions);
+    GList *triggers = NULL;
+    muc_message_scan(room_jid, new_message, whole_word, case_sensitive, &mentions, &triggers);
     gboolean mention = g_slist_length(mentions) > 0;
-    g_free(message_search);
-    g_free(mynick_search);
-
-    GList *triggers = prefs_message_get_triggers(new_message);
 
     mucwin_message(mucwin, nick, new_message, mentions, triggers);
 
@@ -370,12 +405,9 @@ sv_ev_outgoing_carbon(char *barejid, char *message, char *pgp_message)
 
 #ifdef HAVE_LIBGPGME
     if (pgp_message) {
-        char *decrypted = p_gpg_decrypt(pgp_message);
-        if (decrypted) {
-            chatwin_outgoing_carbon(chatwin, decrypted, PROF_MSG_PGP);
-        } else {
-            chatwin_outgoing_carbon(chatwin, message, PROF_MSG_PLAIN);
-        }
+        _sv_ev_pgp_decrypt(barejid, NULL, message, pgp_message, NULL, FALSE, TRUE);
+    } else if (_sv_ev_pgp_holding(barejid)) {
+        _sv_ev_pgp_hold(barejid, NULL, message, NULL, FALSE, TRUE);
     } else {
         chatwin_outgoing_carbon(chatwin, message, PROF_MSG_PLAIN);
     }
@@ -384,24 +416,6 @@ sv_ev_outgoing_carbon(char *barejid, char *message, char *pgp_message)
 #endif
 }
 
-#ifdef HAVE_LIBGPGME
-static void
-_sv_ev_incoming_pgp(ProfChatWin *chatwin, gboolean new_win, char *barejid, char *resource, char *message, char *pgp_message, GDateTime *timestamp)
-{
-    char *decrypted = p_gpg_decrypt(pgp_message);
-    if (decrypted) {
-        chatwin_incoming_msg(chatwin, resource, decrypted, timestamp, new_win, PROF_MSG_PGP);
-        chat_log_pgp_msg_in(barejid, decrypted, timestamp);
-        chatwin->pgp_recv = TRUE;
-        p_gpg_free_decrypted(decrypted);
-    } else {
-        chatwin_incoming_msg(chatwin, resource, message, timestamp, new_win, PROF_MSG_PLAIN);
-        chat_log_msg_in(barejid, message, timestamp);
-        chatwin->pgp_recv = FALSE;
-    }
-}
-#endif
-
 #ifdef HAVE_LIBOTR
 static void
 _sv_ev_incoming_otr(ProfChatWin *chatwin, gboolean new_win, char *barejid, char *resource, char *message, GDateTime *timestamp)
@@ -430,6 +444,186 @@ _sv_ev_incoming_plain(ProfChatWin *chatwin, gboolean new_win, char *barejid, cha
     chatwin->pgp_recv = FALSE;
 }
 
+#ifdef HAVE_LIBGPGME
+static void
+_sv_ev_pgp_incoming_unref(PGPIncoming *incoming)
+{
+    if (--incoming->refs > 0) {
+        return;
+    }
+
+    free(incoming->barejid);
+    free(incoming->resource);
+    free(incoming->message);
+    free(incoming->decrypted);
+    if (incoming->timestamp) {
+        g_date_time_unref(incoming->timestamp);
+    }
+    free(incoming);
+}
+
+static void
+_sv_ev_pgp_queue_free(GQueue *queue)
+{
+    g_queue_foreach(queue, (GFunc)_sv_ev_pgp_incoming_unref, NULL);
+    g_queue_free(queue);
+}
+
+static gboolean
+_sv_ev_pgp_holding(const char *const barejid)
+{
+    return pgp_held && g_hash_table_lookup(pgp_held, barejid) != NULL;
+}
+
+static PGPIncoming*
+_sv_ev_pgp_hold(const char *const barejid, const char *const resource, const char *const message,
+    GDateTime *timestamp, gboolean new_win, gboolean outgoing)
+{
+    if (!pgp_held) {
+        pgp_held = g_hash_table_new_full(g_str_hash, g_str_equal, free, (GDestroyNotify)_sv_ev_pgp_queue_free);
+    }
+
+    GQueue *queue = g_hash_table_lookup(pgp_held, barejid);
+    if (!queue) {
+        queue = g_queue_new();
+        g_hash_table_insert(pgp_held, strdup(barejid), queue);
+    }
+
+    PGPIncoming *incoming = calloc(1, sizeof(PGPIncoming));
+    incoming->barejid = strdup(barejid);
+    incoming->resource = resource ? strdup(resource) : NULL;
+    incoming->message = message ? strdup(message) : NULL;
+    incoming->timestamp = timestamp ? g_date_time_ref(timestamp) : NULL;
+    incoming->new_win = new_win;
+    incoming->outgoing = outgoing;
+    incoming->refs = 1;
+    g_queue_push_tail(queue, incoming);
+
+    return incoming;
+}
+
+// the chat window may have been closed while the message was held
+static void
+_sv_ev_pgp_show(PGPIncoming *incoming)
+{
+    gboolean new_win = incoming->new_win;
+    ProfChatWin *chatwin = wins_get_chat(incoming->barejid);
+
+    if (incoming->outgoing) {
+        if (!chatwin) {
+            chatwin = chatwin_new(incoming->barejid);
+        }
+        if (incoming->decrypted) {
+            chatwin_outgoing_carbon(chatwin, incoming->decrypted, PROF_MSG_PGP);
+        } else {
+            chatwin_outgoing_carbon(chatwin, incoming->message, PROF_MSG_PLAIN);
+        }
+        return;
+    }
+
+    if (!chatwin) {
+        ProfWin *window = wins_new_chat(incoming->barejid);
+        chatwin = (ProfChatWin*)window;
+        new_win = TRUE;
+    }
+
+#ifdef HAVE_LIBOTR
+    if (incoming->otr) {
+        _sv_ev_incoming_otr(chatwin, new_win, incoming->barejid, incoming->resource, incoming->message,
+            incoming->timestamp);
+        rosterwin_roster();
+        return;
+    }
+#endif
+
+    if (incoming->decrypted) {
+        chatwin_incoming_msg(chatwin, incoming->resource, incoming->decrypted, incoming->timestamp, new_win, PROF_MSG_PGP);
+        chat_log_pgp_msg_in(incoming->barejid, incoming->decrypted, incoming->timestamp);
+        chatwin->pgp_recv = TRUE;
+    } else {
+        _sv_ev_incoming_plain(chatwin, new_win, incoming->barejid, incoming->resource, incoming->message,
+            incoming->timestamp);
+    }
+    rosterwin_roster();
+}
+
+// show held messages from the front of the queue up to the next one still being decrypted
+static void
+_sv_ev_pgp_release(const char *const barejid)
+{
+    GQueue *queue = pgp_held ? g_hash_table_lookup(pgp_held, barejid) : NULL;
+    if (!queue) {
+        return;
+    }
+
+    while (!g_queue_is_empty(queue)) {
+        PGPIncoming *incoming = g_queue_peek_head(queue);
+        if (incoming->decrypting) {
+            return;
+        }
+        g_queue_pop_head(queue);
+        _sv_ev_pgp_show(incoming);
+        _sv_ev_pgp_incoming_unref(incoming);
+    }
+
+    g_hash_table_remove(pgp_held, barejid);
+}
+
+// show everything held, messages still being decrypted are shown undecrypted
+void
+sv_ev_pgp_release_all(void)
+{
+    if (!pgp_held) {
+        return;
+    }
+
+    GHashTable *held = pgp_held;
+    pgp_held = NULL;
+
+    GHashTableIter iter;
+    gpointer value;
+    g_hash_table_iter_init(&iter, held);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        GQueue *queue = value;
+        PGPIncoming *incoming = NULL;
+        while ((incoming = g_queue_pop_head(queue))) {
+            _sv_ev_pgp_show(incoming);
+            _sv_ev_pgp_incoming_unref(incoming);
+        }
+    }
+
+    g_hash_table_destroy(held);
+}
+
+static void
+_sv_ev_pgp_decrypted(const char *const decrypted, void *userdata)
+{
+    PGPIncoming *incoming = userdata;
+    incoming->decrypted = decrypted ? strdup(decrypted) : NULL;
+    incoming->decrypting = FALSE;
+
+    _sv_ev_pgp_release(incoming->barejid);
+}
+
+static void
+_sv_ev_pgp_decrypt(const char *const barejid, const char *const resource, const char *const message,
+    const char *const pgp_message, GDateTime *timestamp, gboolean new_win, gboolean outgoing)
+{
+    PGPIncoming *incoming = _sv_ev_pgp_hold(barejid, resource, message, timestamp, new_win, outgoing);
+    incoming->decrypting = TRUE;
+
+    // the decrypt job holds its own reference
+    incoming->refs++;
+    p_gpg_decrypt_async(pgp_message, _sv_ev_pgp_decrypted, incoming, (GDestroyNotify)_sv_ev_pgp_incoming_unref);
+}
+
+static void
+_sv_ev_incoming_pgp(ProfChatWin *chatwin, gboolean new_win, char *barejid, char *resource, char *message, char *pgp_message, GDateTime *timestamp)
+{
+    _sv_ev_pgp_decrypt(barejid, resource, message, pgp_message, timestamp, new_win, FALSE);
+}
+#endif
+
 void
 sv_ev_incoming_message(char *barejid, char *resource, char *message, char *pgp_message, GDateTime *timestamp)
 {
@@ -450,6 +644,9 @@ sv_ev_incoming_message(char *barejid, char *resource, char *message, char *pgp_m
         } else { // PROF_ENC_NONE, PROF_ENC_PGP
             _sv_ev_incoming_pgp(chatwin, new_win, barejid, resource, message, pgp_message, timestamp);
         }
+    } else if (_sv_ev_pgp_holding(barejid)) {
+        PGPIncoming *incoming = _sv_ev_pgp_hold(barejid, resource, message, timestamp, new_win, FALSE);
+        incoming->otr = TRUE;
     } else {
         _sv_ev_incoming_otr(chatwin, new_win, barejid, resource, message, timestamp);
     }
@@ -472,6 +669,8 @@ sv_ev_incoming_message(char *barejid, char *resource, char *message, char *pgp_m
 #ifdef HAVE_LIBGPGME
     if (pgp_message) {
         _sv_ev_incoming_pgp(chatwin, new_win, barejid, resource, message, pgp_message, timestamp);
+    } else if (_sv_ev_pgp_holding(barejid)) {
+        _sv_ev_pgp_hold(barejid, resource, message, timestamp, new_win, FALSE);
     } else {
         _sv_ev_incoming_plain(chatwin, new_win, barejid, resource, message, timestamp);
     }
@@ -504,6 +703,8 @@ sv_ev_incoming_carbon(char *barejid, char *resource, char *message, char *pgp_me
 #ifdef HAVE_LIBGPGME
     if (pgp_message) {
         _sv_ev_incoming_pgp(chatwin, new_win, barejid, resource, message, pgp_message, NULL);
+    } else if (_sv_ev_pgp_holding(barejid)) {
+        _sv_ev_pgp_hold(barejid, resource, message, NULL, new_win, FALSE);
     } else {
         _sv_ev_incoming_plain(chatwin, new_win, barejid, resource, message, NULL);
     }
@@ -643,7 +844,7 @@ sv_ev_contact_online(char *barejid, Resource *resource, GDateTime *last_activity
 
 #ifdef HAVE_LIBGPGME
     if (pgpsig) {
-        p_gpg_verify(barejid, pgpsig);
+        p_gpg_verify_async(barejid, pgpsig);
     }
 #endif
 
@@ -693,12 +894,11 @@ sv_ev_room_occupant_offline(const char *const room, const char *const nick,
 {
     muc_roster_remove(room, nick);
 
-    char *muc_status_pref = prefs_get_string(PREF_STATUSES_MUC);
+    const char *muc_status_pref = prefs_peek_string(PREF_STATUSES_MUC);
     ProfMucWin *mucwin = wins_get_muc(room);
     if (mucwin && (g_strcmp0(muc_status_pref, "none") != 0)) {
         mucwin_occupant_offline(mucwin, nick);
     }
-    prefs_free_string(muc_status_pref);
 
     Jid *jidp = jid_create_from_bare_and_resource(room, nick);
     ProfPrivateWin *privwin = wins_get_private(jidp->fulljid);
@@ -807,6 +1007,7 @@ sv_ev_muc_self_online(const char *const room, const char *const nick, gboolean c
         }
 
         muc_roster_set_complete(room);
+        occupantswin_occupants(room);
 
         // show roster if occupants list disabled by default
         ProfMucWin *mucwin = wins_get_muc(room);
@@ -900,12 +1101,11 @@ sv_ev_muc_occupant_online(const char *const room, const char *const nick, const
 
     // joined room
     if (!occupant) {
-        char *muc_status_pref = prefs_get_string(PREF_STATUSES_MUC);
+        const char *muc_status_pref = prefs_peek_string(PREF_STATUSES_MUC);
         ProfMucWin *mucwin = wins_get_muc(room);
         if (mucwin && g_strcmp0(muc_status_pref, "none") != 0) {
             mucwin_occupant_online(mucwin, nick, role, affiliation, show, status);
         }
-        prefs_free_string(muc_status_pref);
 
         Jid *jidp = jid_create_from_bare_and_resource(mucwin->roomjid, nick);
         ProfPrivateWin *privwin = wins_get_private(jidp->fulljid);
@@ -921,12 +1121,11 @@ sv_ev_muc_occupant_online(const char *const room, const char *const nick, const
 
     // presence updated
     if (updated) {
-        char *muc_status_pref = prefs_get_string(PREF_STATUSES_MUC);
+        const char *muc_status_pref = prefs_peek_string(PREF_STATUSES_MUC);
         ProfMucWin *mucwin = wins_get_muc(room);
         if (mucwin && (g_strcmp0(muc_status_pref, "all") == 0)) {
             mucwin_occupant_presence(mucwin, nick, show, status);
         }
-        prefs_free_string(muc_status_pref);
         occupantswin_occupants(room);
 
     // presence unchanged, check for role/affiliation change
@@ -88,5 +88,6 @@ void sv_ev_roster_received(void);
 int sv_ev_certfail(const char *const errormsg, TLSCertificate *cert);
 void sv_ev_lastactivity_response(const char *const from, const int seconds, const char *const msg);
 void sv_ev_bookmark_autojoin(Bookmark *bookmark);
+void sv_ev_pgp_release_all(void);
 
 #endif
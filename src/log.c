@@ -39,6 +39,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 
 #include "glib.h"
 #include "glib/gstdio.h"
@@ -48,8 +51,12 @@
 #include "config/files.h"
 #include "config/preferences.h"
 #include "xmpp/xmpp.h"
+#include "tools/log_index.h"
 
 #define PROF "prof"
+#define CHAT_LOG_MAX_OPEN 32
+#define CHAT_LOG_QUEUE_SIZE 1024
+#define CHAT_LOG_READ_CHUNK 4096
 
 static FILE *logp;
 GString *mainlogfile;
@@ -62,6 +69,56 @@ static GHashTable *logs;
 static GHashTable *groupchat_logs;
 static GDateTime *session_started;
 
+// open chat log files, most recently written first, only used by the writer thread
+static GQueue *open_logs;
+static gint64 next_flush;
+static gint flush_interval;
+
+typedef enum {
+    CHAT_LOG_CHAT,
+    CHAT_LOG_GROUPCHAT,
+    CHAT_LOG_SYNC
+} chat_log_op_t;
+
+struct chat_log_entry {
+    chat_log_op_t op;
+    gchar *login;
+    gchar *jid;
+    gchar *line;
+    gint flush_interval;
+};
+
+// single producer (main thread), single consumer (writer thread) ring
+static struct chat_log_entry *queue[CHAT_LOG_QUEUE_SIZE];
+static gint queue_head;
+static gint queue_tail;
+
+static pthread_t writer_thread;
+static gboolean writer_running;
+static pthread_mutex_t writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writer_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t sync_cond = PTHREAD_COND_INITIALIZER;
+static gint writer_waiting;
+static gint writer_stop;
+static gint sync_requested;
+static gint sync_completed;
+
+// file errors seen by the writer thread, logged from the main thread
+struct chat_log_error {
+    const char *action;
+    gchar *filename;
+    int err;
+};
+static GAsyncQueue *writer_errors;
+
+// resolved on the main thread, the writer must not touch the environment
+static char *chatlogs_dir;
+
+static guint stats_high_water;
+static guint stats_stalls;
+static gint stats_written;
+static gint stats_errors;
+
 enum {
     STDERR_BUFSIZE = 4000,
     STDERR_RETRY_NR = 5,
@@ -72,15 +129,49 @@ static int stderr_pipe[2];
 static char *stderr_buf;
 static GString *stderr_msg;
 
+struct chat_log_history_t {
+    gchar *login;
+    gchar *recipient;
+    GDateTime *day;
+    GDateTime *first_day;
+    FILE *fp;
+    long pos;
+    GString *carry;
+    gboolean day_done;
+    gboolean done;
+};
+
 struct dated_chat_log {
     gchar *filename;
     GDateTime *date;
+    gint64 rollover;
+    FILE *fp;
+    GList *open_link;
+    gboolean dirty;
 };
 
 static gboolean _log_roll_needed(struct dated_chat_log *dated_log);
 static struct dated_chat_log* _create_log(const char *const other, const char *const login);
 static struct dated_chat_log* _create_groupchat_log(const char *const room, const char *const login);
 static void _free_chat_log(struct dated_chat_log *dated_log);
+static struct dated_chat_log* _new_dated_log(char *filename, GDateTime *date);
+static FILE* _chat_log_open(struct dated_chat_log *dated_log);
+static void _chat_log_file_close(struct dated_chat_log *dated_log);
+static void _chat_log_written(struct dated_chat_log *dated_log);
+static void _chat_log_flush_all(void);
+static void _chat_log_fflush(struct dated_chat_log *dated_log);
+static void _chat_log_push(chat_log_op_t op, const char *const login, const char *const jid, gchar *line);
+static struct chat_log_entry* _chat_log_pop(void);
+static void _chat_log_wake_writer(void);
+static void _chat_log_write_entry(struct chat_log_entry *entry);
+static void _chat_log_free_entry(struct chat_log_entry *entry);
+static void _chat_log_writer_error(const char *const action, const char *const filename, int err);
+static void _chat_log_report_errors(void);
+static void _chat_log_create_dir(const char *const dir);
+static void* _chat_log_writer(void *arg);
+static gboolean _history_open_day(ChatLogHistory history);
+static void _history_previous_day(ChatLogHistory history);
+static gchar* _history_read_line(ChatLogHistory history);
 static gboolean _key_equals(void *key1, void *key2);
 static char* _get_log_filename(const char *const other, const char *const login, GDateTime *dt, gboolean create);
 static char* _get_groupchat_log_filename(const char *const room, const char *const login, GDateTime *dt,
@@ -247,6 +338,17 @@ chat_log_init(void)
 {
     session_started = g_date_time_new_now_local();
     log_info("Initialising chat logs");
+    open_logs = g_queue_new();
+    next_flush = 0;
+    flush_interval = 0;
+    queue_head = 0;
+    queue_tail = 0;
+    writer_running = FALSE;
+    writer_stop = 0;
+    sync_requested = 0;
+    sync_completed = 0;
+    writer_errors = g_async_queue_new();
+    chatlogs_dir = files_get_data_path(DIR_CHATLOGS);
     logs = g_hash_table_new_full(g_str_hash, (GEqualFunc) _key_equals, free,
         (GDestroyNotify)_free_chat_log);
 }
@@ -353,19 +455,6 @@ static void
 _chat_log_chat(const char *const login, const char *const other, const char *const msg,
     chat_log_direction_t direction, GDateTime *timestamp)
 {
-    struct dated_chat_log *dated_log = g_hash_table_lookup(logs, other);
-
-    // no log for user
-    if (dated_log == NULL) {
-        dated_log = _create_log(other, login);
-        g_hash_table_insert(logs, strdup(other), dated_log);
-
-    // log exists but needs rolling
-    } else if (_log_roll_needed(dated_log)) {
-        dated_log = _create_log(other, login);
-        g_hash_table_replace(logs, strdup(other), dated_log);
-    }
-
     if (timestamp == NULL) {
         timestamp = g_date_time_new_now_local();
     } else {
@@ -373,29 +462,23 @@ _chat_log_chat(const char *const login, const char *const other, const char *con
     }
 
     gchar *date_fmt = g_date_time_format(timestamp, "%H:%M:%S");
-    FILE *logp = fopen(dated_log->filename, "a");
-    g_chmod(dated_log->filename, S_IRUSR | S_IWUSR);
-    if (logp) {
-        if (direction == PROF_IN_LOG) {
-            if (strncmp(msg, "/me ", 4) == 0) {
-                fprintf(logp, "%s - *%s %s\n", date_fmt, other, msg + 4);
-            } else {
-                fprintf(logp, "%s - %s: %s\n", date_fmt, other, msg);
-            }
+    gchar *line = NULL;
+    if (direction == PROF_IN_LOG) {
+        if (strncmp(msg, "/me ", 4) == 0) {
+            line = g_strdup_printf("%s - *%s %s\n", date_fmt, other, msg + 4);
         } else {
-            if (strncmp(msg, "/me ", 4) == 0) {
-                fprintf(logp, "%s - *me %s\n", date_fmt, msg + 4);
-            } else {
-                fprintf(logp, "%s - me: %s\n", date_fmt, msg);
-            }
+            line = g_strdup_printf("%s - %s: %s\n", date_fmt, other, msg);
         }
-        fflush(logp);
-        int result = fclose(logp);
-        if (result == EOF) {
-            log_error("Error closing file %s, errno = %d", dated_log->filename, errno);
+    } else {
+        if (strncmp(msg, "/me ", 4) == 0) {
+            line = g_strdup_printf("%s - *me %s\n", date_fmt, msg + 4);
+        } else {
+            line = g_strdup_printf("%s - me: %s\n", date_fmt, msg);
         }
     }
 
+    _chat_log_push(CHAT_LOG_CHAT, login, other, line);
+
     g_free(date_fmt);
     g_date_time_unref(timestamp);
 }
@@ -403,113 +486,485 @@ _chat_log_chat(const char *const login, const char *const other, const char *con
 void
 groupchat_log_chat(const gchar *const login, const gchar *const room, const gchar *const nick, const gchar *const msg)
 {
-    struct dated_chat_log *dated_log = g_hash_table_lookup(groupchat_logs, room);
+    GDateTime *dt = g_date_time_new_now_local();
+
+    gchar *date_fmt = g_date_time_format(dt, "%H:%M:%S");
+    gchar *line = NULL;
+    if (strncmp(msg, "/me ", 4) == 0) {
+        line = g_strdup_printf("%s - *%s %s\n", date_fmt, nick, msg + 4);
+    } else {
+        line = g_strdup_printf("%s - %s: %s\n", date_fmt, nick, msg);
+    }
 
-    // no log for room
-    if (dated_log == NULL) {
-        dated_log = _create_groupchat_log(room, login);
-        g_hash_table_insert(groupchat_logs, strdup(room), dated_log);
+    _chat_log_push(CHAT_LOG_GROUPCHAT, login, room, line);
 
-    // log exists but needs rolling
-    } else if (_log_roll_needed(dated_log)) {
-        dated_log = _create_groupchat_log(room, login);
-        g_hash_table_replace(logs, strdup(room), dated_log);
+    g_free(date_fmt);
+    g_date_time_unref(dt);
+}
+
+void
+chat_log_get_stats(ChatLogStats *stats)
+{
+    _chat_log_report_errors();
+
+    stats->queued = (guint)(g_atomic_int_get(&queue_tail) - g_atomic_int_get(&queue_head));
+    stats->high_water = stats_high_water;
+    stats->stalls = stats_stalls;
+    stats->written = (guint)g_atomic_int_get(&stats_written);
+    stats->errors = (guint)g_atomic_int_get(&stats_errors);
+}
+
+ChatLogHistory
+chat_log_history_new(const gchar *const login, const gchar *const recipient)
+{
+    ChatLogHistory history = malloc(sizeof(struct chat_log_history_t));
+    history->login = strdup(login);
+    history->recipient = strdup(recipient);
+    history->first_day = g_date_time_new_local(
+        g_date_time_get_year(session_started),
+        g_date_time_get_month(session_started),
+        g_date_time_get_day_of_month(session_started),
+        0, 0, 0);
+    GDateTime *now = g_date_time_new_now_local();
+    history->day = g_date_time_new_local(
+        g_date_time_get_year(now),
+        g_date_time_get_month(now),
+        g_date_time_get_day_of_month(now),
+        0, 0, 0);
+    g_date_time_unref(now);
+    history->fp = NULL;
+    history->pos = 0;
+    history->carry = g_string_new("");
+    history->day_done = FALSE;
+    history->done = FALSE;
+
+    return history;
+}
+
+GSList*
+chat_log_history_previous(ChatLogHistory history, int count)
+{
+    // make sure queued lines are visible to the reader
+    chat_log_flush();
+
+    GSList *lines = NULL;
+    int found = 0;
+
+    while (!history->done && found < count) {
+        if (history->fp == NULL && !_history_open_day(history)) {
+            continue;
+        }
+
+        gchar *line = _history_read_line(history);
+        if (line) {
+            lines = g_slist_prepend(lines, line);
+            found++;
+            continue;
+        }
+
+        // reached the start of the day, add its header and move to the previous day
+        lines = g_slist_prepend(lines, g_strdup_printf("%d/%d/%d:",
+            g_date_time_get_day_of_month(history->day),
+            g_date_time_get_month(history->day),
+            g_date_time_get_year(history->day)));
+        found++;
+        _history_previous_day(history);
     }
 
-    GDateTime *dt = g_date_time_new_now_local();
+    return lines;
+}
 
-    gchar *date_fmt = g_date_time_format(dt, "%H:%M:%S");
+gboolean
+chat_log_history_finished(ChatLogHistory history)
+{
+    return history->done;
+}
 
-    FILE *logp = fopen(dated_log->filename, "a");
-    g_chmod(dated_log->filename, S_IRUSR | S_IWUSR);
-    if (logp) {
-        if (strncmp(msg, "/me ", 4) == 0) {
-            fprintf(logp, "%s - *%s %s\n", date_fmt, nick, msg + 4);
-        } else {
-            fprintf(logp, "%s - %s: %s\n", date_fmt, nick, msg);
+void
+chat_log_history_free(ChatLogHistory history)
+{
+    if (history) {
+        if (history->fp) {
+            fclose(history->fp);
         }
+        free(history->login);
+        free(history->recipient);
+        g_date_time_unref(history->day);
+        g_date_time_unref(history->first_day);
+        g_string_free(history->carry, TRUE);
+        free(history);
+    }
+}
 
-        fflush(logp);
-        int result = fclose(logp);
-        if (result == EOF) {
-            log_error("Error closing file %s, errno = %d", dated_log->filename, errno);
+static gboolean
+_history_open_day(ChatLogHistory history)
+{
+    if (g_date_time_compare(history->day, history->first_day) < 0) {
+        history->done = TRUE;
+        return FALSE;
+    }
+
+    char *filename = _get_log_filename(history->recipient, history->login, history->day, FALSE);
+    history->fp = fopen(filename, "r");
+    free(filename);
+
+    if (history->fp == NULL || fseek(history->fp, 0, SEEK_END) != 0) {
+        _history_previous_day(history);
+        return FALSE;
+    }
+
+    history->pos = ftell(history->fp);
+    g_string_truncate(history->carry, 0);
+
+    // ignore the newline terminating the last line
+    if (history->pos > 0) {
+        fseek(history->fp, history->pos - 1, SEEK_SET);
+        if (fgetc(history->fp) == '\n') {
+            history->pos--;
         }
     }
+    history->day_done = (history->pos == 0);
 
-    g_free(date_fmt);
-    g_date_time_unref(dt);
+    return TRUE;
 }
 
+static void
+_history_previous_day(ChatLogHistory history)
+{
+    if (history->fp) {
+        fclose(history->fp);
+        history->fp = NULL;
+    }
+
+    GDateTime *previous = g_date_time_add_days(history->day, -1);
+    g_date_time_unref(history->day);
+    history->day = previous;
+}
 
-GSList*
-chat_log_get_previous(const gchar *const login, const gchar *const recipient)
+// returns the last unread line of the current day, reading the file backwards in chunks
+static gchar*
+_history_read_line(ChatLogHistory history)
 {
-    GSList *history = NULL;
-    GDateTime *now = g_date_time_new_now_local();
-    GDateTime *log_date = g_date_time_new(tz,
-        g_date_time_get_year(session_started),
-        g_date_time_get_month(session_started),
-        g_date_time_get_day_of_month(session_started),
-        g_date_time_get_hour(session_started),
-        g_date_time_get_minute(session_started),
-        g_date_time_get_second(session_started));
-
-    // get data from all logs from the day the session was started to today
-    while (g_date_time_compare(log_date, now) != 1) {
-        char *filename = _get_log_filename(recipient, login, log_date, FALSE);
-
-        FILE *logp = fopen(filename, "r");
-        if (logp) {
-            GString *header = g_string_new("");
-            g_string_append_printf(header, "%d/%d/%d:",
-                g_date_time_get_day_of_month(log_date),
-                g_date_time_get_month(log_date),
-                g_date_time_get_year(log_date));
-            history = g_slist_append(history, header->str);
-            g_string_free(header, FALSE);
-
-            char *line;
-            while ((line = file_getline(logp)) != NULL) {
-                history = g_slist_append(history, line);
-            }
+    if (history->day_done) {
+        return NULL;
+    }
 
-            fclose(logp);
+    while (TRUE) {
+        char *newline = g_strrstr_len(history->carry->str, history->carry->len, "\n");
+        if (newline) {
+            gsize start = newline - history->carry->str;
+            gchar *line = g_strndup(newline + 1, history->carry->len - start - 1);
+            g_string_truncate(history->carry, start);
+            return line;
         }
 
-        free(filename);
+        // first line of the file
+        if (history->pos == 0) {
+            gchar *line = g_strndup(history->carry->str, history->carry->len);
+            g_string_truncate(history->carry, 0);
+            history->day_done = TRUE;
+            return line;
+        }
 
-        GDateTime *next = g_date_time_add_days(log_date, 1);
-        g_date_time_unref(log_date);
-        log_date = next;
+        long chunk = history->pos < CHAT_LOG_READ_CHUNK ? history->pos : CHAT_LOG_READ_CHUNK;
+        char buf[CHAT_LOG_READ_CHUNK];
+        history->pos -= chunk;
+        if (fseek(history->fp, history->pos, SEEK_SET) != 0 || fread(buf, 1, chunk, history->fp) != (size_t)chunk) {
+            g_string_truncate(history->carry, 0);
+            history->day_done = TRUE;
+            return NULL;
+        }
+        g_string_prepend_len(history->carry, buf, chunk);
     }
+}
 
-    g_date_time_unref(log_date);
-    g_date_time_unref(now);
+void
+chat_log_flush(void)
+{
+    if (!writer_running) {
+        return;
+    }
 
-    return history;
+    int target = ++sync_requested;
+    _chat_log_push(CHAT_LOG_SYNC, NULL, NULL, NULL);
+
+    pthread_mutex_lock(&writer_mutex);
+    while (g_atomic_int_get(&sync_completed) < target) {
+        pthread_cond_wait(&sync_cond, &writer_mutex);
+    }
+    pthread_mutex_unlock(&writer_mutex);
+
+    _chat_log_report_errors();
 }
 
 void
 chat_log_close(void)
 {
+    if (writer_running) {
+        // the writer drains the queue before exiting
+        g_atomic_int_set(&writer_stop, 1);
+        _chat_log_wake_writer();
+        pthread_join(writer_thread, NULL);
+        writer_running = FALSE;
+    }
+
     g_hash_table_destroy(logs);
     g_hash_table_destroy(groupchat_logs);
+    g_queue_free(open_logs);
+    open_logs = NULL;
+
+    _chat_log_report_errors();
+    g_async_queue_unref(writer_errors);
+    writer_errors = NULL;
+    free(chatlogs_dir);
+    chatlogs_dir = NULL;
     g_date_time_unref(session_started);
 }
 
+static void
+_chat_log_push(chat_log_op_t op, const char *const login, const char *const jid, gchar *line)
+{
+    _chat_log_report_errors();
+
+    if (!writer_running) {
+        if (pthread_create(&writer_thread, NULL, _chat_log_writer, NULL) != 0) {
+            log_error("Unable to start chat log writer thread");
+            g_free(line);
+            return;
+        }
+        writer_running = TRUE;
+    }
+
+    struct chat_log_entry *entry = malloc(sizeof(struct chat_log_entry));
+    entry->op = op;
+    entry->login = g_strdup(login);
+    entry->jid = g_strdup(jid);
+    entry->line = line;
+    entry->flush_interval = prefs_get_chlog_flush();
+
+    int tail = g_atomic_int_get(&queue_tail);
+    if (tail - g_atomic_int_get(&queue_head) == CHAT_LOG_QUEUE_SIZE) {
+        // queue full, wait for the writer to catch up
+        stats_stalls++;
+        do {
+            _chat_log_wake_writer();
+            g_usleep(1000);
+        } while (tail - g_atomic_int_get(&queue_head) == CHAT_LOG_QUEUE_SIZE);
+    }
+
+    queue[tail % CHAT_LOG_QUEUE_SIZE] = entry;
+    g_atomic_int_set(&queue_tail, tail + 1);
+
+    guint depth = (guint)(tail + 1 - g_atomic_int_get(&queue_head));
+    if (depth > stats_high_water) {
+        stats_high_water = depth;
+    }
+
+    if (g_atomic_int_get(&writer_waiting)) {
+        _chat_log_wake_writer();
+    }
+}
+
+static struct chat_log_entry*
+_chat_log_pop(void)
+{
+    int head = g_atomic_int_get(&queue_head);
+    if (head == g_atomic_int_get(&queue_tail)) {
+        return NULL;
+    }
+
+    struct chat_log_entry *entry = queue[head % CHAT_LOG_QUEUE_SIZE];
+    g_atomic_int_set(&queue_head, head + 1);
+
+    return entry;
+}
+
+static void
+_chat_log_wake_writer(void)
+{
+    pthread_mutex_lock(&writer_mutex);
+    pthread_cond_signal(&writer_cond);
+    pthread_mutex_unlock(&writer_mutex);
+}
+
+static void*
+_chat_log_writer(void *arg)
+{
+    struct chat_log_entry *entry = NULL;
+
+    while (!g_atomic_int_get(&writer_stop)) {
+        entry = _chat_log_pop();
+        if (entry) {
+            _chat_log_write_entry(entry);
+            _chat_log_free_entry(entry);
+            continue;
+        }
+
+        pthread_mutex_lock(&writer_mutex);
+        g_atomic_int_set(&writer_waiting, 1);
+        if (g_atomic_int_get(&queue_head) == g_atomic_int_get(&queue_tail) && !g_atomic_int_get(&writer_stop)) {
+            if (flush_interval > 0 && next_flush > 0) {
+                // sleep until new entries arrive or pending lines are due
+                gint64 wait = next_flush - g_get_monotonic_time();
+                if (wait < 0) {
+                    wait = 0;
+                }
+                struct timeval now;
+                gettimeofday(&now, NULL);
+                gint64 until = (gint64)now.tv_sec * G_USEC_PER_SEC + now.tv_usec + wait;
+                struct timespec deadline;
+                deadline.tv_sec = until / G_USEC_PER_SEC;
+                deadline.tv_nsec = (until % G_USEC_PER_SEC) * 1000;
+                pthread_cond_timedwait(&writer_cond, &writer_mutex, &deadline);
+            } else {
+                pthread_cond_wait(&writer_cond, &writer_mutex);
+            }
+        }
+        g_atomic_int_set(&writer_waiting, 0);
+        pthread_mutex_unlock(&writer_mutex);
+
+        if (next_flush > 0 && g_get_monotonic_time() >= next_flush) {
+            _chat_log_flush_all();
+        }
+    }
+
+    // drain anything queued before the stop request
+    while ((entry = _chat_log_pop()) != NULL) {
+        _chat_log_write_entry(entry);
+        _chat_log_free_entry(entry);
+    }
+    _chat_log_flush_all();
+
+    return NULL;
+}
+
+static void
+_chat_log_write_entry(struct chat_log_entry *entry)
+{
+    if (entry->op == CHAT_LOG_SYNC) {
+        _chat_log_flush_all();
+        pthread_mutex_lock(&writer_mutex);
+        g_atomic_int_inc(&sync_completed);
+        pthread_cond_broadcast(&sync_cond);
+        pthread_mutex_unlock(&writer_mutex);
+        return;
+    }
+
+    flush_interval = entry->flush_interval;
+
+    GHashTable *table = entry->op == CHAT_LOG_CHAT ? logs : groupchat_logs;
+    struct dated_chat_log *dated_log = g_hash_table_lookup(table, entry->jid);
+
+    // no log for user or room, or log exists but needs rolling
+    if (dated_log == NULL || _log_roll_needed(dated_log)) {
+        if (entry->op == CHAT_LOG_CHAT) {
+            dated_log = _create_log(entry->jid, entry->login);
+        } else {
+            dated_log = _create_groupchat_log(entry->jid, entry->login);
+        }
+        g_hash_table_replace(table, strdup(entry->jid), dated_log);
+    }
+
+    FILE *logp = _chat_log_open(dated_log);
+    if (logp) {
+        long offset = ftell(logp);
+        if (fputs(entry->line, logp) == EOF) {
+            _chat_log_writer_error("writing", dated_log->filename, errno);
+        } else {
+            g_atomic_int_inc(&stats_written);
+            log_index_add_line(dated_log->filename, offset, entry->line);
+        }
+        _chat_log_written(dated_log);
+    }
+}
+
+static void
+_chat_log_writer_error(const char *const action, const char *const filename, int err)
+{
+    g_atomic_int_inc(&stats_errors);
+
+    struct chat_log_error *error = malloc(sizeof(struct chat_log_error));
+    error->action = action;
+    error->filename = g_strdup(filename);
+    error->err = err;
+    g_async_queue_push(writer_errors, error);
+}
+
+// create_dir() may log, which reads preferences, so the writer thread makes its
+// own directories and reports failures through the error queue
+static void
+_chat_log_create_dir(const char *const dir)
+{
+    struct stat sb;
+
+    if (stat(dir, &sb) == 0) {
+        if (!S_ISDIR(sb.st_mode)) {
+            _chat_log_writer_error("creating", dir, ENOTDIR);
+        }
+    } else if (errno != ENOENT || mkdir(dir, S_IRWXU) != 0) {
+        if (errno != EEXIST) {
+            _chat_log_writer_error("creating", dir, errno);
+        }
+    }
+}
+
+static void
+_chat_log_report_errors(void)
+{
+    if (writer_errors == NULL) {
+        return;
+    }
+
+    struct chat_log_error *error = g_async_queue_try_pop(writer_errors);
+    while (error) {
+        log_error("Error %s file %s: %s", error->action, error->filename, strerror(error->err));
+        g_free(error->filename);
+        free(error);
+        error = g_async_queue_try_pop(writer_errors);
+    }
+}
+
+static void
+_chat_log_free_entry(struct chat_log_entry *entry)
+{
+    g_free(entry->login);
+    g_free(entry->jid);
+    g_free(entry->line);
+    free(entry);
+}
+
+static void
+_chat_log_flush_all(void)
+{
+    GList *curr = g_queue_peek_head_link(open_logs);
+    while (curr) {
+        struct dated_chat_log *dated_log = curr->data;
+        if (dated_log->dirty) {
+            _chat_log_fflush(dated_log);
+        }
+        curr = g_list_next(curr);
+    }
+
+    next_flush = 0;
+}
+
+static void
+_chat_log_fflush(struct dated_chat_log *dated_log)
+{
+    fflush(dated_log->fp);
+    dated_log->dirty = FALSE;
+
+    // lines the index skipped while they were buffered can be read back now
+    log_index_flushed(dated_log->filename, ftell(dated_log->fp));
+}
+
 static struct dated_chat_log*
 _create_log(const char *const other, const char *const login)
 {
     GDateTime *now = g_date_time_new_now_local();
     char *filename = _get_log_filename(other, login, now, TRUE);
 
-    struct dated_chat_log *new_log = malloc(sizeof(struct dated_chat_log));
-    new_log->filename = strdup(filename);
-    new_log->date = now;
-
-    free(filename);
-
-    return new_log;
+    return _new_dated_log(filename, now);
 }
 
 static struct dated_chat_log*
@@ -518,33 +973,115 @@ _create_groupchat_log(const char * const room, const char *const login)
     GDateTime *now = g_date_time_new_now_local();
     char *filename = _get_groupchat_log_filename(room, login, now, TRUE);
 
+    return _new_dated_log(filename, now);
+}
+
+static struct dated_chat_log*
+_new_dated_log(char *filename, GDateTime *date)
+{
     struct dated_chat_log *new_log = malloc(sizeof(struct dated_chat_log));
     new_log->filename = strdup(filename);
-    new_log->date = now;
+    new_log->date = date;
+    new_log->fp = NULL;
+    new_log->open_link = NULL;
+    new_log->dirty = FALSE;
+
+    // the log rolls over at the next local midnight
+    GDateTime *midnight = g_date_time_new_local(
+        g_date_time_get_year(date),
+        g_date_time_get_month(date),
+        g_date_time_get_day_of_month(date),
+        0, 0, 0);
+    GDateTime *tomorrow = g_date_time_add_days(midnight, 1);
+    new_log->rollover = g_date_time_to_unix(tomorrow) * G_USEC_PER_SEC;
+    g_date_time_unref(tomorrow);
+    g_date_time_unref(midnight);
 
     free(filename);
 
     return new_log;
 }
 
-static gboolean
-_log_roll_needed(struct dated_chat_log *dated_log)
+static FILE*
+_chat_log_open(struct dated_chat_log *dated_log)
 {
-    gboolean result = FALSE;
-    GDateTime *now = g_date_time_new_now_local();
-    if (g_date_time_get_day_of_year(dated_log->date) !=
-            g_date_time_get_day_of_year(now)) {
-        result = TRUE;
+    if (dated_log->fp) {
+        // most recently used logs stay at the head of the queue
+        g_queue_unlink(open_logs, dated_log->open_link);
+        g_queue_push_head_link(open_logs, dated_log->open_link);
+        return dated_log->fp;
     }
-    g_date_time_unref(now);
 
-    return result;
+    if (g_queue_get_length(open_logs) >= CHAT_LOG_MAX_OPEN) {
+        _chat_log_file_close(g_queue_peek_tail(open_logs));
+    }
+
+    dated_log->fp = fopen(dated_log->filename, "a");
+    if (dated_log->fp == NULL) {
+        _chat_log_writer_error("opening", dated_log->filename, errno);
+        return NULL;
+    }
+    g_chmod(dated_log->filename, S_IRUSR | S_IWUSR);
+    fseek(dated_log->fp, 0, SEEK_END);
+
+    g_queue_push_head(open_logs, dated_log);
+    dated_log->open_link = g_queue_peek_head_link(open_logs);
+
+    return dated_log->fp;
+}
+
+static void
+_chat_log_written(struct dated_chat_log *dated_log)
+{
+    if (flush_interval == 0) {
+        _chat_log_fflush(dated_log);
+        return;
+    }
+
+    dated_log->dirty = TRUE;
+    gint64 now = g_get_monotonic_time();
+    if (next_flush == 0) {
+        next_flush = now + (gint64)flush_interval * G_USEC_PER_SEC;
+    } else if (now >= next_flush) {
+        _chat_log_flush_all();
+    }
+}
+
+static void
+_chat_log_file_close(struct dated_chat_log *dated_log)
+{
+    if (dated_log->fp == NULL) {
+        return;
+    }
+
+    if (dated_log->dirty) {
+        _chat_log_fflush(dated_log);
+    }
+
+    int result = fclose(dated_log->fp);
+    if (result == EOF) {
+        _chat_log_writer_error("closing", dated_log->filename, errno);
+    }
+    dated_log->fp = NULL;
+    dated_log->dirty = FALSE;
+
+    if (open_logs) {
+        g_queue_delete_link(open_logs, dated_log->open_link);
+    }
+    dated_log->open_link = NULL;
+}
+
+static gboolean
+_log_roll_needed(struct dated_chat_log *dated_log)
+{
+    return g_get_real_time() >= dated_log->rollover;
 }
 
 static void
 _free_chat_log(struct dated_chat_log *dated_log)
 {
     if (dated_log) {
+        _chat_log_file_close(dated_log);
         if (dated_log->filename) {
             g_free(dated_log->filename);
             dated_log->filename = NULL;
@@ -569,21 +1106,19 @@ gboolean _key_equals(void *key1, void *key2)
 static char*
 _get_log_filename(const char *const other, const char *const login, GDateTime *dt, gboolean create)
 {
-    char *chatlogs_dir = files_get_data_path(DIR_CHATLOGS);
     GString *log_file = g_string_new(chatlogs_dir);
-    free(chatlogs_dir);
 
     gchar *login_dir = str_replace(login, "@", "_at_");
     g_string_append_printf(log_file, "/%s", login_dir);
     if (create) {
-        create_dir(log_file->str);
+        _chat_log_create_dir(log_file->str);
     }
     free(login_dir);
 
     gchar *other_file = str_replace(other, "@", "_at_");
     g_string_append_printf(log_file, "/%s", other_file);
     if (create) {
-        create_dir(log_file->str);
+        _chat_log_create_dir(log_file->str);
     }
     free(other_file);
 
@@ -600,26 +1135,24 @@ _get_log_filename(const char *const other, const char *const login, GDateTime *d
 static char*
 _get_groupchat_log_filename(const char *const room, const char *const login, GDateTime *dt, gboolean create)
 {
-    char *chatlogs_dir = files_get_data_path(DIR_CHATLOGS);
     GString *log_file = g_string_new(chatlogs_dir);
-    free(chatlogs_dir);
 
     gchar *login_dir = str_replace(login, "@", "_at_");
     g_string_append_printf(log_file, "/%s", login_dir);
     if (create) {
-        create_dir(log_file->str);
+        _chat_log_create_dir(log_file->str);
     }
     free(login_dir);
 
     g_string_append(log_file, "/rooms");
     if (create) {
-        create_dir(log_file->str);
+        _chat_log_create_dir(log_file->str);
     }
 
     gchar *room_file = str_replace(room, "@", "_at_");
     g_string_append_printf(log_file, "/%s", room_file);
     if (create) {
-        create_dir(log_file->str);
+        _chat_log_create_dir(log_file->str);
     }
     free(room_file);
 
@@ -685,6 +1218,17 @@ log_stderr_handler(void)
     }
 }
 
+// read end of the stderr pipe, -1 when stderr is not redirected
+int
+log_stderr_get_fd(void)
+{
+    if (!stderr_inited) {
+        return -1;
+    }
+
+    return stderr_pipe[0];
+}
+
 void
 log_stderr_init(log_level_t level)
 {
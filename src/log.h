@@ -50,6 +50,16 @@ typedef enum {
     PROF_OUT_LOG
 } chat_log_direction_t;
 
+typedef struct chat_log_stats_t {
+    guint queued;
+    guint high_water;
+    guint stalls;
+    guint written;
+    guint errors;
+} ChatLogStats;
+
+typedef struct chat_log_history_t *ChatLogHistory;
+
 void log_init(log_level_t filter);
 log_level_t log_get_filter(void);
 void log_close(void);
@@ -65,6 +75,7 @@ log_level_t log_level_from_string(char *log_level);
 void log_stderr_init(log_level_t level);
 void log_stderr_close(void);
 void log_stderr_handler(void);
+int log_stderr_get_fd(void);
 
 void chat_log_init(void);
 
@@ -76,8 +87,13 @@ void chat_log_msg_in(const char *const barejid, const char *const msg, GDateTime
 void chat_log_otr_msg_in(const char *const barejid, const char *const msg, gboolean was_decrypted, GDateTime *timestamp);
 void chat_log_pgp_msg_in(const char *const barejid, const char *const msg, GDateTime *timestamp);
 
+void chat_log_flush(void);
+void chat_log_get_stats(ChatLogStats *stats);
 void chat_log_close(void);
-GSList* chat_log_get_previous(const gchar *const login, const gchar *const recipient);
+ChatLogHistory chat_log_history_new(const gchar *const login, const gchar *const recipient);
+GSList* chat_log_history_previous(ChatLogHistory history, int count);
+gboolean chat_log_history_finished(ChatLogHistory history);
+void chat_log_history_free(ChatLogHistory history);
 
 void groupchat_log_init(void);
 void groupchat_log_chat(const gchar *const login, const gchar *const room, const gchar *const nick,
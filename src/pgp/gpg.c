@@ -38,6 +38,10 @@
 #include <string.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
 
 #include <glib.h>
@@ -47,6 +51,7 @@
 #include "log.h"
 #include "common.h"
 #include "pgp/gpg.h"
+#include "pgp/sig_cache.h"
 #include "config/files.h"
 #include "tools/autocomplete.h"
 #include "ui/ui.h"
@@ -56,6 +61,38 @@
 #define PGP_MESSAGE_HEADER "-----BEGIN PGP MESSAGE-----"
 #define PGP_MESSAGE_FOOTER "-----END PGP MESSAGE-----"
 
+#define PGP_WORKERS 2
+
+typedef enum {
+    PGP_JOB_DECRYPT,
+    PGP_JOB_VERIFY,
+    PGP_JOB_SIGN,
+    PGP_JOB_STOP
+} pgp_job_type_t;
+
+typedef struct pgp_job_t {
+    pgp_job_type_t type;
+    char *barejid;
+    char *input;
+    char *fp;
+    char *passphrase;
+    char *result;
+    GSList *logs;
+    // run again on the main thread, where a passphrase can be asked for
+    gboolean retry;
+    gint done;
+    // results from before a disconnect are dropped
+    gint generation;
+    ProfPGPCallback callback;
+    void *userdata;
+    GDestroyNotify free_userdata;
+} ProfPGPJob;
+
+typedef struct pgp_job_log_t {
+    log_level_t level;
+    char *msg;
+} ProfPGPJobLog;
+
 static const char *libversion;
 static GHashTable *pubkeys;
 
@@ -67,9 +104,38 @@ static char *passphrase_attempt;
 
 static Autocomplete key_ac;
 
+// context for operations run on the main thread, workers own their own
+static gpgme_ctx_t main_ctx;
+
+// keys resolved by id or fingerprint, shared by all threads
+static GHashTable *key_cache;
+static pthread_mutex_t key_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// jobs are queued to the workers and delivered from inflight in order
+static GAsyncQueue *jobs;
+static GQueue *inflight;
+static pthread_t workers[PGP_WORKERS];
+static gboolean workers_running;
+static gint generation;
+
+// written to when a job is done, so the input poll wakes to deliver it
+static int results_pipe[2] = { -1, -1 };
+
 static char* _remove_header_footer(char *str, const char *const footer);
 static char* _add_header_footer(const char *const str, const char *const header, const char *const footer);
 static void _save_pubkeys(void);
+static gpgme_ctx_t _p_gpg_ctx(void);
+static gpgme_key_t _p_gpg_get_key(gpgme_ctx_t ctx, const char *const id, int secret, gpgme_error_t *error);
+static void _p_gpg_clear_keys(void);
+static void _p_gpg_log(ProfPGPJob *job, log_level_t level, const char *const msg, ...);
+static char* _p_gpg_sign(ProfPGPJob *job, gpgme_ctx_t ctx, const char *const str, const char *const fp);
+static char* _p_gpg_verify(ProfPGPJob *job, gpgme_ctx_t ctx, const char *const barejid, const char *const sign);
+static char* _p_gpg_decrypt(ProfPGPJob *job, gpgme_ctx_t ctx, const char *const cipher);
+static void _p_gpg_verified(const char *const barejid, const char *const keyid);
+static void _p_gpg_job_free(ProfPGPJob *job);
+static void _p_gpg_workers_stop(void);
+static void _p_gpg_job_done(ProfPGPJob *job);
+static gboolean _p_gpg_verifying(const char *const barejid);
 
 void
 _p_gpg_free_pubkeyid(ProfPGPPubKeyId *pubkeyid)
@@ -116,6 +182,21 @@ p_gpg_init(void)
 
     pubkeys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)_p_gpg_free_pubkeyid);
 
+    key_cache = g_hash_table_new_full(g_str_hash, g_str_equal, free, (GDestroyNotify)gpgme_key_unref);
+    main_ctx = NULL;
+    inflight = g_queue_new();
+    sig_cache_init();
+    workers_running = FALSE;
+
+    if (pipe(results_pipe) == 0) {
+        fcntl(results_pipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(results_pipe[1], F_SETFL, O_NONBLOCK);
+    } else {
+        log_error("GPG: Unable to create results pipe");
+        results_pipe[0] = -1;
+        results_pipe[1] = -1;
+    }
+
     key_ac = autocomplete_new();
     GHashTable *keys = p_gpg_list_keys();
     p_gpg_free_keys(keys);
@@ -127,6 +208,28 @@ p_gpg_init(void)
 void
 p_gpg_close(void)
 {
+    _p_gpg_workers_stop();
+    g_queue_free(inflight);
+    inflight = NULL;
+
+    if (results_pipe[0] != -1) {
+        close(results_pipe[0]);
+        close(results_pipe[1]);
+        results_pipe[0] = -1;
+        results_pipe[1] = -1;
+    }
+
+    if (main_ctx) {
+        gpgme_release(main_ctx);
+        main_ctx = NULL;
+    }
+
+    _p_gpg_clear_keys();
+    g_hash_table_destroy(key_cache);
+    key_cache = NULL;
+
+    sig_cache_close();
+
     if (pubkeys) {
         g_hash_table_destroy(pubkeys);
         pubkeys = NULL;
@@ -177,6 +280,10 @@ p_gpg_on_connect(const char *const barejid)
         }
     }
 
+    char *sigcacheloc = g_strdup_printf("%s/sigcache", pubsfile->str);
+    sig_cache_load(sigcacheloc);
+    g_free(sigcacheloc);
+
     // create or read publickeys
     g_string_append(pubsfile, "/pubkeys");
     pubsloc = pubsfile->str;
@@ -237,6 +344,9 @@ p_gpg_on_connect(const char *const barejid)
 void
 p_gpg_on_disconnect(void)
 {
+    // jobs still with the workers belong to the old session
+    g_atomic_int_inc(&generation);
+
     if (pubkeys) {
         g_hash_table_destroy(pubkeys);
         pubkeys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)_p_gpg_free_pubkeyid);
@@ -250,6 +360,10 @@ p_gpg_on_disconnect(void)
     free(pubsloc);
     pubsloc = NULL;
 
+    _p_gpg_clear_keys();
+    sig_cache_save();
+    sig_cache_clear();
+
     if (passphrase) {
         free(passphrase);
         passphrase = NULL;
@@ -470,120 +584,32 @@ p_gpg_verify(const char *const barejid, const char *const sign)
         return;
     }
 
-    gpgme_ctx_t ctx;
-    gpgme_error_t error = gpgme_new(&ctx);
-
-    if (error) {
-        log_error("GPG: Failed to create gpgme context. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+    const char *cached = sig_cache_lookup(barejid, sign);
+    if (cached) {
+        _p_gpg_verified(barejid, cached);
         return;
     }
 
-    char *sign_with_header_footer = _add_header_footer(sign, PGP_SIGNATURE_HEADER, PGP_SIGNATURE_FOOTER);
-    gpgme_data_t sign_data;
-    gpgme_data_new_from_mem(&sign_data, sign_with_header_footer, strlen(sign_with_header_footer), 1);
-    free(sign_with_header_footer);
-
-    gpgme_data_t plain_data;
-    gpgme_data_new(&plain_data);
-
-    error = gpgme_op_verify(ctx, sign_data, NULL, plain_data);
-    gpgme_data_release(sign_data);
-    gpgme_data_release(plain_data);
-
-    if (error) {
-        log_error("GPG: Failed to verify. %s %s", gpgme_strsource(error), gpgme_strerror(error));
-        gpgme_release(ctx);
+    gpgme_ctx_t ctx = _p_gpg_ctx();
+    if (ctx == NULL) {
         return;
     }
 
-    gpgme_verify_result_t result = gpgme_op_verify_result(ctx);
-    if (result) {
-        if (result->signatures) {
-            gpgme_key_t key = NULL;
-            error = gpgme_get_key(ctx, result->signatures->fpr, &key, 0);
-            if (error) {
-                log_debug("Could not find PGP key with ID %s for %s", result->signatures->fpr, barejid);
-            } else {
-                log_debug("Fingerprint found for %s: %s ", barejid, key->subkeys->fpr);
-                ProfPGPPubKeyId *pubkeyid = malloc(sizeof(ProfPGPPubKeyId));
-                pubkeyid->id = strdup(key->subkeys->keyid);
-                pubkeyid->received = TRUE;
-                g_hash_table_replace(pubkeys, strdup(barejid), pubkeyid);
-            }
-
-            gpgme_key_unref(key);
-        }
-    }
-
-    gpgme_release(ctx);
+    char *keyid = _p_gpg_verify(NULL, ctx, barejid, sign);
+    _p_gpg_verified(barejid, keyid);
+    sig_cache_add(barejid, sign, keyid);
+    free(keyid);
 }
 
 char*
 p_gpg_sign(const char *const str, const char *const fp)
 {
-    gpgme_ctx_t ctx;
-    gpgme_error_t error = gpgme_new(&ctx);
-    if (error) {
-        log_error("GPG: Failed to create gpgme context. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+    gpgme_ctx_t ctx = _p_gpg_ctx();
+    if (ctx == NULL) {
         return NULL;
     }
 
-    gpgme_set_passphrase_cb(ctx, (gpgme_passphrase_cb_t)_p_gpg_passphrase_cb, NULL);
-
-    gpgme_key_t key = NULL;
-    error = gpgme_get_key(ctx, fp, &key, 1);
-
-    if (error || key == NULL) {
-        log_error("GPG: Failed to get key. %s %s", gpgme_strsource(error), gpgme_strerror(error));
-        gpgme_release(ctx);
-        return NULL;
-    }
-
-    gpgme_signers_clear(ctx);
-    error = gpgme_signers_add(ctx, key);
-    gpgme_key_unref(key);
-
-    if (error) {
-        log_error("GPG: Failed to load signer. %s %s", gpgme_strsource(error), gpgme_strerror(error));
-        gpgme_release(ctx);
-        return NULL;
-    }
-
-    char *str_or_empty = NULL;
-    if (str) {
-        str_or_empty = strdup(str);
-    } else {
-        str_or_empty = strdup("");
-    }
-    gpgme_data_t str_data;
-    gpgme_data_new_from_mem(&str_data, str_or_empty, strlen(str_or_empty), 1);
-    free(str_or_empty);
-
-    gpgme_data_t signed_data;
-    gpgme_data_new(&signed_data);
-
-    gpgme_set_armor(ctx,1);
-    error = gpgme_op_sign(ctx, str_data, signed_data, GPGME_SIG_MODE_DETACH);
-    gpgme_data_release(str_data);
-    gpgme_release(ctx);
-
-    if (error) {
-        log_error("GPG: Failed to sign string. %s %s", gpgme_strsource(error), gpgme_strerror(error));
-        gpgme_data_release(signed_data);
-        return NULL;
-    }
-
-    char *result = NULL;
-
-    size_t len = 0;
-    char *signed_str = gpgme_data_release_and_get_mem(signed_data, &len);
-    if (signed_str) {
-        GString *signed_gstr = g_string_new("");
-        g_string_append_len(signed_gstr, signed_str, len);
-        result = _remove_header_footer(signed_gstr->str, PGP_SIGNATURE_FOOTER);
-        g_string_free(signed_gstr, TRUE);
-        gpgme_free(signed_str);
-    }
+    char *result = _p_gpg_sign(NULL, ctx, str, fp);
 
     if (passphrase_attempt) {
         passphrase = strdup(passphrase_attempt);
@@ -609,27 +635,23 @@ p_gpg_encrypt(const char *const barejid, const char *const message, const char *
     keys[1] = NULL;
     keys[2] = NULL;
 
-    gpgme_ctx_t ctx;
-    gpgme_error_t error = gpgme_new(&ctx);
-    if (error) {
-        log_error("GPG: Failed to create gpgme context. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+    gpgme_ctx_t ctx = _p_gpg_ctx();
+    if (ctx == NULL) {
         return NULL;
     }
 
-    gpgme_key_t receiver_key;
-    error = gpgme_get_key(ctx, pubkeyid->id, &receiver_key, 0);
-    if (error || receiver_key == NULL) {
+    gpgme_error_t error;
+    gpgme_key_t receiver_key = _p_gpg_get_key(ctx, pubkeyid->id, 0, &error);
+    if (receiver_key == NULL) {
         log_error("GPG: Failed to get receiver_key. %s %s", gpgme_strsource(error), gpgme_strerror(error));
-        gpgme_release(ctx);
         return NULL;
     }
     keys[0] = receiver_key;
 
-    gpgme_key_t sender_key = NULL;
-    error = gpgme_get_key(ctx, fp, &sender_key, 0);
-    if (error || sender_key == NULL) {
+    gpgme_key_t sender_key = _p_gpg_get_key(ctx, fp, 0, &error);
+    if (sender_key == NULL) {
         log_error("GPG: Failed to get sender_key. %s %s", gpgme_strsource(error), gpgme_strerror(error));
-        gpgme_release(ctx);
+        gpgme_key_unref(receiver_key);
         return NULL;
     }
     keys[1] = sender_key;
@@ -643,7 +665,6 @@ p_gpg_encrypt(const char *const barejid, const char *const message, const char *
     gpgme_set_armor(ctx, 1);
     error = gpgme_op_encrypt(ctx, keys, GPGME_ENCRYPT_ALWAYS_TRUST, plain, cipher);
     gpgme_data_release(plain);
-    gpgme_release(ctx);
     gpgme_key_unref(receiver_key);
     gpgme_key_unref(sender_key);
 
@@ -670,76 +691,339 @@ p_gpg_encrypt(const char *const barejid, const char *const message, const char *
 char*
 p_gpg_decrypt(const char *const cipher)
 {
-    gpgme_ctx_t ctx;
-    gpgme_error_t error = gpgme_new(&ctx);
-
-    if (error) {
-        log_error("GPG: Failed to create gpgme context. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+    gpgme_ctx_t ctx = _p_gpg_ctx();
+    if (ctx == NULL) {
         return NULL;
     }
 
-    gpgme_set_passphrase_cb(ctx, (gpgme_passphrase_cb_t)_p_gpg_passphrase_cb, NULL);
+    char *result = _p_gpg_decrypt(NULL, ctx, cipher);
 
-    char *cipher_with_headers = _add_header_footer(cipher, PGP_MESSAGE_HEADER, PGP_MESSAGE_FOOTER);
-    gpgme_data_t cipher_data;
-    gpgme_data_new_from_mem(&cipher_data, cipher_with_headers, strlen(cipher_with_headers), 1);
-    free(cipher_with_headers);
+    if (passphrase_attempt) {
+        passphrase = strdup(passphrase_attempt);
+    }
 
-    gpgme_data_t plain_data;
-    gpgme_data_new(&plain_data);
+    return result;
+}
 
-    error = gpgme_op_decrypt(ctx, cipher_data, plain_data);
-    gpgme_data_release(cipher_data);
+static gpgme_error_t
+_p_gpg_worker_passphrase_cb(void *hook, const char *uid_hint, const char *passphrase_info, int prev_was_bad, int fd)
+{
+    ProfPGPJob *job = hook;
 
-    if (error) {
-        log_error("GPG: Failed to encrypt message. %s %s", gpgme_strsource(error), gpgme_strerror(error));
-        gpgme_data_release(plain_data);
-        gpgme_release(ctx);
-        return NULL;
+    // workers cannot prompt, the job is run again on the main thread
+    if (job->passphrase == NULL || prev_was_bad) {
+        job->retry = TRUE;
+        return gpg_error(GPG_ERR_CANCELED);
     }
 
-    gpgme_decrypt_result_t res = gpgme_op_decrypt_result(ctx);
-    if (res) {
-        GString *recipients_str = g_string_new("");
-        gpgme_recipient_t recipient = res->recipients;
-        while (recipient) {
-            gpgme_key_t key;
-            error = gpgme_get_key(ctx, recipient->keyid, &key, 1);
+    gpgme_io_write(fd, job->passphrase, strlen(job->passphrase));
 
-            if (!error && key) {
-                const char *addr = gpgme_key_get_string_attr(key, GPGME_ATTR_EMAIL, NULL, 0);
-                if (addr) {
-                    g_string_append(recipients_str, addr);
-                }
-                gpgme_key_unref(key);
-            }
+    return 0;
+}
 
-            if (recipient->next) {
-                g_string_append(recipients_str, ", ");
+static void*
+_p_gpg_worker(void *arg)
+{
+    gpgme_ctx_t ctx = NULL;
+    if (gpgme_new(&ctx) != 0) {
+        ctx = NULL;
+    }
+
+    while (TRUE) {
+        ProfPGPJob *job = g_async_queue_pop(jobs);
+        if (job->type == PGP_JOB_STOP) {
+            _p_gpg_job_free(job);
+            break;
+        }
+
+        if (job->generation != g_atomic_int_get(&generation)) {
+            _p_gpg_job_done(job);
+            continue;
+        }
+
+        if (ctx) {
+            gpgme_set_passphrase_cb(ctx, _p_gpg_worker_passphrase_cb, job);
+            switch (job->type) {
+            case PGP_JOB_DECRYPT:
+                job->result = _p_gpg_decrypt(job, ctx, job->input);
+                break;
+            case PGP_JOB_VERIFY:
+                job->result = _p_gpg_verify(job, ctx, job->barejid, job->input);
+                break;
+            case PGP_JOB_SIGN:
+                job->result = _p_gpg_sign(job, ctx, job->input, job->fp);
+                break;
+            default:
+                break;
             }
+            gpgme_set_passphrase_cb(ctx, NULL, NULL);
+        } else {
+            job->retry = TRUE;
+        }
 
-            recipient = recipient->next;
+        _p_gpg_job_done(job);
+    }
+
+    if (ctx) {
+        gpgme_release(ctx);
+    }
+
+    return NULL;
+}
+
+static void
+_p_gpg_workers_start(void)
+{
+    jobs = g_async_queue_new();
+
+    int i;
+    for (i = 0; i < PGP_WORKERS; i++) {
+        if (pthread_create(&workers[i], NULL, _p_gpg_worker, NULL) != 0) {
+            log_error("GPG: Unable to start worker thread");
+            break;
         }
+    }
 
-        log_debug("GPG: Decrypted message for recipients: %s", recipients_str->str);
-        g_string_free(recipients_str, TRUE);
+    if (i == 0) {
+        g_async_queue_unref(jobs);
+        jobs = NULL;
+        return;
     }
-    gpgme_release(ctx);
 
-    size_t len = 0;
-    char *plain_str = gpgme_data_release_and_get_mem(plain_data, &len);
-    char *result = NULL;
-    if (plain_str) {
-        plain_str[len] = 0;
-        result = g_strdup(plain_str);
+    // only join the workers that started
+    for (; i < PGP_WORKERS; i++) {
+        workers[i] = 0;
     }
-    gpgme_free(plain_str);
+    workers_running = TRUE;
+}
 
-    if (passphrase_attempt) {
-        passphrase = strdup(passphrase_attempt);
+static void
+_p_gpg_workers_stop(void)
+{
+    if (!workers_running) {
+        return;
     }
 
-    return result;
+    // workers take jobs in order, so everything queued before the stop jobs
+    // is finished when they are joined
+    int i;
+    for (i = 0; i < PGP_WORKERS; i++) {
+        if (workers[i]) {
+            ProfPGPJob *stop = calloc(1, sizeof(ProfPGPJob));
+            stop->type = PGP_JOB_STOP;
+            g_async_queue_push(jobs, stop);
+        }
+    }
+    for (i = 0; i < PGP_WORKERS; i++) {
+        if (workers[i]) {
+            pthread_join(workers[i], NULL);
+        }
+    }
+    workers_running = FALSE;
+
+    g_async_queue_unref(jobs);
+    jobs = NULL;
+
+    // results are dropped, nothing is left to deliver them to
+    g_queue_foreach(inflight, (GFunc)_p_gpg_job_free, NULL);
+    g_queue_clear(inflight);
+}
+
+static void
+_p_gpg_job_done(ProfPGPJob *job)
+{
+    g_atomic_int_set(&job->done, 1);
+
+    if (results_pipe[1] != -1) {
+        ssize_t res = write(results_pipe[1], "r", 1);
+        (void)res;
+    }
+}
+
+static void
+_p_gpg_job_free(ProfPGPJob *job)
+{
+    if (job->free_userdata && job->userdata) {
+        job->free_userdata(job->userdata);
+    }
+    free(job->barejid);
+    free(job->input);
+    free(job->fp);
+    free(job->passphrase);
+    if (job->type == PGP_JOB_DECRYPT) {
+        p_gpg_free_decrypted(job->result);
+    } else {
+        free(job->result);
+    }
+    GSList *curr = job->logs;
+    while (curr) {
+        ProfPGPJobLog *log = curr->data;
+        free(log->msg);
+        free(log);
+        curr = g_slist_next(curr);
+    }
+    g_slist_free(job->logs);
+    free(job);
+}
+
+static ProfPGPJob*
+_p_gpg_job_new(pgp_job_type_t type, const char *const barejid, const char *const input, const char *const fp,
+    ProfPGPCallback callback, void *userdata, GDestroyNotify free_userdata)
+{
+    ProfPGPJob *job = calloc(1, sizeof(ProfPGPJob));
+    job->type = type;
+    job->barejid = barejid ? strdup(barejid) : NULL;
+    job->input = input ? strdup(input) : strdup("");
+    job->fp = fp ? strdup(fp) : NULL;
+    job->passphrase = passphrase ? strdup(passphrase) : NULL;
+    job->callback = callback;
+    job->userdata = userdata;
+    job->free_userdata = free_userdata;
+    job->generation = g_atomic_int_get(&generation);
+
+    return job;
+}
+
+static void
+_p_gpg_submit(pgp_job_type_t type, const char *const barejid, const char *const input, const char *const fp,
+    ProfPGPCallback callback, void *userdata, GDestroyNotify free_userdata)
+{
+    ProfPGPJob *job = _p_gpg_job_new(type, barejid, input, fp, callback, userdata, free_userdata);
+
+    if (!workers_running) {
+        _p_gpg_workers_start();
+    }
+
+    g_queue_push_tail(inflight, job);
+
+    if (workers_running) {
+        g_async_queue_push(jobs, job);
+    } else {
+        job->retry = TRUE;
+        _p_gpg_job_done(job);
+    }
+}
+
+void
+p_gpg_decrypt_async(const char *const cipher, ProfPGPCallback callback, void *userdata, GDestroyNotify free_userdata)
+{
+    _p_gpg_submit(PGP_JOB_DECRYPT, NULL, cipher, NULL, callback, userdata, free_userdata);
+}
+
+void
+p_gpg_verify_async(const char *const barejid, const char *const sign)
+{
+    if (!sign) {
+        return;
+    }
+
+    // a cached result is delivered behind verifies in flight for the contact,
+    // so an older signature can't replace it when it finishes
+    const char *cached = sig_cache_lookup(barejid, sign);
+    if (cached && !_p_gpg_verifying(barejid)) {
+        _p_gpg_verified(barejid, cached);
+        return;
+    }
+    if (cached) {
+        ProfPGPJob *job = _p_gpg_job_new(PGP_JOB_VERIFY, barejid, sign, NULL, NULL, NULL, NULL);
+        job->result = strdup(cached);
+        g_queue_push_tail(inflight, job);
+        _p_gpg_job_done(job);
+        return;
+    }
+
+    _p_gpg_submit(PGP_JOB_VERIFY, barejid, sign, NULL, NULL, NULL, NULL);
+}
+
+static gboolean
+_p_gpg_verifying(const char *const barejid)
+{
+    GList *curr = inflight ? inflight->head : NULL;
+    while (curr) {
+        ProfPGPJob *job = curr->data;
+        if (job->type == PGP_JOB_VERIFY && g_strcmp0(job->barejid, barejid) == 0) {
+            return TRUE;
+        }
+        curr = g_list_next(curr);
+    }
+
+    return FALSE;
+}
+
+void
+p_gpg_sign_async(const char *const str, const char *const fp, ProfPGPCallback callback, void *userdata,
+    GDestroyNotify free_userdata)
+{
+    _p_gpg_submit(PGP_JOB_SIGN, NULL, str, fp, callback, userdata, free_userdata);
+}
+
+int
+p_gpg_results_fd(void)
+{
+    return results_pipe[0];
+}
+
+void
+p_gpg_process_results(void)
+{
+    if (results_pipe[0] != -1) {
+        char buf[64];
+        while (read(results_pipe[0], buf, sizeof(buf)) > 0);
+    }
+
+    while (!g_queue_is_empty(inflight)) {
+        ProfPGPJob *job = g_queue_peek_head(inflight);
+        if (!g_atomic_int_get(&job->done)) {
+            break;
+        }
+        g_queue_pop_head(inflight);
+
+        // the session the job was for has gone, so have its keys and windows
+        if (job->generation != g_atomic_int_get(&generation)) {
+            _p_gpg_job_free(job);
+            continue;
+        }
+
+        GSList *curr = job->logs;
+        while (curr) {
+            ProfPGPJobLog *log = curr->data;
+            log_msg(log->level, "prof", log->msg);
+            curr = g_slist_next(curr);
+        }
+
+        // run jobs that need a passphrase prompt on the main thread
+        if (job->retry) {
+            if (job->type == PGP_JOB_DECRYPT) {
+                p_gpg_free_decrypted(job->result);
+            } else {
+                free(job->result);
+            }
+            switch (job->type) {
+            case PGP_JOB_DECRYPT:
+                job->result = p_gpg_decrypt(job->input);
+                break;
+            case PGP_JOB_VERIFY:
+                job->result = _p_gpg_ctx() ? _p_gpg_verify(NULL, _p_gpg_ctx(), job->barejid, job->input) : NULL;
+                break;
+            case PGP_JOB_SIGN:
+                job->result = p_gpg_sign(job->input, job->fp);
+                break;
+            default:
+                job->result = NULL;
+                break;
+            }
+        }
+
+        if (job->type == PGP_JOB_VERIFY) {
+            _p_gpg_verified(job->barejid, job->result);
+            sig_cache_add(job->barejid, job->input, job->result);
+        }
+        if (job->callback) {
+            job->callback(job->result, job->userdata);
+        }
+
+        _p_gpg_job_free(job);
+    }
 }
 
 void
@@ -783,6 +1067,257 @@ p_gpg_format_fp_str(char *fp)
     return result;
 }
 
+static gpgme_ctx_t
+_p_gpg_ctx(void)
+{
+    if (main_ctx == NULL) {
+        gpgme_error_t error = gpgme_new(&main_ctx);
+        if (error) {
+            log_error("GPG: Failed to create gpgme context. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+            main_ctx = NULL;
+            return NULL;
+        }
+        gpgme_set_passphrase_cb(main_ctx, (gpgme_passphrase_cb_t)_p_gpg_passphrase_cb, NULL);
+    }
+
+    return main_ctx;
+}
+
+// returns a new reference, resolving the key through ctx on a cache miss
+static gpgme_key_t
+_p_gpg_get_key(gpgme_ctx_t ctx, const char *const id, int secret, gpgme_error_t *error)
+{
+    *error = 0;
+    char *cache_key = g_strdup_printf("%c%s", secret ? 's' : 'p', id);
+
+    pthread_mutex_lock(&key_mutex);
+    gpgme_key_t key = g_hash_table_lookup(key_cache, cache_key);
+    if (key) {
+        gpgme_key_ref(key);
+    }
+    pthread_mutex_unlock(&key_mutex);
+
+    if (key) {
+        g_free(cache_key);
+        return key;
+    }
+
+    *error = gpgme_get_key(ctx, id, &key, secret);
+    if (*error || key == NULL) {
+        g_free(cache_key);
+        return NULL;
+    }
+
+    gpgme_key_ref(key);
+    pthread_mutex_lock(&key_mutex);
+    g_hash_table_replace(key_cache, strdup(cache_key), key);
+    pthread_mutex_unlock(&key_mutex);
+    g_free(cache_key);
+
+    return key;
+}
+
+static void
+_p_gpg_clear_keys(void)
+{
+    pthread_mutex_lock(&key_mutex);
+    g_hash_table_remove_all(key_cache);
+    pthread_mutex_unlock(&key_mutex);
+}
+
+// workers must not use the log directly, their messages are written when
+// the job is delivered on the main thread
+static void
+_p_gpg_log(ProfPGPJob *job, log_level_t level, const char *const msg, ...)
+{
+    va_list arg;
+    va_start(arg, msg);
+    GString *fmt_msg = g_string_new(NULL);
+    g_string_vprintf(fmt_msg, msg, arg);
+    va_end(arg);
+
+    if (job == NULL) {
+        log_msg(level, "prof", fmt_msg->str);
+        g_string_free(fmt_msg, TRUE);
+        return;
+    }
+
+    ProfPGPJobLog *log = malloc(sizeof(ProfPGPJobLog));
+    log->level = level;
+    log->msg = fmt_msg->str;
+    g_string_free(fmt_msg, FALSE);
+    job->logs = g_slist_append(job->logs, log);
+}
+
+static char*
+_p_gpg_sign(ProfPGPJob *job, gpgme_ctx_t ctx, const char *const str, const char *const fp)
+{
+    gpgme_error_t error;
+    gpgme_key_t key = _p_gpg_get_key(ctx, fp, 1, &error);
+
+    if (key == NULL) {
+        _p_gpg_log(job, PROF_LEVEL_ERROR, "GPG: Failed to get key. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+        return NULL;
+    }
+
+    gpgme_signers_clear(ctx);
+    error = gpgme_signers_add(ctx, key);
+    gpgme_key_unref(key);
+
+    if (error) {
+        _p_gpg_log(job, PROF_LEVEL_ERROR, "GPG: Failed to load signer. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+        return NULL;
+    }
+
+    char *str_or_empty = NULL;
+    if (str) {
+        str_or_empty = strdup(str);
+    } else {
+        str_or_empty = strdup("");
+    }
+    gpgme_data_t str_data;
+    gpgme_data_new_from_mem(&str_data, str_or_empty, strlen(str_or_empty), 1);
+    free(str_or_empty);
+
+    gpgme_data_t signed_data;
+    gpgme_data_new(&signed_data);
+
+    gpgme_set_armor(ctx,1);
+    error = gpgme_op_sign(ctx, str_data, signed_data, GPGME_SIG_MODE_DETACH);
+    gpgme_data_release(str_data);
+    gpgme_signers_clear(ctx);
+
+    if (error) {
+        _p_gpg_log(job, PROF_LEVEL_ERROR, "GPG: Failed to sign string. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+        gpgme_data_release(signed_data);
+        return NULL;
+    }
+
+    char *result = NULL;
+
+    size_t len = 0;
+    char *signed_str = gpgme_data_release_and_get_mem(signed_data, &len);
+    if (signed_str) {
+        GString *signed_gstr = g_string_new("");
+        g_string_append_len(signed_gstr, signed_str, len);
+        result = _remove_header_footer(signed_gstr->str, PGP_SIGNATURE_FOOTER);
+        g_string_free(signed_gstr, TRUE);
+        gpgme_free(signed_str);
+    }
+
+    return result;
+}
+
+// returns the key id of the signer, or NULL when it is not known
+static char*
+_p_gpg_verify(ProfPGPJob *job, gpgme_ctx_t ctx, const char *const barejid, const char *const sign)
+{
+    char *sign_with_header_footer = _add_header_footer(sign, PGP_SIGNATURE_HEADER, PGP_SIGNATURE_FOOTER);
+    gpgme_data_t sign_data;
+    gpgme_data_new_from_mem(&sign_data, sign_with_header_footer, strlen(sign_with_header_footer), 1);
+    free(sign_with_header_footer);
+
+    gpgme_data_t plain_data;
+    gpgme_data_new(&plain_data);
+
+    gpgme_error_t error = gpgme_op_verify(ctx, sign_data, NULL, plain_data);
+    gpgme_data_release(sign_data);
+    gpgme_data_release(plain_data);
+
+    if (error) {
+        _p_gpg_log(job, PROF_LEVEL_ERROR, "GPG: Failed to verify. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+        return NULL;
+    }
+
+    char *keyid = NULL;
+    gpgme_verify_result_t result = gpgme_op_verify_result(ctx);
+    if (result) {
+        if (result->signatures) {
+            gpgme_key_t key = _p_gpg_get_key(ctx, result->signatures->fpr, 0, &error);
+            if (key == NULL) {
+                _p_gpg_log(job, PROF_LEVEL_DEBUG, "Could not find PGP key with ID %s for %s", result->signatures->fpr, barejid);
+            } else {
+                _p_gpg_log(job, PROF_LEVEL_DEBUG, "Fingerprint found for %s: %s ", barejid, key->subkeys->fpr);
+                keyid = strdup(key->subkeys->keyid);
+                gpgme_key_unref(key);
+            }
+        }
+    }
+
+    return keyid;
+}
+
+static void
+_p_gpg_verified(const char *const barejid, const char *const keyid)
+{
+    if (keyid == NULL || pubkeys == NULL) {
+        return;
+    }
+
+    ProfPGPPubKeyId *pubkeyid = malloc(sizeof(ProfPGPPubKeyId));
+    pubkeyid->id = strdup(keyid);
+    pubkeyid->received = TRUE;
+    g_hash_table_replace(pubkeys, strdup(barejid), pubkeyid);
+}
+
+static char*
+_p_gpg_decrypt(ProfPGPJob *job, gpgme_ctx_t ctx, const char *const cipher)
+{
+    char *cipher_with_headers = _add_header_footer(cipher, PGP_MESSAGE_HEADER, PGP_MESSAGE_FOOTER);
+    gpgme_data_t cipher_data;
+    gpgme_data_new_from_mem(&cipher_data, cipher_with_headers, strlen(cipher_with_headers), 1);
+    free(cipher_with_headers);
+
+    gpgme_data_t plain_data;
+    gpgme_data_new(&plain_data);
+
+    gpgme_error_t error = gpgme_op_decrypt(ctx, cipher_data, plain_data);
+    gpgme_data_release(cipher_data);
+
+    if (error) {
+        _p_gpg_log(job, PROF_LEVEL_ERROR, "GPG: Failed to encrypt message. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+        gpgme_data_release(plain_data);
+        return NULL;
+    }
+
+    gpgme_decrypt_result_t res = gpgme_op_decrypt_result(ctx);
+    if (res) {
+        GString *recipients_str = g_string_new("");
+        gpgme_recipient_t recipient = res->recipients;
+        while (recipient) {
+            gpgme_key_t key = _p_gpg_get_key(ctx, recipient->keyid, 1, &error);
+
+            if (key) {
+                const char *addr = gpgme_key_get_string_attr(key, GPGME_ATTR_EMAIL, NULL, 0);
+                if (addr) {
+                    g_string_append(recipients_str, addr);
+                }
+                gpgme_key_unref(key);
+            }
+
+            if (recipient->next) {
+                g_string_append(recipients_str, ", ");
+            }
+
+            recipient = recipient->next;
+        }
+
+        _p_gpg_log(job, PROF_LEVEL_DEBUG, "GPG: Decrypted message for recipients: %s", recipients_str->str);
+        g_string_free(recipients_str, TRUE);
+    }
+
+    size_t len = 0;
+    char *plain_str = gpgme_data_release_and_get_mem(plain_data, &len);
+    char *result = NULL;
+    if (plain_str) {
+        plain_str[len] = 0;
+        result = g_strdup(plain_str);
+    }
+    gpgme_free(plain_str);
+
+    return result;
+}
+
 static char*
 _remove_header_footer(char *str, const char *const footer)
 {
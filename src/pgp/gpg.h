@@ -51,6 +51,10 @@ typedef struct pgp_pubkeyid_t {
     gboolean received;
 } ProfPGPPubKeyId;
 
+// called on the main thread with the result of an async operation, which
+// is NULL on failure and freed after the call
+typedef void (*ProfPGPCallback)(const char *const result, void *userdata);
+
 void p_gpg_init(void);
 void p_gpg_close(void);
 void p_gpg_on_connect(const char *const barejid);
@@ -66,6 +70,12 @@ char* p_gpg_sign(const char *const str, const char *const fp);
 void p_gpg_verify(const char *const barejid, const char *const sign);
 char* p_gpg_encrypt(const char *const barejid, const char *const message, const char *const fp);
 char* p_gpg_decrypt(const char *const cipher);
+void p_gpg_decrypt_async(const char *const cipher, ProfPGPCallback callback, void *userdata, GDestroyNotify free_userdata);
+void p_gpg_verify_async(const char *const barejid, const char *const sign);
+void p_gpg_sign_async(const char *const str, const char *const fp, ProfPGPCallback callback, void *userdata,
+    GDestroyNotify free_userdata);
+int p_gpg_results_fd(void);
+void p_gpg_process_results(void);
 void p_gpg_free_decrypted(char *decrypted);
 char* p_gpg_autocomplete_key(const char *const search_str);
 void p_gpg_autocomplete_key_reset(void);
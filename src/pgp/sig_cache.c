@@ -0,0 +1,236 @@
+/*
+ * sig_cache.c
+ *
+ * Copyright (C) 2012 - 2017 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "log.h"
+#include "pgp/sig_cache.h"
+
+// a verified presence signature and the key id that signed it
+typedef struct sig_cache_entry_t {
+    char *key;
+    char *barejid;
+    char *digest;
+    char *keyid;
+    GList *link;
+} SigCacheEntry;
+
+static gchar *sigcacheloc;
+static GHashTable *sig_cache;
+// most recently used first
+static GQueue *sig_cache_order;
+
+void
+sig_cache_init(void)
+{
+    sig_cache = g_hash_table_new(g_str_hash, g_str_equal);
+    sig_cache_order = g_queue_new();
+    sigcacheloc = NULL;
+}
+
+void
+sig_cache_close(void)
+{
+    sig_cache_save();
+    sig_cache_clear();
+    g_hash_table_destroy(sig_cache);
+    sig_cache = NULL;
+    g_queue_free(sig_cache_order);
+    sig_cache_order = NULL;
+}
+
+static char*
+_sig_cache_key(const char *const barejid, const char *const digest)
+{
+    return g_strdup_printf("%s\n%s", barejid, digest);
+}
+
+const char*
+sig_cache_lookup(const char *const barejid, const char *const sign)
+{
+    if (sig_cache == NULL || barejid == NULL || sign == NULL) {
+        return NULL;
+    }
+
+    gchar *digest = g_compute_checksum_for_string(G_CHECKSUM_SHA256, sign, -1);
+    char *key = _sig_cache_key(barejid, digest);
+    SigCacheEntry *entry = g_hash_table_lookup(sig_cache, key);
+    g_free(key);
+    g_free(digest);
+
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    g_queue_unlink(sig_cache_order, entry->link);
+    g_queue_push_head_link(sig_cache_order, entry->link);
+
+    return entry->keyid;
+}
+
+static void
+_sig_cache_entry_free(SigCacheEntry *entry)
+{
+    g_hash_table_remove(sig_cache, entry->key);
+    g_queue_delete_link(sig_cache_order, entry->link);
+    g_free(entry->key);
+    free(entry->barejid);
+    g_free(entry->digest);
+    free(entry->keyid);
+    free(entry);
+}
+
+static void
+_sig_cache_insert(const char *const barejid, gchar *digest, const char *const keyid)
+{
+    char *key = _sig_cache_key(barejid, digest);
+    SigCacheEntry *existing = g_hash_table_lookup(sig_cache, key);
+    if (existing) {
+        _sig_cache_entry_free(existing);
+    }
+
+    if (g_queue_get_length(sig_cache_order) >= SIG_CACHE_MAX) {
+        _sig_cache_entry_free(g_queue_peek_tail(sig_cache_order));
+    }
+
+    SigCacheEntry *entry = malloc(sizeof(SigCacheEntry));
+    entry->key = key;
+    entry->barejid = strdup(barejid);
+    entry->digest = digest;
+    entry->keyid = strdup(keyid);
+    g_queue_push_head(sig_cache_order, entry);
+    entry->link = g_queue_peek_head_link(sig_cache_order);
+    g_hash_table_insert(sig_cache, entry->key, entry);
+}
+
+// only successful verifications are cached, an unknown key may be imported later,
+// nothing is cached between sessions so a late result from a closed one is dropped
+void
+sig_cache_add(const char *const barejid, const char *const sign, const char *const keyid)
+{
+    if (sig_cache == NULL || sigcacheloc == NULL || barejid == NULL || sign == NULL || keyid == NULL) {
+        return;
+    }
+
+    _sig_cache_insert(barejid, g_compute_checksum_for_string(G_CHECKSUM_SHA256, sign, -1), keyid);
+}
+
+int
+sig_cache_size(void)
+{
+    if (sig_cache_order == NULL) {
+        return 0;
+    }
+
+    return g_queue_get_length(sig_cache_order);
+}
+
+void
+sig_cache_clear(void)
+{
+    while (!g_queue_is_empty(sig_cache_order)) {
+        _sig_cache_entry_free(g_queue_peek_head(sig_cache_order));
+    }
+
+    g_free(sigcacheloc);
+    sigcacheloc = NULL;
+}
+
+// the file has a group per contact mapping signature digests to key ids,
+// groups are written in least recently used order so eviction survives a
+// restart roughly in order
+void
+sig_cache_load(const char *const filename)
+{
+    sig_cache_clear();
+    sigcacheloc = g_strdup(filename);
+
+    if (!g_file_test(sigcacheloc, G_FILE_TEST_EXISTS)) {
+        return;
+    }
+
+    GKeyFile *sigcachefile = g_key_file_new();
+    g_key_file_load_from_file(sigcachefile, sigcacheloc, G_KEY_FILE_NONE, NULL);
+
+    gsize jids_len = 0;
+    gchar **jids = g_key_file_get_groups(sigcachefile, &jids_len);
+    gsize i;
+    for (i = 0; i < jids_len; i++) {
+        gsize digests_len = 0;
+        gchar **digests = g_key_file_get_keys(sigcachefile, jids[i], &digests_len, NULL);
+        gsize j;
+        for (j = 0; j < digests_len; j++) {
+            gchar *keyid = g_key_file_get_string(sigcachefile, jids[i], digests[j], NULL);
+            if (keyid) {
+                _sig_cache_insert(jids[i], g_strdup(digests[j]), keyid);
+                g_free(keyid);
+            }
+        }
+        g_strfreev(digests);
+    }
+    g_strfreev(jids);
+    g_key_file_free(sigcachefile);
+
+    log_debug("GPG: Loaded %d cached signature verifications", g_queue_get_length(sig_cache_order));
+}
+
+void
+sig_cache_save(void)
+{
+    if (sigcacheloc == NULL) {
+        return;
+    }
+
+    GKeyFile *sigcachefile = g_key_file_new();
+    GList *curr = g_queue_peek_tail_link(sig_cache_order);
+    while (curr) {
+        SigCacheEntry *entry = curr->data;
+        g_key_file_set_string(sigcachefile, entry->barejid, entry->digest, entry->keyid);
+        curr = g_list_previous(curr);
+    }
+
+    gsize g_data_size;
+    gchar *g_sigcache_data = g_key_file_to_data(sigcachefile, &g_data_size, NULL);
+    g_file_set_contents(sigcacheloc, g_sigcache_data, g_data_size, NULL);
+    g_chmod(sigcacheloc, S_IRUSR | S_IWUSR);
+    g_free(g_sigcache_data);
+    g_key_file_free(sigcachefile);
+}
@@ -155,7 +155,8 @@ api_register_timed(const char *const plugin_name, void *callback, int interval_s
     timed_function->callback_exec = callback_exec;
     timed_function->callback_destroy = callback_destroy;
     timed_function->interval_seconds = interval_seconds;
-    timed_function->timer = g_timer_new();
+    timed_function->due = 0;
+    timed_function->heap_index = -1;
 
     callbacks_add_timed(plugin_name, timed_function);
 }
@@ -48,6 +48,16 @@ static GHashTable *p_commands = NULL;
 static GHashTable *p_timed_functions = NULL;
 static GHashTable *p_window_callbacks = NULL;
 
+// timed functions ordered by their next run in a binary min heap
+static GPtrArray *timed_heap = NULL;
+static GTimer *timed_clock = NULL;
+
+// the timed function currently executing, cleared if it is freed while running
+static PluginTimedFunction *timed_running = NULL;
+
+static void _timed_heap_push(PluginTimedFunction *timed_function);
+static void _timed_heap_remove(PluginTimedFunction *timed_function);
+
 static void
 _free_window_callback(PluginWindowCallback *window_callback)
 {
@@ -119,7 +129,10 @@ _free_timed_function(PluginTimedFunction *timed_function)
         timed_function->callback_destroy(timed_function->callback);
     }
 
-    g_timer_destroy(timed_function->timer);
+    _timed_heap_remove(timed_function);
+    if (timed_running == timed_function) {
+        timed_running = NULL;
+    }
 
     free(timed_function);
 }
@@ -135,6 +148,8 @@ callbacks_init(void)
 {
     p_commands = g_hash_table_new_full(g_str_hash, g_str_equal, free, (GDestroyNotify)_free_command_hash);
     p_timed_functions = g_hash_table_new_full(g_str_hash, g_str_equal, free, (GDestroyNotify)_free_timed_function_list);
+    timed_heap = g_ptr_array_new();
+    timed_clock = g_timer_new();
     p_window_callbacks = g_hash_table_new_full(g_str_hash, g_str_equal, free, (GDestroyNotify)_free_window_callbacks);
 }
 
@@ -177,6 +192,10 @@ callbacks_close(void)
     g_hash_table_destroy(p_commands);
     g_hash_table_destroy(p_timed_functions);
     g_hash_table_destroy(p_window_callbacks);
+    g_ptr_array_free(timed_heap, TRUE);
+    timed_heap = NULL;
+    g_timer_destroy(timed_clock);
+    timed_clock = NULL;
 }
 
 void
@@ -197,6 +216,11 @@ callbacks_add_command(const char *const plugin_name, PluginCommand *command)
 void
 callbacks_add_timed(const char *const plugin_name, PluginTimedFunction *timed_function)
 {
+    if (timed_function->interval_seconds > 0) {
+        timed_function->due = g_timer_elapsed(timed_clock, NULL) + timed_function->interval_seconds;
+        _timed_heap_push(timed_function);
+    }
+
     GList *timed_function_list = g_hash_table_lookup(p_timed_functions, plugin_name);
     if (timed_function_list) {
         timed_function_list = g_list_append(timed_function_list, timed_function);
@@ -327,28 +351,40 @@ plugins_get_help(const char *const cmd)
 void
 plugins_run_timed(void)
 {
-    GList *timed_functions_lists = g_hash_table_get_values(p_timed_functions);
+    while (timed_heap->len > 0) {
+        PluginTimedFunction *timed_function = g_ptr_array_index(timed_heap, 0);
+        if (timed_function->due > g_timer_elapsed(timed_clock, NULL)) {
+            break;
+        }
 
-    GList *curr_list = timed_functions_lists;
-    while (curr_list) {
-        GList *timed_function_list = curr_list->data;
-        GList *curr = timed_function_list;
-        while (curr) {
-            PluginTimedFunction *timed_function = curr->data;
+        _timed_heap_remove(timed_function);
+        timed_running = timed_function;
+        timed_function->callback_exec(timed_function);
 
-            gdouble elapsed = g_timer_elapsed(timed_function->timer, NULL);
+        // reschedule unless the plugin was unloaded by its own callback
+        if (timed_running) {
+            timed_function->due = g_timer_elapsed(timed_clock, NULL) + timed_function->interval_seconds;
+            _timed_heap_push(timed_function);
+        }
+        timed_running = NULL;
+    }
+}
 
-            if (timed_function->interval_seconds > 0 && elapsed >= timed_function->interval_seconds) {
-                timed_function->callback_exec(timed_function);
-                g_timer_start(timed_function->timer);
-            }
+// milliseconds until the next plugin timed function is due, -1 when none
+gint
+plugins_timed_timeout(void)
+{
+    if (timed_heap == NULL || timed_heap->len == 0) {
+        return -1;
+    }
 
-            curr = g_list_next(curr);
-        }
-        curr_list = g_list_next(curr_list);
+    PluginTimedFunction *timed_function = g_ptr_array_index(timed_heap, 0);
+    gdouble remaining = timed_function->due - g_timer_elapsed(timed_clock, NULL);
+    if (remaining <= 0) {
+        return 0;
     }
 
-    g_list_free(timed_functions_lists);
+    return remaining * 1000 + 1;
 }
 
 GList*
@@ -375,3 +411,79 @@ plugins_get_command_names(void)
 
     return result;
 }
+
+static void
+_timed_heap_set(int index, PluginTimedFunction *timed_function)
+{
+    g_ptr_array_index(timed_heap, index) = timed_function;
+    timed_function->heap_index = index;
+}
+
+static void
+_timed_heap_sift_up(int index)
+{
+    PluginTimedFunction *timed_function = g_ptr_array_index(timed_heap, index);
+    while (index > 0) {
+        int parent_index = (index - 1) / 2;
+        PluginTimedFunction *parent = g_ptr_array_index(timed_heap, parent_index);
+        if (parent->due <= timed_function->due) {
+            break;
+        }
+        _timed_heap_set(index, parent);
+        index = parent_index;
+    }
+    _timed_heap_set(index, timed_function);
+}
+
+static void
+_timed_heap_sift_down(int index)
+{
+    int len = timed_heap->len;
+    PluginTimedFunction *timed_function = g_ptr_array_index(timed_heap, index);
+    while (TRUE) {
+        int child_index = index * 2 + 1;
+        if (child_index >= len) {
+            break;
+        }
+        PluginTimedFunction *child = g_ptr_array_index(timed_heap, child_index);
+        if (child_index + 1 < len) {
+            PluginTimedFunction *right = g_ptr_array_index(timed_heap, child_index + 1);
+            if (right->due < child->due) {
+                child_index++;
+                child = right;
+            }
+        }
+        if (timed_function->due <= child->due) {
+            break;
+        }
+        _timed_heap_set(index, child);
+        index = child_index;
+    }
+    _timed_heap_set(index, timed_function);
+}
+
+static void
+_timed_heap_push(PluginTimedFunction *timed_function)
+{
+    g_ptr_array_add(timed_heap, timed_function);
+    _timed_heap_sift_up(timed_heap->len - 1);
+}
+
+static void
+_timed_heap_remove(PluginTimedFunction *timed_function)
+{
+    int index = timed_function->heap_index;
+    if (timed_heap == NULL || index < 0) {
+        return;
+    }
+    timed_function->heap_index = -1;
+
+    PluginTimedFunction *last = g_ptr_array_remove_index(timed_heap, timed_heap->len - 1);
+    if (last == timed_function) {
+        return;
+    }
+
+    _timed_heap_set(index, last);
+    _timed_heap_sift_up(index);
+    _timed_heap_sift_down(last->heap_index);
+}
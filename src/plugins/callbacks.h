@@ -54,7 +54,11 @@ typedef struct p_timed_function {
     void (*callback_exec)(struct p_timed_function *timed_function);
     void (*callback_destroy)(void *callback);
     int interval_seconds;
-    GTimer *timer;
+
+    // next run in seconds on the callbacks clock, and position in the
+    // schedule, -1 when not scheduled
+    gdouble due;
+    int heap_index;
 } PluginTimedFunction;
 
 typedef struct p_window_input_callback {
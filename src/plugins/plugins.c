@@ -63,10 +63,25 @@
 
 static GHashTable *plugins;
 
+static PluginHookStats hook_stats[PLUGIN_HOOK_COUNT] = {
+    { "prof_on_message_stanza_send", 0, 0, 0 },
+    { "prof_on_message_stanza_receive", 0, 0, 0 },
+    { "prof_on_presence_stanza_send", 0, 0, 0 },
+    { "prof_on_presence_stanza_receive", 0, 0, 0 },
+    { "prof_on_iq_stanza_send", 0, 0, 0 },
+    { "prof_on_iq_stanza_receive", 0, 0, 0 },
+};
+static GTimer *hook_timer;
+
+static void _plugins_update_hooks(void);
+static void _plugins_hook_start(void);
+static void _plugins_hook_end(plugin_hook_t hook);
+
 void
 plugins_init(void)
 {
     plugins = g_hash_table_new_full(g_str_hash, g_str_equal, free, NULL);
+    hook_timer = g_timer_new();
     callbacks_init();
     autocompleters_init();
     plugin_themes_init();
@@ -91,7 +106,7 @@ plugins_init(void)
             if (g_str_has_suffix(filename, ".py")) {
                 ProfPlugin *plugin = python_plugin_create(filename);
                 if (plugin) {
-                    g_hash_table_insert(plugins, strdup(filename), plugin);
+                    plugins_add(filename, plugin);
                     loaded = TRUE;
                 }
             }
@@ -100,7 +115,7 @@ plugins_init(void)
             if (g_str_has_suffix(filename, ".so")) {
                 ProfPlugin *plugin = c_plugin_create(filename);
                 if (plugin) {
-                    g_hash_table_insert(plugins, strdup(filename), plugin);
+                    plugins_add(filename, plugin);
                     loaded = TRUE;
                 }
             }
@@ -129,6 +144,13 @@ plugins_init(void)
     return;
 }
 
+void
+plugins_add(const char *const name, ProfPlugin *plugin)
+{
+    g_hash_table_insert(plugins, strdup(name), plugin);
+    _plugins_update_hooks();
+}
+
 gboolean
 plugins_install(const char *const plugin_name, const char *const filename)
 {
@@ -173,7 +195,7 @@ plugins_load(const char *const name)
     }
 #endif
     if (plugin) {
-        g_hash_table_insert(plugins, strdup(name), plugin);
+        plugins_add(name, plugin);
         if (connection_get_status() == JABBER_CONNECTED) {
             const char *account_name = session_get_account_name();
             const char *fulljid = connection_get_fulljid();
@@ -208,6 +230,7 @@ plugins_unload(const char *const name)
 #endif
         prefs_remove_plugin(name);
         g_hash_table_remove(plugins, name);
+        _plugins_update_hooks();
 
         caps_reset_ver();
         // resend presence to update server's disco info data for this client
@@ -640,12 +663,26 @@ plugins_post_priv_message_send(const char * const fulljid, const char * const me
     jid_destroy(jidp);
 }
 
+gboolean
+plugins_has_hook(plugin_hook_t hook)
+{
+    return hook_stats[hook].subscribers > 0;
+}
+
+const PluginHookStats*
+plugins_get_hook_stats(plugin_hook_t hook)
+{
+    return &hook_stats[hook];
+}
+
 char*
 plugins_on_message_stanza_send(const char *const text)
 {
     char *new_stanza = NULL;
     char *curr_stanza = strdup(text);
 
+    _plugins_hook_start();
+
     GList *values = g_hash_table_get_values(plugins);
     GList *curr = values;
     while (curr) {
@@ -659,6 +696,7 @@ plugins_on_message_stanza_send(const char *const text)
         curr = g_list_next(curr);
     }
     g_list_free(values);
+    _plugins_hook_end(PLUGIN_HOOK_MESSAGE_STANZA_SEND);
 
     return curr_stanza;
 }
@@ -668,6 +706,8 @@ plugins_on_message_stanza_receive(const char *const text)
 {
     gboolean cont = TRUE;
 
+    _plugins_hook_start();
+
     GList *values = g_hash_table_get_values(plugins);
     GList *curr = values;
     while (curr) {
@@ -679,6 +719,7 @@ plugins_on_message_stanza_receive(const char *const text)
         curr = g_list_next(curr);
     }
     g_list_free(values);
+    _plugins_hook_end(PLUGIN_HOOK_MESSAGE_STANZA_RECEIVE);
 
     return cont;
 }
@@ -689,6 +730,8 @@ plugins_on_presence_stanza_send(const char *const text)
     char *new_stanza = NULL;
     char *curr_stanza = strdup(text);
 
+    _plugins_hook_start();
+
     GList *values = g_hash_table_get_values(plugins);
     GList *curr = values;
     while (curr) {
@@ -702,6 +745,7 @@ plugins_on_presence_stanza_send(const char *const text)
         curr = g_list_next(curr);
     }
     g_list_free(values);
+    _plugins_hook_end(PLUGIN_HOOK_PRESENCE_STANZA_SEND);
 
     return curr_stanza;
 }
@@ -711,6 +755,8 @@ plugins_on_presence_stanza_receive(const char *const text)
 {
     gboolean cont = TRUE;
 
+    _plugins_hook_start();
+
     GList *values = g_hash_table_get_values(plugins);
     GList *curr = values;
     while (curr) {
@@ -722,6 +768,7 @@ plugins_on_presence_stanza_receive(const char *const text)
         curr = g_list_next(curr);
     }
     g_list_free(values);
+    _plugins_hook_end(PLUGIN_HOOK_PRESENCE_STANZA_RECEIVE);
 
     return cont;
 }
@@ -732,6 +779,8 @@ plugins_on_iq_stanza_send(const char *const text)
     char *new_stanza = NULL;
     char *curr_stanza = strdup(text);
 
+    _plugins_hook_start();
+
     GList *values = g_hash_table_get_values(plugins);
     GList *curr = values;
     while (curr) {
@@ -745,6 +794,7 @@ plugins_on_iq_stanza_send(const char *const text)
         curr = g_list_next(curr);
     }
     g_list_free(values);
+    _plugins_hook_end(PLUGIN_HOOK_IQ_STANZA_SEND);
 
     return curr_stanza;
 }
@@ -754,6 +804,8 @@ plugins_on_iq_stanza_receive(const char *const text)
 {
     gboolean cont = TRUE;
 
+    _plugins_hook_start();
+
     GList *values = g_hash_table_get_values(plugins);
     GList *curr = values;
     while (curr) {
@@ -765,6 +817,7 @@ plugins_on_iq_stanza_receive(const char *const text)
         curr = g_list_next(curr);
     }
     g_list_free(values);
+    _plugins_hook_end(PLUGIN_HOOK_IQ_STANZA_RECEIVE);
 
     return cont;
 }
@@ -862,4 +915,48 @@ plugins_shutdown(void)
     disco_close();
     g_hash_table_destroy(plugins);
     plugins = NULL;
+    _plugins_update_hooks();
+    g_timer_destroy(hook_timer);
+    hook_timer = NULL;
+}
+
+// count the loaded plugins implementing each hook, so callers can skip
+// building hook arguments nobody will read
+static void
+_plugins_update_hooks(void)
+{
+    int i;
+    for (i = 0; i < PLUGIN_HOOK_COUNT; i++) {
+        hook_stats[i].subscribers = 0;
+    }
+
+    if (!plugins) {
+        return;
+    }
+
+    GList *values = g_hash_table_get_values(plugins);
+    GList *curr = values;
+    while (curr) {
+        ProfPlugin *plugin = curr->data;
+        for (i = 0; i < PLUGIN_HOOK_COUNT; i++) {
+            if (plugin->contains_hook(plugin, hook_stats[i].name)) {
+                hook_stats[i].subscribers++;
+            }
+        }
+        curr = g_list_next(curr);
+    }
+    g_list_free(values);
+}
+
+static void
+_plugins_hook_start(void)
+{
+    g_timer_start(hook_timer);
+}
+
+static void
+_plugins_hook_end(plugin_hook_t hook)
+{
+    hook_stats[hook].calls++;
+    hook_stats[hook].elapsed += g_timer_elapsed(hook_timer, NULL);
 }
@@ -42,6 +42,26 @@ typedef enum {
     LANG_C
 } lang_t;
 
+// hooks that are only invoked when a loaded plugin implements them
+typedef enum {
+    PLUGIN_HOOK_MESSAGE_STANZA_SEND,
+    PLUGIN_HOOK_MESSAGE_STANZA_RECEIVE,
+    PLUGIN_HOOK_PRESENCE_STANZA_SEND,
+    PLUGIN_HOOK_PRESENCE_STANZA_RECEIVE,
+    PLUGIN_HOOK_IQ_STANZA_SEND,
+    PLUGIN_HOOK_IQ_STANZA_RECEIVE,
+    PLUGIN_HOOK_COUNT
+} plugin_hook_t;
+
+typedef struct plugin_hook_stats_t {
+    const char *name;
+    int subscribers;
+    guint calls;
+
+    // total seconds spent in plugins for this hook
+    gdouble elapsed;
+} PluginHookStats;
+
 typedef struct prof_plugin_t {
     char *name;
     lang_t lang;
@@ -107,6 +127,7 @@ char* plugins_autocomplete(const char *const input);
 void plugins_reset_autocomplete(void);
 void plugins_shutdown(void);
 
+void plugins_add(const char *const name, ProfPlugin *plugin);
 gboolean plugins_install(const char *const plugin_name, const char *const filename);
 gboolean plugins_load(const char *const name);
 gboolean plugins_unload(const char *const name);
@@ -139,6 +160,9 @@ void plugins_post_priv_message_send(const char *const fulljid, const char *const
 void plugins_win_process_line(char *win, const char *const line);
 void plugins_close_win(const char *const plugin_name, const char *const tag);
 
+gboolean plugins_has_hook(plugin_hook_t hook);
+const PluginHookStats* plugins_get_hook_stats(plugin_hook_t hook);
+
 char* plugins_on_message_stanza_send(const char *const text);
 gboolean plugins_on_message_stanza_receive(const char *const text);
 
@@ -157,6 +181,7 @@ void plugins_on_room_win_focus(const char *const barejid);
 
 gboolean plugins_run_command(const char * const cmd);
 void plugins_run_timed(void);
+gint plugins_timed_timeout(void);
 GList* plugins_get_command_names(void);
 gchar * plugins_get_dir(void);
 CommandHelp* plugins_get_help(const char *const cmd);
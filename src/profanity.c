@@ -63,6 +63,7 @@
 #include "event/client_events.h"
 #include "ui/ui.h"
 #include "ui/window_list.h"
+#include "ui/statusbar.h"
 #include "xmpp/resource.h"
 #include "xmpp/session.h"
 #include "xmpp/xmpp.h"
@@ -83,6 +84,7 @@
 static void _init(char *log_level);
 static void _shutdown(void);
 static void _connect_default(const char * const account);
+static gint _next_timeout(void);
 
 static gboolean cont = TRUE;
 static gboolean force_quit = FALSE;
@@ -105,7 +107,7 @@ prof_run(char *log_level, char *account_name)
         log_stderr_handler();
         session_check_autoaway();
 
-        line = inp_readline();
+        line = inp_readline(_next_timeout());
         if (line) {
             ProfWin *window = wins_get_current();
             cont = cmd_process_input(window, line);
@@ -117,6 +119,9 @@ prof_run(char *log_level, char *account_name)
 
 #ifdef HAVE_LIBOTR
         otr_poll();
+#endif
+#ifdef HAVE_LIBGPGME
+        p_gpg_process_results();
 #endif
         plugins_run_timed();
         notify_remind();
@@ -129,6 +134,46 @@ prof_run(char *log_level, char *account_name)
     }
 }
 
+static gint
+_min_timeout(gint a, gint b)
+{
+    if (a == -1) {
+        return b;
+    }
+    if (b == -1) {
+        return a;
+    }
+
+    return a < b ? a : b;
+}
+
+// how long the main loop may wait for input before other work is due,
+// -1 to wait until input, a terminal resize or stderr output
+static gint
+_next_timeout(void)
+{
+    gint timeout = -1;
+
+    // libstrophe does not expose its socket for us to wait on, so an active
+    // connection is still polled at the input block interval
+    if (connection_get_status() != JABBER_DISCONNECTED) {
+        timeout = inp_get_timeout();
+    }
+#ifdef HAVE_GTK
+    if (prefs_get_boolean(PREF_TRAY)) {
+        timeout = _min_timeout(timeout, inp_get_timeout());
+    }
+#endif
+
+    timeout = _min_timeout(timeout, session_reconnect_timeout());
+    timeout = _min_timeout(timeout, notify_remind_timeout());
+    timeout = _min_timeout(timeout, plugins_timed_timeout());
+    timeout = _min_timeout(timeout, status_bar_clock_timeout());
+    timeout = _min_timeout(timeout, ui_frame_timeout());
+
+    return timeout;
+}
+
 void
 prof_set_quit(void)
 {
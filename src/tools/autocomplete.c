@@ -35,26 +35,84 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "common.h"
 #include "tools/autocomplete.h"
 #include "tools/parser.h"
 
+// items are kept in a sorted sequence, so all items sharing a prefix are
+// adjacent and can be found with a binary search
 struct autocomplete_t {
-    GSList *items;
-    GSList *last_found;
+    GSequence *items;
+    GSequenceIter *last_found;
     gchar *search_str;
+
+    // fuzzy matching index, item to AcEntry, built on first use
+    GHashTable *index;
+
+    // item to AcUsage, kept when the items are cleared and added again
+    GHashTable *usage;
+
+    // matches for the last fuzzy search string, the best first and the rest
+    // only ranked once the user cycles past it, kept after a reset as a search
+    // string extending the last one can only match some of these
+    GArray *fuzzy_matches;
+    gchar *fuzzy_query;
+    gboolean fuzzy_cycling;
+    guint fuzzy_pos;
+    gboolean fuzzy_ranked;
 };
 
-static gchar* _search_from(Autocomplete ac, GSList *curr, gboolean quote);
+typedef struct ac_usage_t {
+    guint uses;
+    time_t last_used;
+} AcUsage;
+
+// item is owned by the sequence, usage by the usage table, the folded
+// item is stored with the entry to keep scans cache friendly
+typedef struct ac_entry_t {
+    const char *item;
+    size_t len;
+    guint64 charmask;
+    AcUsage *usage;
+    char folded[];
+} AcEntry;
+
+typedef struct ac_match_t {
+    AcEntry *entry;
+    int score;
+} AcMatch;
+
+static gchar* _search_from(Autocomplete ac, GSequenceIter *curr, gboolean quote);
+static GSequenceIter* _lower_bound(Autocomplete ac, const char *const str);
+static gint _cmp_items(gconstpointer a, gconstpointer b, gpointer user_data);
+static gchar* _quote_item(const char *const item, gboolean quote);
+static void _index_build(Autocomplete ac);
+static void _index_add(Autocomplete ac, const char *const item);
+static AcEntry* _entry_new(Autocomplete ac, const char *const item);
+static void _entry_free(AcEntry *entry);
+static guint64 _charmask(const char *const str);
+static int _fuzzy_score(const char *const folded, const char *const query);
+static gint _cmp_matches(gconstpointer a, gconstpointer b);
+static guint _fuzzy_match(AcMatch *matches, guint found, AcEntry *entry, const char *const query,
+    guint64 query_mask, time_t now);
+static void _fuzzy_matches_free(Autocomplete ac);
 
 Autocomplete
 autocomplete_new(void)
 {
     Autocomplete new = malloc(sizeof(struct autocomplete_t));
-    new->items = NULL;
+    new->items = g_sequence_new(free);
     new->last_found = NULL;
     new->search_str = NULL;
+    new->index = NULL;
+    new->usage = NULL;
+    new->fuzzy_matches = NULL;
+    new->fuzzy_query = NULL;
+    new->fuzzy_cycling = FALSE;
+    new->fuzzy_pos = 0;
+    new->fuzzy_ranked = FALSE;
 
     return new;
 }
@@ -63,10 +121,14 @@ void
 autocomplete_clear(Autocomplete ac)
 {
     if (ac) {
-        g_slist_free_full(ac->items, free);
-        ac->items = NULL;
-
         autocomplete_reset(ac);
+        _fuzzy_matches_free(ac);
+
+        if (ac->index) {
+            g_hash_table_destroy(ac->index);
+            ac->index = NULL;
+        }
+        g_sequence_remove_range(g_sequence_get_begin_iter(ac->items), g_sequence_get_end_iter(ac->items));
     }
 }
 
@@ -75,6 +137,8 @@ autocomplete_reset(Autocomplete ac)
 {
     ac->last_found = NULL;
     FREE_SET_NULL(ac->search_str);
+    ac->fuzzy_cycling = FALSE;
+    ac->fuzzy_pos = 0;
 }
 
 void
@@ -82,6 +146,10 @@ autocomplete_free(Autocomplete ac)
 {
     if (ac) {
         autocomplete_clear(ac);
+        if (ac->usage) {
+            g_hash_table_destroy(ac->usage);
+        }
+        g_sequence_free(ac->items);
         free(ac);
     }
 }
@@ -91,10 +159,8 @@ autocomplete_length(Autocomplete ac)
 {
     if (!ac) {
         return 0;
-    } else if (!ac->items) {
-        return 0;
     } else {
-        return g_slist_length(ac->items);
+        return g_sequence_get_length(ac->items);
     }
 }
 
@@ -102,16 +168,18 @@ void
 autocomplete_add(Autocomplete ac, const char *item)
 {
     if (ac) {
-        char *item_cpy;
-        GSList *curr = g_slist_find_custom(ac->items, item, (GCompareFunc)strcmp);
+        GSequenceIter *curr = _lower_bound(ac, item);
 
         // if item already exists
-        if (curr) {
+        if (!g_sequence_iter_is_end(curr) && strcmp(g_sequence_get(curr), item) == 0) {
             return;
         }
 
-        item_cpy = strdup(item);
-        ac->items = g_slist_insert_sorted(ac->items, item_cpy, (GCompareFunc)strcmp);
+        GSequenceIter *added = g_sequence_insert_before(curr, strdup(item));
+        _fuzzy_matches_free(ac);
+        if (ac->index) {
+            _index_add(ac, g_sequence_get(added));
+        }
     }
 
     return;
@@ -130,9 +198,9 @@ void
 autocomplete_remove(Autocomplete ac, const char *const item)
 {
     if (ac) {
-        GSList *curr = g_slist_find_custom(ac->items, item, (GCompareFunc)strcmp);
+        GSequenceIter *curr = _lower_bound(ac, item);
 
-        if (!curr) {
+        if (g_sequence_iter_is_end(curr) || strcmp(g_sequence_get(curr), item) != 0) {
             return;
         }
 
@@ -141,8 +209,13 @@ autocomplete_remove(Autocomplete ac, const char *const item)
             ac->last_found = NULL;
         }
 
-        free(curr->data);
-        ac->items = g_slist_delete_link(ac->items, curr);
+        // fuzzy matches refer to the items, so start a new search
+        _fuzzy_matches_free(ac);
+        if (ac->index) {
+            g_hash_table_remove(ac->index, g_sequence_get(curr));
+        }
+
+        g_sequence_remove(curr);
     }
 
     return;
@@ -161,11 +234,11 @@ GSList*
 autocomplete_create_list(Autocomplete ac)
 {
     GSList *copy = NULL;
-    GSList *curr = ac->items;
+    GSequenceIter *curr = g_sequence_get_end_iter(ac->items);
 
-    while(curr) {
-        copy = g_slist_append(copy, strdup(curr->data));
-        curr = g_slist_next(curr);
+    while (!g_sequence_iter_is_begin(curr)) {
+        curr = g_sequence_iter_prev(curr);
+        copy = g_slist_prepend(copy, strdup(g_sequence_get(curr)));
     }
 
     return copy;
@@ -174,13 +247,10 @@ autocomplete_create_list(Autocomplete ac)
 gboolean
 autocomplete_contains(Autocomplete ac, const char *value)
 {
-    GSList *curr = ac->items;
+    GSequenceIter *curr = _lower_bound(ac, value);
 
-    while(curr) {
-        if (strcmp(curr->data, value) == 0) {
-            return TRUE;
-        }
-        curr = g_slist_next(curr);
+    if (!g_sequence_iter_is_end(curr) && strcmp(g_sequence_get(curr), value) == 0) {
+        return TRUE;
     }
 
     return FALSE;
@@ -197,7 +267,7 @@ autocomplete_complete(Autocomplete ac, const gchar *search_str, gboolean quote)
     }
 
     // no items to search
-    if (!ac->items) {
+    if (g_sequence_get_length(ac->items) == 0) {
         return NULL;
     }
 
@@ -208,20 +278,20 @@ autocomplete_complete(Autocomplete ac, const gchar *search_str, gboolean quote)
         }
 
         ac->search_str = strdup(search_str);
-        found = _search_from(ac, ac->items, quote);
+        found = _search_from(ac, _lower_bound(ac, ac->search_str), quote);
 
         return found;
 
     // subsequent search attempt
     } else {
-        // search from here+1 to end
-        found = _search_from(ac, g_slist_next(ac->last_found), quote);
+        // try the item after the last match
+        found = _search_from(ac, g_sequence_iter_next(ac->last_found), quote);
         if (found) {
             return found;
         }
 
-        // search from beginning
-        found = _search_from(ac, ac->items, quote);
+        // wrap around to the first match
+        found = _search_from(ac, _lower_bound(ac, ac->search_str), quote);
         if (found) {
             return found;
         }
@@ -233,6 +303,125 @@ autocomplete_complete(Autocomplete ac, const gchar *search_str, gboolean quote)
     }
 }
 
+gchar*
+autocomplete_complete_fuzzy(Autocomplete ac, const gchar *search_str, gboolean quote)
+{
+    // no autocomplete to search
+    if (!ac) {
+        return NULL;
+    }
+
+    // no items to search
+    if (g_sequence_get_length(ac->items) == 0) {
+        return NULL;
+    }
+
+    // subsequent search attempt, move to the next ranked match
+    if (ac->fuzzy_cycling) {
+        if (!ac->fuzzy_ranked) {
+            g_array_sort(ac->fuzzy_matches, _cmp_matches);
+            ac->fuzzy_ranked = TRUE;
+        }
+        ac->fuzzy_pos = (ac->fuzzy_pos + 1) % ac->fuzzy_matches->len;
+        AcMatch *match = &g_array_index(ac->fuzzy_matches, AcMatch, ac->fuzzy_pos);
+        return _quote_item(match->entry->item, quote);
+    }
+
+    // first search attempt
+    autocomplete_reset(ac);
+    ac->search_str = strdup(search_str);
+
+    if (!ac->index) {
+        _index_build(ac);
+    }
+
+    gchar *query = g_utf8_casefold(search_str, -1);
+    guint64 query_mask = _charmask(query);
+    time_t now = time(NULL);
+    GArray *matches = NULL;
+    guint found = 0;
+
+    // while the search string is only being extended, narrow the last matches
+    if (ac->fuzzy_matches && g_str_has_prefix(query, ac->fuzzy_query)) {
+        matches = ac->fuzzy_matches;
+        ac->fuzzy_matches = NULL;
+        AcMatch *last = (AcMatch*)matches->data;
+        guint i;
+        for (i = 0; i < matches->len; i++) {
+            found = _fuzzy_match(last, found, last[i].entry, query, query_mask, now);
+        }
+    } else {
+        guint size = g_hash_table_size(ac->index);
+        matches = g_array_sized_new(FALSE, FALSE, sizeof(AcMatch), size);
+        g_array_set_size(matches, size);
+        GHashTableIter iter;
+        gpointer value;
+        g_hash_table_iter_init(&iter, ac->index);
+        while (g_hash_table_iter_next(&iter, NULL, &value)) {
+            found = _fuzzy_match((AcMatch*)matches->data, found, value, query, query_mask, now);
+        }
+    }
+    g_array_set_size(matches, found);
+
+    _fuzzy_matches_free(ac);
+    ac->fuzzy_matches = matches;
+    ac->fuzzy_query = query;
+
+    if (matches->len == 0) {
+        autocomplete_reset(ac);
+        return NULL;
+    }
+
+    // offer the best match now, ranking the rest can wait for the next tab
+    guint best = 0;
+    guint i;
+    for (i = 1; i < matches->len; i++) {
+        if (_cmp_matches(&g_array_index(matches, AcMatch, i), &g_array_index(matches, AcMatch, best)) < 0) {
+            best = i;
+        }
+    }
+    AcMatch match = g_array_index(matches, AcMatch, best);
+    g_array_index(matches, AcMatch, best) = g_array_index(matches, AcMatch, 0);
+    g_array_index(matches, AcMatch, 0) = match;
+
+    ac->fuzzy_cycling = TRUE;
+
+    return _quote_item(match.entry->item, quote);
+}
+
+void
+autocomplete_mark_used(Autocomplete ac, const char *const item)
+{
+    if (!ac || !item) {
+        return;
+    }
+
+    // only record items that can be completed
+    GSequenceIter *curr = _lower_bound(ac, item);
+    if (g_sequence_iter_is_end(curr) || strcmp(g_sequence_get(curr), item) != 0) {
+        return;
+    }
+
+    if (!ac->usage) {
+        ac->usage = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    }
+
+    AcUsage *usage = g_hash_table_lookup(ac->usage, item);
+    if (!usage) {
+        usage = g_new0(AcUsage, 1);
+        g_hash_table_insert(ac->usage, g_strdup(item), usage);
+    }
+    usage->uses++;
+    usage->last_used = time(NULL);
+
+    if (ac->index) {
+        AcEntry *entry = g_hash_table_lookup(ac->index, item);
+        if (entry) {
+            entry->usage = usage;
+        }
+    }
+}
+
 char*
 autocomplete_param_with_func(const char *const input, char *command, autocomplete_func func)
 {
@@ -327,36 +516,229 @@ autocomplete_param_no_with_func(const char *const input, char *command, int arg_
     return NULL;
 }
 
+// matches are adjacent in the sequence, so only the item at curr needs checking
+static gchar*
+_search_from(Autocomplete ac, GSequenceIter *curr, gboolean quote)
+{
+    if (g_sequence_iter_is_end(curr)) {
+        return NULL;
+    }
+
+    char *item = g_sequence_get(curr);
+
+    // match found
+    if (strncmp(item, ac->search_str, strlen(ac->search_str)) == 0) {
+
+        // set pointer to last found
+        ac->last_found = curr;
+
+        return _quote_item(item, quote);
+    }
+
+    return NULL;
+}
+
 static gchar*
-_search_from(Autocomplete ac, GSList *curr, gboolean quote)
+_quote_item(const char *const item, gboolean quote)
+{
+    // if contains space, quote before returning
+    if (quote && g_strrstr(item, " ")) {
+        GString *quoted = g_string_new("\"");
+        g_string_append(quoted, item);
+        g_string_append(quoted, "\"");
+
+        gchar *result = quoted->str;
+        g_string_free(quoted, FALSE);
+
+        return result;
+
+    // otherwise just return the string
+    } else {
+        return strdup(item);
+    }
+}
+
+// first item not less than str
+static GSequenceIter*
+_lower_bound(Autocomplete ac, const char *const str)
+{
+    // g_sequence_search positions after an equal item
+    GSequenceIter *curr = g_sequence_search(ac->items, (gpointer)str, _cmp_items, NULL);
+    if (!g_sequence_iter_is_begin(curr)) {
+        GSequenceIter *prev = g_sequence_iter_prev(curr);
+        if (strcmp(g_sequence_get(prev), str) == 0) {
+            return prev;
+        }
+    }
+
+    return curr;
+}
+
+static gint
+_cmp_items(gconstpointer a, gconstpointer b, gpointer user_data)
 {
-    while(curr) {
+    return strcmp(a, b);
+}
 
-        // match found
-        if (strncmp(curr->data, ac->search_str, strlen(ac->search_str)) == 0) {
+// keys are the item strings owned by the sequence
+static void
+_index_build(Autocomplete ac)
+{
+    ac->index = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, (GDestroyNotify)_entry_free);
 
-            // set pointer to last found
-            ac->last_found = curr;
+    GSequenceIter *curr = g_sequence_get_begin_iter(ac->items);
+    while (!g_sequence_iter_is_end(curr)) {
+        _index_add(ac, g_sequence_get(curr));
+        curr = g_sequence_iter_next(curr);
+    }
+}
+
+static void
+_index_add(Autocomplete ac, const char *const item)
+{
+    g_hash_table_insert(ac->index, (gpointer)item, _entry_new(ac, item));
+}
 
-            // if contains space, quote before returning
-            if (quote && g_strrstr(curr->data, " ")) {
-                GString *quoted = g_string_new("\"");
-                g_string_append(quoted, curr->data);
-                g_string_append(quoted, "\"");
+static AcEntry*
+_entry_new(Autocomplete ac, const char *const item)
+{
+    gchar *folded = g_utf8_casefold(item, -1);
+    AcEntry *entry = malloc(sizeof(AcEntry) + strlen(folded) + 1);
+    strcpy(entry->folded, folded);
+    g_free(folded);
+    entry->item = item;
+    entry->len = strlen(item);
+    entry->charmask = _charmask(entry->folded);
+    entry->usage = ac->usage ? g_hash_table_lookup(ac->usage, item) : NULL;
+
+    return entry;
+}
+
+static void
+_entry_free(AcEntry *entry)
+{
+    free(entry);
+}
+
+// one bit per byte value modulo 64, an item can only match a search string
+// whose bits are all present in the item's mask
+static guint64
+_charmask(const char *const str)
+{
+    guint64 mask = 0;
+    const char *curr = str;
+    while (*curr) {
+        mask |= G_GUINT64_CONSTANT(1) << ((guchar)*curr % 64);
+        curr++;
+    }
 
-                gchar *result = quoted->str;
-                g_string_free(quoted, FALSE);
+    return mask;
+}
 
-                return result;
+// rank prefix matches first, then substrings starting a word, then other
+// substrings, then subsequences with the fewest gaps, -1 when no match
+static int
+_fuzzy_score(const char *const folded, const char *const query)
+{
+    size_t query_len = strlen(query);
+    if (query_len == 0) {
+        return 0;
+    }
 
-            // otherwise just return the string
-            } else {
-                return strdup(curr->data);
+    // every match is a subsequence, so most items are ruled out in one pass
+    const char *start = NULL;
+    const char *curr = folded;
+    const char *q = query;
+    while (*curr && *q) {
+        if (*curr == *q) {
+            if (!start) {
+                start = curr;
             }
+            q++;
         }
+        curr++;
+    }
+    if (*q) {
+        return -1;
+    }
 
-        curr = g_slist_next(curr);
+    // no gaps means the first occurrence is at start, otherwise it is later
+    int gaps = (curr - start) - query_len;
+    const char *found = gaps == 0 ? start : strstr(start + 1, query);
+    if (found == folded) {
+        return 3000;
+    }
+    if (found) {
+        char prev = *(found - 1);
+        if (prev == ' ' || prev == '.' || prev == '@' || prev == '_' || prev == '-' || prev == '/') {
+            return 2500;
+        }
+        return 2000;
     }
 
-    return NULL;
+    return MAX(1000 - gaps, 1);
+}
+
+// add the entry at matches[found] when it matches, returning the new count
+static guint
+_fuzzy_match(AcMatch *matches, guint found, AcEntry *entry, const char *const query,
+    guint64 query_mask, time_t now)
+{
+    // skip items missing any character of the search string
+    if ((query_mask & ~entry->charmask) != 0) {
+        return found;
+    }
+
+    int score = _fuzzy_score(entry->folded, query);
+    if (score < 0) {
+        return found;
+    }
+
+    // prefer frequently and recently used items
+    AcUsage *usage = entry->usage;
+    if (usage) {
+        score += MIN(usage->uses, 50) * 10;
+        double age = difftime(now, usage->last_used);
+        if (age < 60 * 60) {
+            score += 200;
+        } else if (age < 60 * 60 * 24) {
+            score += 100;
+        }
+    }
+
+    matches[found].entry = entry;
+    matches[found].score = score;
+
+    return found + 1;
+}
+
+// matches refer to the items, so they go when the items change
+static void
+_fuzzy_matches_free(Autocomplete ac)
+{
+    if (ac->fuzzy_matches) {
+        g_array_free(ac->fuzzy_matches, TRUE);
+        ac->fuzzy_matches = NULL;
+    }
+    GFREE_SET_NULL(ac->fuzzy_query);
+    ac->fuzzy_cycling = FALSE;
+    ac->fuzzy_pos = 0;
+    ac->fuzzy_ranked = FALSE;
+}
+
+static gint
+_cmp_matches(gconstpointer a, gconstpointer b)
+{
+    const AcMatch *match_a = a;
+    const AcMatch *match_b = b;
+
+    if (match_a->score != match_b->score) {
+        return match_b->score - match_a->score;
+    }
+
+    if (match_a->entry->len != match_b->entry->len) {
+        return match_a->entry->len < match_b->entry->len ? -1 : 1;
+    }
+
+    return strcmp(match_a->entry->item, match_b->entry->item);
 }
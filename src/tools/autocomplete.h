@@ -57,6 +57,13 @@ void autocomplete_remove_all(Autocomplete ac, char **items);
 // find the next item prefixed with search string
 gchar* autocomplete_complete(Autocomplete ac, const gchar *search_str, gboolean quote);
 
+// find the next item containing the search string's characters in order,
+// best ranked first, preferring frequently and recently used items
+gchar* autocomplete_complete_fuzzy(Autocomplete ac, const gchar *search_str, gboolean quote);
+
+// record that an item was used, for fuzzy completion ranking
+void autocomplete_mark_used(Autocomplete ac, const char *const item);
+
 GSList* autocomplete_create_list(Autocomplete ac);
 gint autocomplete_length(Autocomplete ac);
 
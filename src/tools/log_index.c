@@ -0,0 +1,1392 @@
+/*
+ * log_index.c
+ *
+ * Copyright (C) 2012 - 2017 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "common.h"
+#include "log.h"
+#include "config/files.h"
+#include "tools/log_index.h"
+
+#define LOG_INDEX_MIN_TOKEN 2
+
+// lines kept in memory and in the journal before they are written out as a segment
+#define LOG_INDEX_SEAL_LINES 4096
+
+// segments of one level merged into a single segment of the next level
+#define LOG_INDEX_MERGE_FACTOR 4
+
+#define LOG_INDEX_MAGIC "PROFIDX1"
+
+typedef struct log_index_file_t {
+    guint id;
+    char *path;
+    long indexed_to;
+} LogIndexFile;
+
+typedef struct log_index_posting_t {
+    guint file_id;
+    long offset;
+} LogIndexPosting;
+
+// segment files hold the header, the postings of every term, the term strings and
+// then the term table sorted bytewise, all in host byte order
+typedef struct log_index_header_t {
+    char magic[8];
+    guint64 term_count;
+    guint64 strings_offset;
+    guint64 table_offset;
+} LogIndexHeader;
+
+// postings are varint pairs of file id delta and offset, the offset is a delta
+// while the file stays the same
+typedef struct log_index_term_t {
+    guint64 postings_offset;
+    guint64 postings_size;
+    guint32 term_offset;
+    guint32 term_len;
+} LogIndexTerm;
+
+typedef struct log_index_segment_t {
+    guint seq;
+    guint level;
+    GMappedFile *map;
+    const guchar *data;
+    LogIndexHeader header;
+} LogIndexSegment;
+
+typedef struct log_index_writer_t {
+    FILE *fp;
+    gchar *path;
+    gboolean ok;
+    guint64 offset;
+    GString *strings;
+    GArray *table;
+    GByteArray *postings;
+} LogIndexWriter;
+
+// guards everything below, lines are added from the chat log writer and backfill threads
+static pthread_mutex_t index_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static char *logs_dir;
+static char *index_dir;
+static gboolean index_loaded;
+static FILE *journal_fp;
+static GPtrArray *files;
+static GHashTable *files_by_path;
+static GPtrArray *segments;
+static guint next_seq;
+static GHashTable *pending;
+static guint pending_lines;
+static guint seal_at;
+
+static pthread_t backfill_thread;
+static gboolean backfill_started;
+static gint backfill_running;
+static gint backfill_cancel;
+
+static GSList* _tokenise(const char *const text);
+static LogIndexFile* _get_file(const char *const path, gboolean persist);
+static void _add_tokens(LogIndexFile *file, long offset, long end, GSList *tokens, gboolean persist);
+static GArray* _lookup(const char *const token);
+static void _seal(void);
+static gboolean _merge_level(guint level, GSList **obsolete);
+static gboolean _write_manifest(void);
+static void _truncate_journal(void);
+static void _remove_segments(GSList *seqs);
+static gchar* _index_file_path(const char *const name);
+static gchar* _segment_path(guint seq);
+static LogIndexWriter* _writer_new(guint seq);
+static void _writer_add(LogIndexWriter *writer, const guchar *term, gsize term_len, GArray *postings);
+static LogIndexSegment* _writer_finish(LogIndexWriter *writer, guint seq, guint level);
+static LogIndexSegment* _segment_open(guint seq, guint level);
+static gboolean _segment_term(LogIndexSegment *segment, guint64 index, LogIndexTerm *term);
+static gboolean _segment_find(LogIndexSegment *segment, const char *const token, LogIndexTerm *term);
+static void _segment_postings(LogIndexSegment *segment, LogIndexTerm *term, GArray *postings);
+static void _put_varint(GByteArray *buf, guint64 value);
+static gboolean _get_varint(const guchar **pos, const guchar *end, guint64 *value);
+static int _cmp_term(const guchar *a, gsize a_len, const guchar *b, gsize b_len);
+static void _load_index(void);
+static gboolean _load_manifest(void);
+static void _load_journal(void);
+static void _remove_orphans(void);
+static void _reset_index(void);
+static void* _backfill(void *arg);
+static void _backfill_collect(const char *const rel, GSList **paths);
+static void _index_file(const char *const rel, long to);
+static void _free_file(LogIndexFile *file);
+static void _free_postings(GArray *list);
+static void _free_segment(LogIndexSegment *segment);
+static gint _cmp_position(gconstpointer a, gconstpointer b);
+static gint _cmp_posting(gconstpointer a, gconstpointer b, gpointer data);
+
+void
+log_index_on_connect(const char *const barejid)
+{
+    // a reconnect without a disconnect replaces the previous account's index
+    if (logs_dir) {
+        log_index_on_disconnect();
+    }
+
+    char *chatlogs_dir = files_get_data_path(DIR_CHATLOGS);
+    gchar *account_dir = str_replace(barejid, "@", "_at_");
+    char *searchdir = files_get_data_path(DIR_SEARCH);
+    GString *index_file = g_string_new(searchdir);
+    free(searchdir);
+    g_string_append_printf(index_file, "/%s", account_dir);
+
+    // mkdir if doesn't exist for account
+    errno = 0;
+    int res = g_mkdir_with_parents(index_file->str, S_IRWXU);
+    if (res == -1) {
+        log_error("Error creating directory: %s, %s", index_file->str, strerror(errno));
+    }
+
+    pthread_mutex_lock(&index_lock);
+    logs_dir = g_strdup_printf("%s/%s", chatlogs_dir, account_dir);
+    index_dir = g_strdup(index_file->str);
+    index_loaded = FALSE;
+    files = g_ptr_array_new_with_free_func((GDestroyNotify)_free_file);
+    files_by_path = g_hash_table_new(g_str_hash, g_str_equal);
+    segments = g_ptr_array_new_with_free_func((GDestroyNotify)_free_segment);
+    next_seq = 0;
+    pending = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)_free_postings);
+    pending_lines = 0;
+    seal_at = LOG_INDEX_SEAL_LINES;
+    pthread_mutex_unlock(&index_lock);
+
+    free(chatlogs_dir);
+    free(account_dir);
+    g_string_free(index_file, TRUE);
+
+    // load the index, then index any lines written while it wasn't running
+    g_atomic_int_set(&backfill_cancel, 0);
+    g_atomic_int_set(&backfill_running, 1);
+    if (pthread_create(&backfill_thread, NULL, _backfill, NULL) == 0) {
+        backfill_started = TRUE;
+    } else {
+        log_error("Unable to start log index backfill thread");
+        g_atomic_int_set(&backfill_running, 0);
+        backfill_started = FALSE;
+    }
+}
+
+void
+log_index_on_disconnect(void)
+{
+    if (backfill_started) {
+        g_atomic_int_set(&backfill_cancel, 1);
+        pthread_join(backfill_thread, NULL);
+        backfill_started = FALSE;
+    }
+
+    pthread_mutex_lock(&index_lock);
+    if (index_loaded) {
+        // the next connect starts with an empty journal
+        _seal();
+    }
+    if (journal_fp) {
+        fclose(journal_fp);
+        journal_fp = NULL;
+    }
+    if (pending) {
+        g_hash_table_destroy(pending);
+        pending = NULL;
+    }
+    pending_lines = 0;
+    if (segments) {
+        g_ptr_array_free(segments, TRUE);
+        segments = NULL;
+    }
+    if (files_by_path) {
+        g_hash_table_destroy(files_by_path);
+        files_by_path = NULL;
+    }
+    if (files) {
+        g_ptr_array_free(files, TRUE);
+        files = NULL;
+    }
+    g_free(logs_dir);
+    logs_dir = NULL;
+    g_free(index_dir);
+    index_dir = NULL;
+    index_loaded = FALSE;
+    pthread_mutex_unlock(&index_lock);
+}
+
+void
+log_index_add_line(const char *const filename, long offset, const char *const line)
+{
+    pthread_mutex_lock(&index_lock);
+
+    size_t dir_len = logs_dir ? strlen(logs_dir) : 0;
+    if (!index_loaded || strncmp(filename, logs_dir, dir_len) != 0 || filename[dir_len] != '/') {
+        pthread_mutex_unlock(&index_lock);
+        return;
+    }
+
+    // when earlier lines are missing this one is read back by log_index_flushed
+    LogIndexFile *file = _get_file(filename + dir_len + 1, TRUE);
+    if (file->indexed_to == offset) {
+        GSList *tokens = _tokenise(line);
+        _add_tokens(file, offset, offset + strlen(line), tokens, TRUE);
+        g_slist_free_full(tokens, g_free);
+    }
+
+    pthread_mutex_unlock(&index_lock);
+}
+
+void
+log_index_flushed(const char *const filename, long flushed_to)
+{
+    pthread_mutex_lock(&index_lock);
+
+    size_t dir_len = logs_dir ? strlen(logs_dir) : 0;
+    if (!index_loaded || strncmp(filename, logs_dir, dir_len) != 0 || filename[dir_len] != '/') {
+        pthread_mutex_unlock(&index_lock);
+        return;
+    }
+
+    LogIndexFile *file = _get_file(filename + dir_len + 1, TRUE);
+    if (file->indexed_to >= flushed_to) {
+        pthread_mutex_unlock(&index_lock);
+        return;
+    }
+    char *rel = g_strdup(file->path);
+
+    pthread_mutex_unlock(&index_lock);
+
+    _index_file(rel, flushed_to);
+    g_free(rel);
+}
+
+GSList*
+log_index_search(const char *const query, int max)
+{
+    GSList *tokens = _tokenise(query);
+    if (tokens == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&index_lock);
+
+    if (!index_loaded) {
+        pthread_mutex_unlock(&index_lock);
+        g_slist_free_full(tokens, g_free);
+        return NULL;
+    }
+
+    // start from the rarest token, every other token must also match
+    GSList *lists = NULL;
+    GArray *smallest = NULL;
+    gboolean missing = FALSE;
+    GSList *curr = tokens;
+    while (curr && !missing) {
+        GArray *list = _lookup(curr->data);
+        lists = g_slist_prepend(lists, list);
+        if (list->len == 0) {
+            missing = TRUE;
+        } else if (smallest == NULL || list->len < smallest->len) {
+            smallest = list;
+        }
+        curr = g_slist_next(curr);
+    }
+    g_slist_free_full(tokens, g_free);
+
+    if (missing) {
+        pthread_mutex_unlock(&index_lock);
+        g_slist_free_full(lists, (GDestroyNotify)_free_postings);
+        return NULL;
+    }
+
+    GSList *sets = NULL;
+    curr = lists;
+    while (curr) {
+        GArray *list = curr->data;
+        if (list != smallest) {
+            GHashTable *set = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, NULL);
+            guint i;
+            for (i = 0; i < list->len; i++) {
+                LogIndexPosting *posting = &g_array_index(list, LogIndexPosting, i);
+                gint64 *key = g_new(gint64, 1);
+                *key = ((gint64)posting->file_id << 40) | posting->offset;
+                g_hash_table_add(set, key);
+            }
+            sets = g_slist_prepend(sets, set);
+        }
+        curr = g_slist_next(curr);
+    }
+
+    GArray *matches = g_array_new(FALSE, FALSE, sizeof(LogIndexPosting));
+    guint i;
+    for (i = 0; i < smallest->len; i++) {
+        LogIndexPosting *posting = &g_array_index(smallest, LogIndexPosting, i);
+        gint64 key = ((gint64)posting->file_id << 40) | posting->offset;
+        gboolean found = TRUE;
+        GSList *curr_set = sets;
+        while (curr_set && found) {
+            found = g_hash_table_contains(curr_set->data, &key);
+            curr_set = g_slist_next(curr_set);
+        }
+        if (found) {
+            g_array_append_val(matches, *posting);
+        }
+    }
+    g_slist_free_full(sets, (GDestroyNotify)g_hash_table_destroy);
+    g_slist_free_full(lists, (GDestroyNotify)_free_postings);
+
+    // file paths are needed after the lock is released
+    GPtrArray *paths = g_ptr_array_new_with_free_func(g_free);
+    for (i = 0; i < files->len; i++) {
+        LogIndexFile *file = g_ptr_array_index(files, i);
+        g_ptr_array_add(paths, g_strdup(file->path));
+    }
+    char *dir = g_strdup(logs_dir);
+
+    pthread_mutex_unlock(&index_lock);
+
+    g_array_sort_with_data(matches, _cmp_posting, paths);
+
+    GSList *results = NULL;
+    guint start = matches->len > (guint)max ? matches->len - max : 0;
+    for (i = start; i < matches->len; i++) {
+        LogIndexPosting *posting = &g_array_index(matches, LogIndexPosting, i);
+        const char *path = g_ptr_array_index(paths, posting->file_id);
+        char *filename = g_strdup_printf("%s/%s", dir, path);
+        FILE *fp = fopen(filename, "r");
+        g_free(filename);
+        if (fp == NULL) {
+            continue;
+        }
+
+        char *line = NULL;
+        if (fseek(fp, posting->offset, SEEK_SET) == 0) {
+            line = file_getline(fp);
+        }
+        fclose(fp);
+        if (line == NULL) {
+            continue;
+        }
+
+        // paths are <jid>/<date>.log or rooms/<jid>/<date>.log
+        gchar **parts = g_strsplit(path, "/", 3);
+        LogIndexResult *result = malloc(sizeof(LogIndexResult));
+        result->room = g_strcmp0(parts[0], "rooms") == 0 && parts[1] && parts[2];
+        const char *jid_part = result->room ? parts[1] : parts[0];
+        const char *date_part = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+        result->jid = str_replace(jid_part, "_at_", "@");
+        result->date = g_strndup(date_part, 10);
+        g_strdelimit(result->date, "_", '-');
+        result->line = line;
+        g_strfreev(parts);
+
+        results = g_slist_append(results, result);
+    }
+
+    g_array_free(matches, TRUE);
+    g_ptr_array_free(paths, TRUE);
+    g_free(dir);
+
+    return results;
+}
+
+gboolean
+log_index_backfilling(void)
+{
+    return g_atomic_int_get(&backfill_running) == 1;
+}
+
+void
+log_index_free_result(LogIndexResult *result)
+{
+    if (result) {
+        free(result->jid);
+        g_free(result->date);
+        free(result->line);
+        free(result);
+    }
+}
+
+static GSList*
+_tokenise(const char *const text)
+{
+    if (!g_utf8_validate(text, -1, NULL)) {
+        return NULL;
+    }
+
+    // skip the timestamp of log lines
+    const char *start = text;
+    if (strlen(text) >= 11 && text[2] == ':' && text[5] == ':') {
+        start = text + 11;
+    }
+
+    GSList *tokens = NULL;
+    GHashTable *seen = g_hash_table_new(g_str_hash, g_str_equal);
+    gchar *lower = g_utf8_strdown(start, -1);
+    GString *token = g_string_new("");
+    const gchar *curr = lower;
+    while (TRUE) {
+        gunichar ch = *curr ? g_utf8_get_char(curr) : 0;
+        if (ch && g_unichar_isalnum(ch)) {
+            g_string_append_unichar(token, ch);
+        } else {
+            if (g_utf8_strlen(token->str, -1) >= LOG_INDEX_MIN_TOKEN && !g_hash_table_contains(seen, token->str)) {
+                gchar *dup = g_strdup(token->str);
+                g_hash_table_add(seen, dup);
+                tokens = g_slist_prepend(tokens, dup);
+            }
+            g_string_truncate(token, 0);
+            if (!ch) {
+                break;
+            }
+        }
+        curr = g_utf8_next_char(curr);
+    }
+
+    g_string_free(token, TRUE);
+    g_free(lower);
+    g_hash_table_destroy(seen);
+
+    return tokens;
+}
+
+static LogIndexFile*
+_get_file(const char *const path, gboolean persist)
+{
+    LogIndexFile *file = g_hash_table_lookup(files_by_path, path);
+    if (file) {
+        return file;
+    }
+
+    file = malloc(sizeof(LogIndexFile));
+    file->id = files->len;
+    file->path = strdup(path);
+    file->indexed_to = 0;
+    g_ptr_array_add(files, file);
+    g_hash_table_insert(files_by_path, file->path, file);
+
+    if (persist && journal_fp) {
+        fprintf(journal_fp, "F\t%u\t%s\n", file->id, file->path);
+    }
+
+    return file;
+}
+
+// new lines stay in memory until enough have been seen to write a segment,
+// the journal keeps them across a restart until then
+static void
+_add_tokens(LogIndexFile *file, long offset, long end, GSList *tokens, gboolean persist)
+{
+    LogIndexPosting posting;
+    posting.file_id = file->id;
+    posting.offset = offset;
+
+    GString *record = persist ? g_string_new("") : NULL;
+    GSList *curr = tokens;
+    while (curr) {
+        GArray *list = g_hash_table_lookup(pending, curr->data);
+        if (list == NULL) {
+            list = g_array_new(FALSE, FALSE, sizeof(LogIndexPosting));
+            g_hash_table_insert(pending, g_strdup(curr->data), list);
+        }
+        g_array_append_val(list, posting);
+        if (record) {
+            g_string_append_printf(record, "%s%s", record->len ? " " : "", (char*)curr->data);
+        }
+        curr = g_slist_next(curr);
+    }
+    file->indexed_to = end;
+    pending_lines++;
+
+    if (record) {
+        if (journal_fp) {
+            fprintf(journal_fp, "L\t%u\t%ld\t%ld\t%s\n", file->id, offset, end, record->str);
+        }
+        g_string_free(record, TRUE);
+
+        if (pending_lines >= seal_at) {
+            _seal();
+        }
+    }
+}
+
+// postings of a token from every segment and the pending lines
+static GArray*
+_lookup(const char *const token)
+{
+    GArray *list = g_array_new(FALSE, FALSE, sizeof(LogIndexPosting));
+
+    guint i;
+    for (i = 0; i < segments->len; i++) {
+        LogIndexSegment *segment = g_ptr_array_index(segments, i);
+        LogIndexTerm term;
+        if (_segment_find(segment, token, &term)) {
+            _segment_postings(segment, &term, list);
+        }
+    }
+
+    GArray *recent = g_hash_table_lookup(pending, token);
+    if (recent) {
+        g_array_append_vals(list, recent->data, recent->len);
+    }
+
+    return list;
+}
+
+// write the pending lines out as a new segment and empty the journal, a new
+// segment is only used once the manifest lists it so a crash leaves the journal
+// to be replayed instead
+static void
+_seal(void)
+{
+    if (pending_lines == 0) {
+        return;
+    }
+
+    GList *terms = g_hash_table_get_keys(pending);
+    terms = g_list_sort(terms, (GCompareFunc)strcmp);
+
+    guint seq = next_seq++;
+    LogIndexSegment *segment = NULL;
+    LogIndexWriter *writer = _writer_new(seq);
+    if (writer) {
+        GList *curr = terms;
+        while (curr) {
+            GArray *list = g_hash_table_lookup(pending, curr->data);
+            _writer_add(writer, curr->data, strlen(curr->data), list);
+            curr = g_list_next(curr);
+        }
+        segment = _writer_finish(writer, seq, 0);
+    }
+    g_list_free(terms);
+
+    if (segment == NULL) {
+        // keep the lines in memory and the journal, try again after another batch
+        seal_at = pending_lines + LOG_INDEX_SEAL_LINES;
+        return;
+    }
+
+    g_ptr_array_add(segments, segment);
+    g_hash_table_remove_all(pending);
+    pending_lines = 0;
+    seal_at = LOG_INDEX_SEAL_LINES;
+
+    GSList *obsolete = NULL;
+    guint level = 0;
+    while (_merge_level(level, &obsolete)) {
+        level++;
+    }
+
+    // without a manifest the journal is still needed, unlisted segments are removed on the next load
+    if (_write_manifest()) {
+        _truncate_journal();
+        _remove_segments(obsolete);
+    }
+    g_slist_free(obsolete);
+}
+
+// merge the segments of a level once there are enough of them, so searches look
+// at a logarithmic number of segments and each posting is rewritten a few times
+static gboolean
+_merge_level(guint level, GSList **obsolete)
+{
+    GPtrArray *inputs = g_ptr_array_new();
+    guint i;
+    for (i = 0; i < segments->len; i++) {
+        LogIndexSegment *segment = g_ptr_array_index(segments, i);
+        if (segment->level == level) {
+            g_ptr_array_add(inputs, segment);
+        }
+    }
+
+    if (inputs->len < LOG_INDEX_MERGE_FACTOR) {
+        g_ptr_array_free(inputs, TRUE);
+        return FALSE;
+    }
+
+    guint seq = next_seq++;
+    LogIndexWriter *writer = _writer_new(seq);
+    if (writer == NULL) {
+        g_ptr_array_free(inputs, TRUE);
+        return FALSE;
+    }
+
+    guint64 *cursors = g_new0(guint64, inputs->len);
+    GArray *merged = g_array_new(FALSE, FALSE, sizeof(LogIndexPosting));
+    while (TRUE) {
+        const guchar *min = NULL;
+        gsize min_len = 0;
+        for (i = 0; i < inputs->len; i++) {
+            LogIndexSegment *segment = g_ptr_array_index(inputs, i);
+            LogIndexTerm term;
+            if (cursors[i] >= segment->header.term_count) {
+                continue;
+            }
+            if (!_segment_term(segment, cursors[i], &term)) {
+                cursors[i] = segment->header.term_count;
+                continue;
+            }
+            const guchar *str = segment->data + segment->header.strings_offset + term.term_offset;
+            if (min == NULL || _cmp_term(str, term.term_len, min, min_len) < 0) {
+                min = str;
+                min_len = term.term_len;
+            }
+        }
+        if (min == NULL) {
+            break;
+        }
+
+        g_array_set_size(merged, 0);
+        for (i = 0; i < inputs->len; i++) {
+            LogIndexSegment *segment = g_ptr_array_index(inputs, i);
+            LogIndexTerm term;
+            if (cursors[i] < segment->header.term_count && _segment_term(segment, cursors[i], &term)) {
+                const guchar *str = segment->data + segment->header.strings_offset + term.term_offset;
+                if (_cmp_term(str, term.term_len, min, min_len) == 0) {
+                    _segment_postings(segment, &term, merged);
+                    cursors[i]++;
+                }
+            }
+        }
+        g_array_sort(merged, _cmp_position);
+        _writer_add(writer, min, min_len, merged);
+    }
+    g_array_free(merged, TRUE);
+    g_free(cursors);
+
+    LogIndexSegment *segment = _writer_finish(writer, seq, level + 1);
+    if (segment == NULL) {
+        g_ptr_array_free(inputs, TRUE);
+        return FALSE;
+    }
+
+    for (i = 0; i < inputs->len; i++) {
+        LogIndexSegment *input = g_ptr_array_index(inputs, i);
+        *obsolete = g_slist_prepend(*obsolete, GUINT_TO_POINTER(input->seq));
+        g_ptr_array_remove(segments, input);
+    }
+    g_ptr_array_add(segments, segment);
+    g_ptr_array_free(inputs, TRUE);
+
+    return TRUE;
+}
+
+// records are "N <next segment>", "S <segment> <level>" and "F <id> <indexed to> <path>"
+static gboolean
+_write_manifest(void)
+{
+    gchar *path = _index_file_path("manifest");
+    gchar *tmp = g_strdup_printf("%s.tmp", path);
+
+    gboolean ok = FALSE;
+    FILE *fp = fopen(tmp, "w");
+    if (fp) {
+        fprintf(fp, "N\t%u\n", next_seq);
+        guint i;
+        for (i = 0; i < segments->len; i++) {
+            LogIndexSegment *segment = g_ptr_array_index(segments, i);
+            fprintf(fp, "S\t%u\t%u\n", segment->seq, segment->level);
+        }
+        for (i = 0; i < files->len; i++) {
+            LogIndexFile *file = g_ptr_array_index(files, i);
+            fprintf(fp, "F\t%u\t%ld\t%s\n", file->id, file->indexed_to, file->path);
+        }
+        ok = !ferror(fp);
+        ok = (fclose(fp) == 0) && ok;
+    }
+
+    if (ok) {
+        g_chmod(tmp, S_IRUSR | S_IWUSR);
+        ok = g_rename(tmp, path) == 0;
+    }
+    if (!ok) {
+        g_unlink(tmp);
+    }
+
+    g_free(tmp);
+    g_free(path);
+
+    return ok;
+}
+
+static void
+_truncate_journal(void)
+{
+    if (journal_fp) {
+        fclose(journal_fp);
+    }
+
+    gchar *path = _index_file_path("journal");
+    journal_fp = fopen(path, "w");
+    if (journal_fp) {
+        g_chmod(path, S_IRUSR | S_IWUSR);
+    }
+    g_free(path);
+}
+
+static void
+_remove_segments(GSList *seqs)
+{
+    GSList *curr = seqs;
+    while (curr) {
+        gchar *path = _segment_path(GPOINTER_TO_UINT(curr->data));
+        g_unlink(path);
+        g_free(path);
+        curr = g_slist_next(curr);
+    }
+}
+
+static gchar*
+_index_file_path(const char *const name)
+{
+    return g_strdup_printf("%s/%s", index_dir, name);
+}
+
+static gchar*
+_segment_path(guint seq)
+{
+    return g_strdup_printf("%s/seg-%u", index_dir, seq);
+}
+
+static LogIndexWriter*
+_writer_new(guint seq)
+{
+    gchar *path = _segment_path(seq);
+    gchar *tmp = g_strdup_printf("%s.tmp", path);
+    FILE *fp = fopen(tmp, "w");
+    g_free(tmp);
+    if (fp == NULL) {
+        g_free(path);
+        return NULL;
+    }
+
+    LogIndexWriter *writer = malloc(sizeof(LogIndexWriter));
+    writer->fp = fp;
+    writer->path = path;
+    writer->strings = g_string_new("");
+    writer->table = g_array_new(FALSE, FALSE, sizeof(LogIndexTerm));
+    writer->postings = g_byte_array_new();
+
+    // the header is rewritten once the offsets are known
+    LogIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    writer->ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    writer->offset = sizeof(header);
+
+    return writer;
+}
+
+// terms must be added in bytewise order with their postings sorted by position
+static void
+_writer_add(LogIndexWriter *writer, const guchar *term, gsize term_len, GArray *postings)
+{
+    GByteArray *buf = writer->postings;
+    g_byte_array_set_size(buf, 0);
+
+    guint prev_file = 0;
+    long prev_offset = 0;
+    guint i;
+    for (i = 0; i < postings->len; i++) {
+        LogIndexPosting *posting = &g_array_index(postings, LogIndexPosting, i);
+        if (posting->file_id != prev_file) {
+            prev_offset = 0;
+        }
+        _put_varint(buf, posting->file_id - prev_file);
+        _put_varint(buf, posting->offset - prev_offset);
+        prev_file = posting->file_id;
+        prev_offset = posting->offset;
+    }
+
+    LogIndexTerm entry;
+    entry.postings_offset = writer->offset;
+    entry.postings_size = buf->len;
+    entry.term_offset = writer->strings->len;
+    entry.term_len = term_len;
+    g_string_append_len(writer->strings, (const gchar*)term, term_len);
+    g_array_append_val(writer->table, entry);
+
+    if (buf->len > 0 && fwrite(buf->data, buf->len, 1, writer->fp) != 1) {
+        writer->ok = FALSE;
+    }
+    writer->offset += buf->len;
+}
+
+static LogIndexSegment*
+_writer_finish(LogIndexWriter *writer, guint seq, guint level)
+{
+    LogIndexHeader header;
+    memcpy(header.magic, LOG_INDEX_MAGIC, sizeof(header.magic));
+    header.term_count = writer->table->len;
+    header.strings_offset = writer->offset;
+    header.table_offset = writer->offset + writer->strings->len;
+
+    gboolean ok = writer->ok;
+    if (writer->strings->len > 0) {
+        ok = ok && fwrite(writer->strings->str, writer->strings->len, 1, writer->fp) == 1;
+    }
+    if (writer->table->len > 0) {
+        ok = ok && fwrite(writer->table->data, sizeof(LogIndexTerm), writer->table->len, writer->fp) ==
+            writer->table->len;
+    }
+    ok = ok && fseek(writer->fp, 0, SEEK_SET) == 0;
+    ok = ok && fwrite(&header, sizeof(header), 1, writer->fp) == 1;
+    ok = (fclose(writer->fp) == 0) && ok;
+
+    gchar *tmp = g_strdup_printf("%s.tmp", writer->path);
+    if (ok) {
+        g_chmod(tmp, S_IRUSR | S_IWUSR);
+        ok = g_rename(tmp, writer->path) == 0;
+    }
+    if (!ok) {
+        g_unlink(tmp);
+    }
+    g_free(tmp);
+
+    g_free(writer->path);
+    g_string_free(writer->strings, TRUE);
+    g_array_free(writer->table, TRUE);
+    g_byte_array_free(writer->postings, TRUE);
+    free(writer);
+
+    return ok ? _segment_open(seq, level) : NULL;
+}
+
+static LogIndexSegment*
+_segment_open(guint seq, guint level)
+{
+    gchar *path = _segment_path(seq);
+    GMappedFile *map = g_mapped_file_new(path, FALSE, NULL);
+    g_free(path);
+    if (map == NULL) {
+        return NULL;
+    }
+
+    gsize size = g_mapped_file_get_length(map);
+    const guchar *data = (const guchar*)g_mapped_file_get_contents(map);
+    LogIndexHeader header;
+    if (size < sizeof(header)) {
+        g_mapped_file_unref(map);
+        return NULL;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, LOG_INDEX_MAGIC, sizeof(header.magic)) != 0 ||
+            header.strings_offset < sizeof(header) ||
+            header.strings_offset > header.table_offset ||
+            header.table_offset > size ||
+            (size - header.table_offset) / sizeof(LogIndexTerm) != header.term_count ||
+            (size - header.table_offset) % sizeof(LogIndexTerm) != 0) {
+        g_mapped_file_unref(map);
+        return NULL;
+    }
+
+    LogIndexSegment *segment = malloc(sizeof(LogIndexSegment));
+    segment->seq = seq;
+    segment->level = level;
+    segment->map = map;
+    segment->data = data;
+    segment->header = header;
+
+    return segment;
+}
+
+// the table is read through memcpy, the mapping gives no alignment guarantee
+static gboolean
+_segment_term(LogIndexSegment *segment, guint64 index, LogIndexTerm *term)
+{
+    memcpy(term, segment->data + segment->header.table_offset + index * sizeof(LogIndexTerm), sizeof(LogIndexTerm));
+
+    guint64 strings_size = segment->header.table_offset - segment->header.strings_offset;
+    if ((guint64)term->term_offset + term->term_len > strings_size) {
+        return FALSE;
+    }
+    if (term->postings_offset < sizeof(LogIndexHeader) || term->postings_offset > segment->header.strings_offset ||
+            term->postings_size > segment->header.strings_offset - term->postings_offset) {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static gboolean
+_segment_find(LogIndexSegment *segment, const char *const token, LogIndexTerm *term)
+{
+    gsize token_len = strlen(token);
+    guint64 low = 0;
+    guint64 high = segment->header.term_count;
+    while (low < high) {
+        guint64 mid = low + (high - low) / 2;
+        if (!_segment_term(segment, mid, term)) {
+            return FALSE;
+        }
+
+        const guchar *str = segment->data + segment->header.strings_offset + term->term_offset;
+        int cmp = _cmp_term(str, term->term_len, (const guchar*)token, token_len);
+        if (cmp == 0) {
+            return TRUE;
+        } else if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return FALSE;
+}
+
+static void
+_segment_postings(LogIndexSegment *segment, LogIndexTerm *term, GArray *postings)
+{
+    const guchar *pos = segment->data + term->postings_offset;
+    const guchar *end = pos + term->postings_size;
+
+    LogIndexPosting posting;
+    posting.file_id = 0;
+    posting.offset = 0;
+    while (pos < end) {
+        guint64 file_delta;
+        guint64 offset_delta;
+        if (!_get_varint(&pos, end, &file_delta) || !_get_varint(&pos, end, &offset_delta)) {
+            break;
+        }
+        if (file_delta != 0) {
+            posting.offset = 0;
+        }
+        posting.file_id += file_delta;
+        posting.offset += offset_delta;
+        g_array_append_val(postings, posting);
+    }
+}
+
+static void
+_put_varint(GByteArray *buf, guint64 value)
+{
+    guint8 byte;
+    while (value >= 0x80) {
+        byte = (value & 0x7f) | 0x80;
+        g_byte_array_append(buf, &byte, 1);
+        value >>= 7;
+    }
+    byte = value;
+    g_byte_array_append(buf, &byte, 1);
+}
+
+static gboolean
+_get_varint(const guchar **pos, const guchar *end, guint64 *value)
+{
+    *value = 0;
+    int shift = 0;
+    while (*pos < end && shift < 64) {
+        guchar byte = *(*pos)++;
+        *value |= (guint64)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return TRUE;
+        }
+        shift += 7;
+    }
+
+    return FALSE;
+}
+
+static int
+_cmp_term(const guchar *a, gsize a_len, const guchar *b, gsize b_len)
+{
+    int result = memcmp(a, b, MIN(a_len, b_len));
+    if (result != 0) {
+        return result;
+    }
+
+    return (a_len > b_len) - (a_len < b_len);
+}
+
+// only the manifest and the journal are read, segments are mapped and searched in place
+static void
+_load_index(void)
+{
+    pthread_mutex_lock(&index_lock);
+
+    if (_load_manifest()) {
+        _load_journal();
+    } else {
+        _reset_index();
+    }
+    _remove_orphans();
+
+    gchar *path = _index_file_path("journal");
+    journal_fp = fopen(path, "a");
+    if (journal_fp) {
+        g_chmod(path, S_IRUSR | S_IWUSR);
+    }
+    g_free(path);
+
+    index_loaded = TRUE;
+    if (pending_lines >= seal_at) {
+        _seal();
+    }
+
+    pthread_mutex_unlock(&index_lock);
+}
+
+static gboolean
+_load_manifest(void)
+{
+    gchar *path = _index_file_path("manifest");
+    FILE *fp = fopen(path, "r");
+    g_free(path);
+    if (fp == NULL) {
+        return TRUE;
+    }
+
+    gboolean ok = TRUE;
+    char *line = NULL;
+    while (ok && (line = file_getline(fp)) != NULL) {
+        gchar **fields = g_strsplit(line, "\t", 4);
+        guint len = g_strv_length(fields);
+        if (len == 2 && g_strcmp0(fields[0], "N") == 0) {
+            guint seq = strtoul(fields[1], NULL, 10);
+            if (seq > next_seq) {
+                next_seq = seq;
+            }
+        } else if (len == 3 && g_strcmp0(fields[0], "S") == 0) {
+            guint seq = strtoul(fields[1], NULL, 10);
+            LogIndexSegment *segment = _segment_open(seq, strtoul(fields[2], NULL, 10));
+            if (segment) {
+                g_ptr_array_add(segments, segment);
+                if (seq >= next_seq) {
+                    next_seq = seq + 1;
+                }
+            } else {
+                // lines counted as indexed would be missing, start again from the logs
+                ok = FALSE;
+            }
+        } else if (len == 4 && g_strcmp0(fields[0], "F") == 0) {
+            guint id = strtoul(fields[1], NULL, 10);
+            if (id == files->len) {
+                LogIndexFile *file = _get_file(fields[3], FALSE);
+                file->indexed_to = strtol(fields[2], NULL, 10);
+            }
+        }
+        g_strfreev(fields);
+        free(line);
+    }
+    fclose(fp);
+
+    return ok;
+}
+
+// records are "F <id> <path>" for log files and "L <file id> <offset> <end> <tokens>" for lines
+static void
+_load_journal(void)
+{
+    gchar *path = _index_file_path("journal");
+    FILE *fp = fopen(path, "r");
+    g_free(path);
+    if (fp == NULL) {
+        return;
+    }
+
+    char *line = NULL;
+    while ((line = file_getline(fp)) != NULL) {
+        gchar **fields = g_strsplit(line, "\t", 5);
+        guint len = g_strv_length(fields);
+        if (len == 3 && g_strcmp0(fields[0], "F") == 0) {
+            guint id = strtoul(fields[1], NULL, 10);
+            if (id == files->len) {
+                _get_file(fields[2], FALSE);
+            }
+        } else if (len == 5 && g_strcmp0(fields[0], "L") == 0) {
+            guint id = strtoul(fields[1], NULL, 10);
+            long offset = strtol(fields[2], NULL, 10);
+            LogIndexFile *file = id < files->len ? g_ptr_array_index(files, id) : NULL;
+
+            // lines already written to a segment before a crash are skipped
+            if (file && file->indexed_to == offset) {
+                gchar **words = g_strsplit(fields[4], " ", -1);
+                GSList *tokens = NULL;
+                int i;
+                for (i = 0; words[i]; i++) {
+                    if (words[i][0]) {
+                        tokens = g_slist_prepend(tokens, words[i]);
+                    }
+                }
+                _add_tokens(file, offset, strtol(fields[3], NULL, 10), tokens, FALSE);
+                g_slist_free(tokens);
+                g_strfreev(words);
+            }
+        }
+        g_strfreev(fields);
+        free(line);
+    }
+
+    fclose(fp);
+}
+
+// segments and temporary files the manifest does not list are left over from a crash
+static void
+_remove_orphans(void)
+{
+    GDir *dir = g_dir_open(index_dir, 0, NULL);
+    if (dir == NULL) {
+        return;
+    }
+
+    GHashTable *live = g_hash_table_new(g_str_hash, g_str_equal);
+    guint i;
+    for (i = 0; i < segments->len; i++) {
+        LogIndexSegment *segment = g_ptr_array_index(segments, i);
+        gchar *name = g_strdup_printf("seg-%u", segment->seq);
+        g_hash_table_add(live, name);
+    }
+
+    const gchar *name = NULL;
+    while ((name = g_dir_read_name(dir)) != NULL) {
+        if (g_str_has_suffix(name, ".tmp") || (g_str_has_prefix(name, "seg-") && !g_hash_table_contains(live, name))) {
+            gchar *path = _index_file_path(name);
+            g_unlink(path);
+            g_free(path);
+        }
+    }
+    g_dir_close(dir);
+
+    GList *names = g_hash_table_get_keys(live);
+    g_list_free_full(names, g_free);
+    g_hash_table_destroy(live);
+}
+
+// forget everything so the backfill indexes all logs again
+static void
+_reset_index(void)
+{
+    g_ptr_array_set_size(segments, 0);
+    g_hash_table_remove_all(files_by_path);
+    g_ptr_array_set_size(files, 0);
+    g_hash_table_remove_all(pending);
+    pending_lines = 0;
+
+    gchar *path = _index_file_path("manifest");
+    g_unlink(path);
+    g_free(path);
+    path = _index_file_path("journal");
+    g_unlink(path);
+    g_free(path);
+}
+
+static void*
+_backfill(void *arg)
+{
+    _load_index();
+
+    GSList *paths = NULL;
+    if (!g_atomic_int_get(&backfill_cancel)) {
+        _backfill_collect(NULL, &paths);
+        paths = g_slist_sort(paths, (GCompareFunc)g_strcmp0);
+    }
+
+    GSList *curr = paths;
+    while (curr && !g_atomic_int_get(&backfill_cancel)) {
+        _index_file(curr->data, -1);
+        curr = g_slist_next(curr);
+    }
+    g_slist_free_full(paths, g_free);
+
+    g_atomic_int_set(&backfill_running, 0);
+
+    return NULL;
+}
+
+// paths are collected unordered, the caller sorts them once
+static void
+_backfill_collect(const char *const rel, GSList **paths)
+{
+    pthread_mutex_lock(&index_lock);
+    char *dir = rel ? g_strdup_printf("%s/%s", logs_dir, rel) : g_strdup(logs_dir);
+    pthread_mutex_unlock(&index_lock);
+
+    GDir *gdir = g_dir_open(dir, 0, NULL);
+    g_free(dir);
+    if (gdir == NULL) {
+        return;
+    }
+
+    const gchar *name = NULL;
+    while ((name = g_dir_read_name(gdir)) != NULL) {
+        char *child = rel ? g_strdup_printf("%s/%s", rel, name) : g_strdup(name);
+        if (g_str_has_suffix(name, ".log")) {
+            *paths = g_slist_prepend(*paths, child);
+        } else {
+            _backfill_collect(child, paths);
+            g_free(child);
+        }
+    }
+
+    g_dir_close(gdir);
+}
+
+// index complete lines of a log file from where the index stopped, up to the given offset or
+// the end of the file when negative
+static void
+_index_file(const char *const rel, long to)
+{
+    pthread_mutex_lock(&index_lock);
+    if (!index_loaded) {
+        pthread_mutex_unlock(&index_lock);
+        return;
+    }
+    char *filename = g_strdup_printf("%s/%s", logs_dir, rel);
+    LogIndexFile *file = _get_file(rel, TRUE);
+    long start = file->indexed_to;
+    pthread_mutex_unlock(&index_lock);
+
+    FILE *fp = fopen(filename, "r");
+    g_free(filename);
+    if (fp == NULL) {
+        return;
+    }
+
+    if (fseek(fp, start, SEEK_SET) != 0) {
+        fclose(fp);
+        return;
+    }
+
+    while (!g_atomic_int_get(&backfill_cancel)) {
+        long offset = ftell(fp);
+        if (to >= 0 && offset >= to) {
+            break;
+        }
+
+        char *line = file_getline(fp);
+        if (line == NULL) {
+            break;
+        }
+
+        // a line without a newline is still being written
+        if (feof(fp)) {
+            free(line);
+            break;
+        }
+
+        long end = ftell(fp);
+        GSList *tokens = _tokenise(line);
+        pthread_mutex_lock(&index_lock);
+
+        // the index may have been closed, or another thread indexed this line first
+        file = files_by_path ? g_hash_table_lookup(files_by_path, rel) : NULL;
+        gboolean closed = file == NULL;
+        if (file && file->indexed_to == offset) {
+            _add_tokens(file, offset, end, tokens, TRUE);
+        }
+        pthread_mutex_unlock(&index_lock);
+        g_slist_free_full(tokens, g_free);
+        free(line);
+
+        if (closed) {
+            break;
+        }
+    }
+
+    fclose(fp);
+
+    pthread_mutex_lock(&index_lock);
+    if (journal_fp) {
+        fflush(journal_fp);
+    }
+    pthread_mutex_unlock(&index_lock);
+}
+
+static void
+_free_file(LogIndexFile *file)
+{
+    free(file->path);
+    free(file);
+}
+
+static void
+_free_postings(GArray *list)
+{
+    g_array_free(list, TRUE);
+}
+
+static void
+_free_segment(LogIndexSegment *segment)
+{
+    g_mapped_file_unref(segment->map);
+    free(segment);
+}
+
+static gint
+_cmp_position(gconstpointer a, gconstpointer b)
+{
+    const LogIndexPosting *posting_a = a;
+    const LogIndexPosting *posting_b = b;
+
+    if (posting_a->file_id != posting_b->file_id) {
+        return (posting_a->file_id > posting_b->file_id) - (posting_a->file_id < posting_b->file_id);
+    }
+
+    return (posting_a->offset > posting_b->offset) - (posting_a->offset < posting_b->offset);
+}
+
+// oldest first, by date then file then position
+static gint
+_cmp_posting(gconstpointer a, gconstpointer b, gpointer data)
+{
+    GPtrArray *paths = data;
+    const LogIndexPosting *posting_a = a;
+    const LogIndexPosting *posting_b = b;
+    const char *path_a = g_ptr_array_index(paths, posting_a->file_id);
+    const char *path_b = g_ptr_array_index(paths, posting_b->file_id);
+    const char *date_a = strrchr(path_a, '/') ? strrchr(path_a, '/') + 1 : path_a;
+    const char *date_b = strrchr(path_b, '/') ? strrchr(path_b, '/') + 1 : path_b;
+
+    int result = g_strcmp0(date_a, date_b);
+    if (result != 0) {
+        return result;
+    }
+    result = g_strcmp0(path_a, path_b);
+    if (result != 0) {
+        return result;
+    }
+
+    return (posting_a->offset > posting_b->offset) - (posting_a->offset < posting_b->offset);
+}
@@ -0,0 +1,55 @@
+/*
+ * log_index.h
+ *
+ * Copyright (C) 2012 - 2017 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#ifndef TOOLS_LOG_INDEX_H
+#define TOOLS_LOG_INDEX_H
+
+#include <glib.h>
+
+typedef struct log_index_result_t {
+    char *jid;
+    gboolean room;
+    char *date;
+    char *line;
+} LogIndexResult;
+
+void log_index_on_connect(const char *const barejid);
+void log_index_on_disconnect(void);
+void log_index_add_line(const char *const filename, long offset, const char *const line);
+void log_index_flushed(const char *const filename, long flushed_to);
+GSList* log_index_search(const char *const query, int max);
+gboolean log_index_backfilling(void);
+void log_index_free_result(LogIndexResult *result);
+
+#endif
@@ -0,0 +1,264 @@
+/*
+ * matcher.c
+ *
+ * Copyright (C) 2012 - 2017 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "tools/matcher.h"
+
+// Aho-Corasick automaton over the bytes of the patterns, children are kept
+// as sibling lists since the trie is small and sparse
+typedef struct matcher_node_t {
+    guchar byte;
+    int first_child;
+    int next_sibling;
+
+    // longest proper suffix of this node that is also in the trie
+    int fail;
+
+    // nearest node on the fail chain that ends a pattern
+    int output;
+
+    // first pattern ending at this node, -1 if none
+    int pattern;
+} MatcherNode;
+
+typedef struct matcher_pattern_t {
+    int id;
+    int len;
+    int char_len;
+
+    // next pattern ending at the same node
+    int next;
+} MatcherPattern;
+
+struct matcher_t {
+    GArray *nodes;
+    GArray *patterns;
+    gboolean compiled;
+};
+
+static int _node_new(Matcher matcher, guchar byte);
+static int _node_child(Matcher matcher, int node, guchar byte);
+static void _matcher_compile(Matcher matcher);
+
+#define NODE(matcher, i) (&g_array_index((matcher)->nodes, MatcherNode, (i)))
+#define ROOT 0
+
+Matcher
+matcher_new(void)
+{
+    Matcher matcher = malloc(sizeof(struct matcher_t));
+    matcher->nodes = g_array_new(FALSE, FALSE, sizeof(MatcherNode));
+    matcher->patterns = g_array_new(FALSE, FALSE, sizeof(MatcherPattern));
+    matcher->compiled = FALSE;
+
+    _node_new(matcher, 0);
+
+    return matcher;
+}
+
+void
+matcher_free(Matcher matcher)
+{
+    if (matcher) {
+        g_array_free(matcher->nodes, TRUE);
+        g_array_free(matcher->patterns, TRUE);
+        free(matcher);
+    }
+}
+
+void
+matcher_add(Matcher matcher, const char *const pattern, int id)
+{
+    if (!matcher || !pattern || pattern[0] == '\0') {
+        return;
+    }
+
+    int node = ROOT;
+    const guchar *curr = (const guchar*)pattern;
+    while (*curr) {
+        int child = _node_child(matcher, node, *curr);
+        if (child == -1) {
+            child = _node_new(matcher, *curr);
+            MatcherNode *parent = NODE(matcher, node);
+            NODE(matcher, child)->next_sibling = parent->first_child;
+            parent->first_child = child;
+        }
+        node = child;
+        curr++;
+    }
+
+    MatcherPattern new_pattern;
+    new_pattern.id = id;
+    new_pattern.len = strlen(pattern);
+    new_pattern.char_len = g_utf8_strlen(pattern, -1);
+    new_pattern.next = NODE(matcher, node)->pattern;
+    g_array_append_val(matcher->patterns, new_pattern);
+    NODE(matcher, node)->pattern = matcher->patterns->len - 1;
+
+    matcher->compiled = FALSE;
+}
+
+GSList*
+matcher_find_all(Matcher matcher, const char *const text)
+{
+    if (!matcher || !text) {
+        return NULL;
+    }
+
+    if (!matcher->compiled) {
+        _matcher_compile(matcher);
+    }
+
+    GSList *result = NULL;
+    int node = ROOT;
+    int chars = 0;
+    int i = 0;
+    for (i = 0; text[i] != '\0'; i++) {
+        guchar byte = text[i];
+
+        // count characters at the first byte of each UTF-8 sequence
+        if ((byte & 0xC0) != 0x80) {
+            chars++;
+        }
+
+        int child = _node_child(matcher, node, byte);
+        while (child == -1 && node != ROOT) {
+            node = NODE(matcher, node)->fail;
+            child = _node_child(matcher, node, byte);
+        }
+        node = child == -1 ? ROOT : child;
+
+        int out = NODE(matcher, node)->pattern != -1 ? node : NODE(matcher, node)->output;
+        while (out != -1) {
+            int p = NODE(matcher, out)->pattern;
+            while (p != -1) {
+                MatcherPattern *pattern = &g_array_index(matcher->patterns, MatcherPattern, p);
+                MatcherMatch *match = malloc(sizeof(MatcherMatch));
+                match->id = pattern->id;
+                match->start = i + 1 - pattern->len;
+                match->offset = chars - pattern->char_len;
+                match->len = pattern->len;
+                result = g_slist_prepend(result, match);
+                p = pattern->next;
+            }
+            out = NODE(matcher, out)->output;
+        }
+    }
+
+    return g_slist_reverse(result);
+}
+
+static int
+_node_new(Matcher matcher, guchar byte)
+{
+    MatcherNode node;
+    node.byte = byte;
+    node.first_child = -1;
+    node.next_sibling = -1;
+    node.fail = ROOT;
+    node.output = -1;
+    node.pattern = -1;
+    g_array_append_val(matcher->nodes, node);
+
+    return matcher->nodes->len - 1;
+}
+
+static int
+_node_child(Matcher matcher, int node, guchar byte)
+{
+    int child = NODE(matcher, node)->first_child;
+    while (child != -1) {
+        if (NODE(matcher, child)->byte == byte) {
+            return child;
+        }
+        child = NODE(matcher, child)->next_sibling;
+    }
+
+    return -1;
+}
+
+// set fail and output links breadth first, so every node's fail target is
+// complete before the node itself is processed
+static void
+_matcher_compile(Matcher matcher)
+{
+    GQueue *queue = g_queue_new();
+
+    int child = NODE(matcher, ROOT)->first_child;
+    while (child != -1) {
+        NODE(matcher, child)->fail = ROOT;
+        NODE(matcher, child)->output = -1;
+        g_queue_push_tail(queue, GINT_TO_POINTER(child));
+        child = NODE(matcher, child)->next_sibling;
+    }
+
+    while (!g_queue_is_empty(queue)) {
+        int node = GPOINTER_TO_INT(g_queue_pop_head(queue));
+
+        child = NODE(matcher, node)->first_child;
+        while (child != -1) {
+            guchar byte = NODE(matcher, child)->byte;
+
+            int fail = NODE(matcher, node)->fail;
+            int target = _node_child(matcher, fail, byte);
+            while (target == -1 && fail != ROOT) {
+                fail = NODE(matcher, fail)->fail;
+                target = _node_child(matcher, fail, byte);
+            }
+            if (target == -1) {
+                target = ROOT;
+            }
+
+            MatcherNode *child_node = NODE(matcher, child);
+            child_node->fail = target;
+            if (NODE(matcher, target)->pattern != -1) {
+                child_node->output = target;
+            } else {
+                child_node->output = NODE(matcher, target)->output;
+            }
+
+            g_queue_push_tail(queue, GINT_TO_POINTER(child));
+            child = child_node->next_sibling;
+        }
+    }
+
+    g_queue_free(queue);
+    matcher->compiled = TRUE;
+}
@@ -0,0 +1,66 @@
+/*
+ * matcher.h
+ *
+ * Copyright (C) 2012 - 2017 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#ifndef TOOLS_MATCHER_H
+#define TOOLS_MATCHER_H
+
+#include <glib.h>
+
+typedef struct matcher_t *Matcher;
+
+typedef struct matcher_match_t {
+    // id given to matcher_add for the pattern found
+    int id;
+
+    // start of the match in bytes and in characters
+    int start;
+    int offset;
+
+    // length of the match in bytes
+    int len;
+} MatcherMatch;
+
+// multi pattern matcher, finds every pattern in a text in a single pass
+Matcher matcher_new(void);
+void matcher_free(Matcher matcher);
+
+// patterns are matched exactly, callers should lower case both patterns
+// and text for case insensitive matching
+void matcher_add(Matcher matcher, const char *const pattern, int id);
+
+// all matches in order of their end position, free with
+// g_slist_free_full(matches, free)
+GSList* matcher_find_all(Matcher matcher, const char *const text);
+
+#endif
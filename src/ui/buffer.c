@@ -37,7 +37,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
-#include <stdlib.h>
 
 #include <glib.h>
 #ifdef HAVE_NCURSESW_NCURSES_H
@@ -49,32 +48,60 @@
 #include "ui/window.h"
 #include "ui/buffer.h"
 
-#define BUFF_SIZE 1200
+#define BUFF_INITIAL_ALLOC 64
 
+// entries are stored in a ring, head is the index of the oldest entry
 struct prof_buff_t {
-    GSList *entries;
+    ProfBuffEntry **entries;
+    int capacity;
+    int allocated;
+    int head;
+    int size;
+    GHashTable *receipts;
 };
 
+static ProfBuffEntry* _create_entry(ProfBuff buffer, const char show_char, int pad_indent, GDateTime *time,
+    int flags, theme_item_t theme_item, const char *const from, const char *const message, DeliveryReceipt *receipt);
 static void _free_entry(ProfBuffEntry *entry);
+static void _evict_entry(ProfBuff buffer, ProfBuffEntry *entry);
+static void _grow(ProfBuff buffer);
 
 ProfBuff
-buffer_create(void)
+buffer_create(int capacity)
 {
+    assert(capacity > 0);
+
     ProfBuff new_buff = malloc(sizeof(struct prof_buff_t));
     new_buff->entries = NULL;
+    new_buff->capacity = capacity;
+    new_buff->allocated = 0;
+    new_buff->head = 0;
+    new_buff->size = 0;
+    new_buff->receipts = g_hash_table_new(g_str_hash, g_str_equal);
     return new_buff;
 }
 
 int
 buffer_size(ProfBuff buffer)
 {
-    return g_slist_length(buffer->entries);
+    return buffer->size;
+}
+
+int
+buffer_capacity(ProfBuff buffer)
+{
+    return buffer->capacity;
 }
 
 void
 buffer_free(ProfBuff buffer)
 {
-    g_slist_free_full(buffer->entries, (GDestroyNotify)_free_entry);
+    int i;
+    for (i = 0; i < buffer->size; i++) {
+        _free_entry(buffer->entries[(buffer->head + i) % buffer->allocated]);
+    }
+    free(buffer->entries);
+    g_hash_table_destroy(buffer->receipts);
     free(buffer);
 }
 
@@ -82,37 +109,52 @@ void
 buffer_push(ProfBuff buffer, const char show_char, int pad_indent, GDateTime *time,
     int flags, theme_item_t theme_item, const char *const from, const char *const message, DeliveryReceipt *receipt)
 {
-    ProfBuffEntry *e = malloc(sizeof(struct prof_buff_entry_t));
-    e->show_char = show_char;
-    e->pad_indent = pad_indent;
-    e->flags = flags;
-    e->theme_item = theme_item;
-    e->time = g_date_time_ref(time);
-    e->from = from ? strdup(from) : NULL;
-    e->message = strdup(message);
-    e->receipt = receipt;
+    ProfBuffEntry *e = _create_entry(buffer, show_char, pad_indent, time, flags, theme_item, from, message, receipt);
+
+    if (buffer->size == buffer->capacity) {
+        // full, overwrite the oldest entry
+        _evict_entry(buffer, buffer->entries[buffer->head]);
+        buffer->entries[buffer->head] = e;
+        buffer->head = (buffer->head + 1) % buffer->allocated;
+        return;
+    }
 
-    if (g_slist_length(buffer->entries) == BUFF_SIZE) {
-        _free_entry(buffer->entries->data);
-        buffer->entries = g_slist_delete_link(buffer->entries, buffer->entries);
+    if (buffer->size == buffer->allocated) {
+        _grow(buffer);
     }
 
-    buffer->entries = g_slist_append(buffer->entries, e);
+    buffer->entries[(buffer->head + buffer->size) % buffer->allocated] = e;
+    buffer->size++;
+}
+
+gboolean
+buffer_push_front(ProfBuff buffer, const char show_char, int pad_indent, GDateTime *time,
+    int flags, theme_item_t theme_item, const char *const from, const char *const message, DeliveryReceipt *receipt)
+{
+    // never evict newer entries to make room for older ones
+    if (buffer->size == buffer->capacity) {
+        return FALSE;
+    }
+
+    if (buffer->size == buffer->allocated) {
+        _grow(buffer);
+    }
+
+    ProfBuffEntry *e = _create_entry(buffer, show_char, pad_indent, time, flags, theme_item, from, message, receipt);
+    buffer->head = (buffer->head - 1 + buffer->allocated) % buffer->allocated;
+    buffer->entries[buffer->head] = e;
+    buffer->size++;
+
+    return TRUE;
 }
 
 gboolean
 buffer_mark_received(ProfBuff buffer, const char *const id)
 {
-    GSList *entries = buffer->entries;
-    while (entries) {
-        ProfBuffEntry *entry = entries->data;
-        if (entry->receipt && g_strcmp0(entry->receipt->id, id) == 0) {
-            if (!entry->receipt->received) {
-                entry->receipt->received = TRUE;
-                return TRUE;
-            }
-        }
-        entries = g_slist_next(entries);
+    ProfBuffEntry *entry = buffer_yield_entry_by_id(buffer, id);
+    if (entry && !entry->receipt->received) {
+        entry->receipt->received = TRUE;
+        return TRUE;
     }
 
     return FALSE;
@@ -121,23 +163,75 @@ buffer_mark_received(ProfBuff buffer, const char *const id)
 ProfBuffEntry*
 buffer_yield_entry(ProfBuff buffer, int entry)
 {
-    GSList *node = g_slist_nth(buffer->entries, entry);
-    return node->data;
+    if (entry < 0 || entry >= buffer->size) {
+        return NULL;
+    }
+
+    return buffer->entries[(buffer->head + entry) % buffer->allocated];
 }
 
 ProfBuffEntry*
 buffer_yield_entry_by_id(ProfBuff buffer, const char *const id)
 {
-    GSList *entries = buffer->entries;
-    while (entries) {
-        ProfBuffEntry *entry = entries->data;
-        if (entry->receipt && g_strcmp0(entry->receipt->id, id) == 0) {
-            return entry;
+    if (id == NULL) {
+        return NULL;
+    }
+
+    return g_hash_table_lookup(buffer->receipts, id);
+}
+
+static ProfBuffEntry*
+_create_entry(ProfBuff buffer, const char show_char, int pad_indent, GDateTime *time,
+    int flags, theme_item_t theme_item, const char *const from, const char *const message, DeliveryReceipt *receipt)
+{
+    ProfBuffEntry *e = malloc(sizeof(struct prof_buff_entry_t));
+    e->show_char = show_char;
+    e->pad_indent = pad_indent;
+    e->flags = flags;
+    e->theme_item = theme_item;
+    e->time = g_date_time_ref(time);
+    e->from = from ? strdup(from) : NULL;
+    e->message = strdup(message);
+    e->receipt = receipt;
+
+    if (receipt && receipt->id) {
+        // replace rather than insert, the key is owned by the entry
+        g_hash_table_replace(buffer->receipts, receipt->id, e);
+    }
+
+    return e;
+}
+
+static void
+_evict_entry(ProfBuff buffer, ProfBuffEntry *entry)
+{
+    if (entry->receipt && entry->receipt->id) {
+        if (g_hash_table_lookup(buffer->receipts, entry->receipt->id) == entry) {
+            g_hash_table_remove(buffer->receipts, entry->receipt->id);
         }
-        entries = g_slist_next(entries);
+    }
+    _free_entry(entry);
+}
+
+// storage grows geometrically up to capacity, so quiet windows stay small
+static void
+_grow(ProfBuff buffer)
+{
+    int new_allocated = buffer->allocated == 0 ? BUFF_INITIAL_ALLOC : buffer->allocated * 2;
+    if (new_allocated > buffer->capacity) {
+        new_allocated = buffer->capacity;
+    }
+
+    ProfBuffEntry **new_entries = malloc(sizeof(ProfBuffEntry*) * new_allocated);
+    int i;
+    for (i = 0; i < buffer->size; i++) {
+        new_entries[i] = buffer->entries[(buffer->head + i) % buffer->allocated];
     }
 
-    return NULL;
+    free(buffer->entries);
+    buffer->entries = new_entries;
+    buffer->allocated = new_allocated;
+    buffer->head = 0;
 }
 
 static void
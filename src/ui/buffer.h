@@ -58,11 +58,17 @@ typedef struct prof_buff_entry_t {
 
 typedef struct prof_buff_t *ProfBuff;
 
-ProfBuff buffer_create();
+// default number of lines kept in a window's scrollback
+#define BUFF_SIZE 1200
+
+ProfBuff buffer_create(int capacity);
 void buffer_free(ProfBuff buffer);
 void buffer_push(ProfBuff buffer, const char show_char, int pad_indent, GDateTime *time, int flags, theme_item_t theme_item,
     const char *const from, const char *const message, DeliveryReceipt *receipt);
+gboolean buffer_push_front(ProfBuff buffer, const char show_char, int pad_indent, GDateTime *time, int flags,
+    theme_item_t theme_item, const char *const from, const char *const message, DeliveryReceipt *receipt);
 int buffer_size(ProfBuff buffer);
+int buffer_capacity(ProfBuff buffer);
 ProfBuffEntry* buffer_yield_entry(ProfBuff buffer, int entry);
 ProfBuffEntry* buffer_yield_entry_by_id(ProfBuff buffer, const char *const id);
 gboolean buffer_mark_received(ProfBuff buffer, const char *const id);
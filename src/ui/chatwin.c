@@ -51,7 +51,10 @@
 #include "otr/otr.h"
 #endif
 
+#define CHATWIN_HISTORY_PAGE 100
+
 static void _chatwin_history(ProfChatWin *chatwin, const char *const contact);
+static gboolean _chatwin_history_line(ProfChatWin *chatwin, const char *const line, gboolean front);
 
 ProfChatWin*
 chatwin_new(const char *const barejid)
@@ -446,27 +449,91 @@ _chatwin_history(ProfChatWin *chatwin, const char *const contact)
 {
     if (!chatwin->history_shown) {
         Jid *jid = jid_create(connection_get_fulljid());
-        GSList *history = chat_log_get_previous(jid->barejid, contact);
+        chatwin->history = chat_log_history_new(jid->barejid, contact);
         jid_destroy(jid);
+
+        GSList *history = chat_log_history_previous(chatwin->history, CHATWIN_HISTORY_PAGE);
         GSList *curr = history;
         while (curr) {
-            char *line = curr->data;
-            // entry
-            if (line[2] == ':') {
-                char hh[3]; memcpy(hh, &line[0], 2); hh[2] = '\0'; int ihh = atoi(hh);
-                char mm[3]; memcpy(mm, &line[3], 2); mm[2] = '\0'; int imm = atoi(mm);
-                char ss[3]; memcpy(ss, &line[6], 2); ss[2] = '\0'; int iss = atoi(ss);
-                GDateTime *timestamp = g_date_time_new_local(2000, 1, 1, ihh, imm, iss);
-                win_print((ProfWin*)chatwin, '-', 0, timestamp, NO_COLOUR_DATE, 0, "", curr->data+11);
-                g_date_time_unref(timestamp);
-            // header
-            } else {
-                win_print((ProfWin*)chatwin, '-', 0, NULL, 0, 0, "", curr->data);
-            }
+            _chatwin_history_line(chatwin, curr->data, FALSE);
             curr = g_slist_next(curr);
         }
         chatwin->history_shown = TRUE;
 
-        g_slist_free_full(history, free);
+        g_slist_free_full(history, g_free);
     }
 }
+
+gboolean
+chatwin_history_page_up(ProfChatWin *chatwin)
+{
+    assert(chatwin != NULL);
+
+    if (chatwin->history == NULL || chat_log_history_finished(chatwin->history)) {
+        return FALSE;
+    }
+
+    // only read as many lines as the window buffer can still hold, older
+    // entries are never evicted to make room so a page must fit whole
+    ProfBuff buffer = ((ProfWin*)chatwin)->layout->buffer;
+    int room = buffer_capacity(buffer) - buffer_size(buffer);
+    if (room <= 0) {
+        // window buffer is full, nothing older can be shown
+        chat_log_history_free(chatwin->history);
+        chatwin->history = NULL;
+        return FALSE;
+    }
+
+    int count = room < CHATWIN_HISTORY_PAGE ? room : CHATWIN_HISTORY_PAGE;
+    GSList *history = chat_log_history_previous(chatwin->history, count);
+    if (history == NULL) {
+        return FALSE;
+    }
+
+    // older lines are added newest first, above the existing entries
+    history = g_slist_reverse(history);
+    gboolean added = FALSE;
+    GSList *curr = history;
+    while (curr) {
+        if (_chatwin_history_line(chatwin, curr->data, TRUE)) {
+            added = TRUE;
+        }
+        curr = g_slist_next(curr);
+    }
+    g_slist_free_full(history, g_free);
+
+    if (added) {
+        win_redraw((ProfWin*)chatwin);
+    }
+
+    return added;
+}
+
+static gboolean
+_chatwin_history_line(ProfChatWin *chatwin, const char *const line, gboolean front)
+{
+    gboolean added = TRUE;
+
+    // entry
+    if (strlen(line) >= 11 && line[2] == ':') {
+        char hh[3]; memcpy(hh, &line[0], 2); hh[2] = '\0'; int ihh = atoi(hh);
+        char mm[3]; memcpy(mm, &line[3], 2); mm[2] = '\0'; int imm = atoi(mm);
+        char ss[3]; memcpy(ss, &line[6], 2); ss[2] = '\0'; int iss = atoi(ss);
+        GDateTime *timestamp = g_date_time_new_local(2000, 1, 1, ihh, imm, iss);
+        if (front) {
+            added = win_print_front((ProfWin*)chatwin, '-', 0, timestamp, NO_COLOUR_DATE, 0, "", line+11);
+        } else {
+            win_print((ProfWin*)chatwin, '-', 0, timestamp, NO_COLOUR_DATE, 0, "", line+11);
+        }
+        g_date_time_unref(timestamp);
+    // header
+    } else {
+        if (front) {
+            added = win_print_front((ProfWin*)chatwin, '-', 0, NULL, 0, 0, "", line);
+        } else {
+            win_print((ProfWin*)chatwin, '-', 0, NULL, 0, 0, "", line);
+        }
+    }
+
+    return added;
+}
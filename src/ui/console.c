@@ -1140,6 +1140,15 @@ cons_wrap_setting(void)
         cons_show("Word wrap (/wrap)                   : OFF");
 }
 
+void
+cons_fuzzy_setting(void)
+{
+    if (prefs_get_boolean(PREF_COMPLETION_FUZZY))
+        cons_show("Fuzzy completion (/fuzzy)           : ON");
+    else
+        cons_show("Fuzzy completion (/fuzzy)           : OFF");
+}
+
 void
 cons_winstidy_setting(void)
 {
@@ -1537,6 +1546,7 @@ cons_show_ui_prefs(void)
     cons_flash_setting();
     cons_splash_setting();
     cons_wrap_setting();
+    cons_fuzzy_setting();
     cons_winstidy_setting();
     cons_time_setting();
     cons_resource_setting();
@@ -1549,6 +1559,7 @@ cons_show_ui_prefs(void)
     cons_encwarn_setting();
     cons_presence_setting();
     cons_inpblock_setting();
+    cons_maxfps_setting();
     cons_tlsshow_setting();
 
     cons_alert();
@@ -1753,11 +1764,18 @@ cons_inpblock_setting(void)
     }
 }
 
+void
+cons_maxfps_setting(void)
+{
+    cons_show("Max redraw rate (/maxfps)           : %d frames per second", prefs_get_max_fps());
+}
+
 void
 cons_log_setting(void)
 {
     cons_show("Log file location           : %s", get_log_file_location());
     cons_show("Max log size (/log maxsize) : %d bytes", prefs_get_max_log_size());
+    cons_show("Chat log flush (/log flush) : %d seconds", prefs_get_chlog_flush());
 
     if (prefs_get_boolean(PREF_LOG_ROTATE))
         cons_show("Log rotation (/log rotate)  : ON");
@@ -1768,6 +1786,11 @@ cons_log_setting(void)
         cons_show("Shared log (/log shared)    : ON");
     else
         cons_show("Shared log (/log shared)    : OFF");
+
+    ChatLogStats stats;
+    chat_log_get_stats(&stats);
+    cons_show("Chat log queue              : %u queued, %u peak, %u stalls, %u written, %u errors",
+        stats.queued, stats.high_water, stats.stalls, stats.written, stats.errors);
 }
 
 void
@@ -43,6 +43,7 @@
 #include <assert.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
+#include <fcntl.h>
 
 #include <glib.h>
 
@@ -84,16 +85,30 @@ static int inp_size;
 static gboolean perform_resize = FALSE;
 static GTimer *ui_idle_time;
 
+// written to by the SIGWINCH handler so the main loop wakes up to resize
+static int resize_pipe[2] = { -1, -1 };
+
+// time since the last frame was written to the terminal, and where the
+// cursor was left, frames are only written when the virtual screen changed
+static GTimer *frame_timer;
+static int frame_cury = -1;
+static int frame_curx = -1;
+
 #ifdef HAVE_LIBXSS
 static Display *display;
 #endif
 
 static void _ui_draw_term_title(void);
+static void _ui_resize_pipe_init(void);
+static void _ui_resize_pipe_drain(void);
+static gboolean _ui_frame_damaged(void);
 
 void
 ui_init(void)
 {
     log_info("Initialising UI");
+    _ui_resize_pipe_init();
+    frame_timer = g_timer_new();
     initscr();
     nonl();
     cbreak();
@@ -121,16 +136,36 @@ void
 ui_sigwinch_handler(int sig)
 {
     perform_resize = TRUE;
+    if (resize_pipe[1] != -1) {
+        ssize_t res = write(resize_pipe[1], "r", 1);
+        (void)res;
+    }
+}
+
+int
+ui_get_resize_fd(void)
+{
+    return resize_pipe[0];
 }
 
 void
 ui_update(void)
 {
+    if (perform_resize) {
+        signal(SIGWINCH, SIG_IGN);
+        _ui_resize_pipe_drain();
+        ui_resize();
+        perform_resize = FALSE;
+        signal(SIGWINCH, ui_sigwinch_handler);
+    }
+
     ProfWin *current = wins_get_current();
     if (current->layout->paged == 0) {
         win_move_to_end(current);
     }
 
+    rosterwin_update();
+    occupantswin_update();
     win_update_virtual(current);
 
     if (prefs_get_boolean(PREF_TITLEBAR_SHOW)) {
@@ -139,14 +174,31 @@ ui_update(void)
     title_bar_update_virtual();
     status_bar_update_virtual();
     inp_put_back();
-    doupdate();
 
-    if (perform_resize) {
-        signal(SIGWINCH, SIG_IGN);
-        ui_resize();
-        perform_resize = FALSE;
-        signal(SIGWINCH, ui_sigwinch_handler);
+    if (ui_frame_timeout() == 0) {
+        doupdate();
+        frame_cury = getcury(newscr);
+        frame_curx = getcurx(newscr);
+        g_timer_start(frame_timer);
+    }
+}
+
+// milliseconds until a pending frame may be written to the terminal,
+// -1 when nothing has changed since the last frame
+gint
+ui_frame_timeout(void)
+{
+    if (!_ui_frame_damaged()) {
+        return -1;
+    }
+
+    gdouble frame_secs = 1.0 / prefs_get_max_fps();
+    gdouble remaining = frame_secs - g_timer_elapsed(frame_timer, NULL);
+    if (remaining <= 0) {
+        return 0;
     }
+
+    return remaining * 1000 + 1;
 }
 
 unsigned long
@@ -184,6 +236,16 @@ ui_close(void)
     wins_destroy();
     inp_close();
     endwin();
+
+    g_timer_destroy(frame_timer);
+    frame_timer = NULL;
+
+    if (resize_pipe[0] != -1) {
+        close(resize_pipe[0]);
+        close(resize_pipe[1]);
+        resize_pipe[0] = -1;
+        resize_pipe[1] = -1;
+    }
 }
 
 void
@@ -1347,3 +1409,44 @@ ui_status_bar_new(const int win)
 {
     status_bar_new(win);
 }
+
+static void
+_ui_resize_pipe_init(void)
+{
+    if (pipe(resize_pipe) != 0) {
+        log_error("Failed to create resize pipe, terminal resizes will wait for the next input timeout");
+        resize_pipe[0] = -1;
+        resize_pipe[1] = -1;
+        return;
+    }
+
+    int i;
+    for (i = 0; i < 2; i++) {
+        int flags = fcntl(resize_pipe[i], F_GETFL);
+        fcntl(resize_pipe[i], F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+static void
+_ui_resize_pipe_drain(void)
+{
+    if (resize_pipe[0] == -1) {
+        return;
+    }
+
+    char buf[16];
+    while (read(resize_pipe[0], buf, sizeof(buf)) > 0);
+}
+
+// the *noutrefresh calls only mark cells of the virtual screen that differ
+// from the previous frame, so a touched virtual screen or a moved cursor
+// means the terminal is out of date
+static gboolean
+_ui_frame_damaged(void)
+{
+    if (is_wintouched(newscr)) {
+        return TRUE;
+    }
+
+    return getcury(newscr) != frame_cury || getcurx(newscr) != frame_curx;
+}
@@ -36,7 +36,7 @@
 #include "config.h"
 
 #include <stdio.h>
-#include <sys/select.h>
+#include <poll.h>
 #include <stdlib.h>
 #include <string.h>
 #include <wchar.h>
@@ -71,21 +71,24 @@
 #include "xmpp/roster_list.h"
 #include "xmpp/chat_state.h"
 
+#ifdef HAVE_LIBGPGME
+#include "pgp/gpg.h"
+#endif
+
 static WINDOW *inp_win;
 static int pad_start = 0;
 
-static struct timeval p_rl_timeout;
-/* Timeout in ms. Shows how long select() may block. */
+/* Timeout in ms. Shows how long the input poll may block while connected. */
 static gint inp_timeout = 0;
 static gint no_input_count = 0;
 
 static FILE *discard;
-static fd_set fds;
 static int r;
 static char *inp_line = NULL;
 static gboolean get_password = FALSE;
 
 static void _inp_win_update_virtual(void);
+static gint _inp_wait_timeout(void);
 static int _inp_printable(const wint_t ch);
 static void _inp_win_handle_scroll(void);
 static int _inp_offset_to_col(char *str, int offset);
@@ -139,17 +142,32 @@ create_input_window(void)
 }
 
 char*
-inp_readline(void)
+inp_readline(gint timeout)
 {
     free(inp_line);
     inp_line = NULL;
-    p_rl_timeout.tv_sec = inp_timeout / 1000;
-    p_rl_timeout.tv_usec = inp_timeout % 1000 * 1000;
-    FD_ZERO(&fds);
-    FD_SET(fileno(rl_instream), &fds);
+
+    // wait for a key press, a terminal resize, stderr output, pgp results, or the timeout
+    struct pollfd fds[4];
+    fds[0].fd = fileno(rl_instream);
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = ui_get_resize_fd();
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+    fds[2].fd = log_stderr_get_fd();
+    fds[2].events = POLLIN;
+    fds[2].revents = 0;
+    fds[3].fd = -1;
+#ifdef HAVE_LIBGPGME
+    fds[3].fd = p_gpg_results_fd();
+#endif
+    fds[3].events = POLLIN;
+    fds[3].revents = 0;
+
     errno = 0;
     pthread_mutex_unlock(&lock);
-    r = select(FD_SETSIZE, &fds, NULL, NULL, &p_rl_timeout);
+    r = poll(fds, 4, timeout);
     pthread_mutex_lock(&lock);
     if (r < 0) {
         if (errno != EINTR) {
@@ -159,7 +177,7 @@ inp_readline(void)
         return NULL;
     }
 
-    if (FD_ISSET(fileno(rl_instream), &fds)) {
+    if (fds[0].revents & POLLIN) {
         rl_callback_read_char();
 
         if (rl_line_buffer &&
@@ -230,6 +248,24 @@ inp_nonblocking(gboolean reset)
     }
 }
 
+gint
+inp_get_timeout(void)
+{
+    return inp_timeout;
+}
+
+// wait no longer than the next frame when one is pending
+static gint
+_inp_wait_timeout(void)
+{
+    gint frame_timeout = ui_frame_timeout();
+    if (frame_timeout != -1 && frame_timeout < inp_timeout) {
+        return frame_timeout;
+    }
+
+    return inp_timeout;
+}
+
 void
 inp_close(void)
 {
@@ -246,7 +282,7 @@ inp_get_line(void)
     doupdate();
     char *line = NULL;
     while (!line) {
-        line = inp_readline();
+        line = inp_readline(_inp_wait_timeout());
         ui_update();
     }
     status_bar_clear();
@@ -263,7 +299,7 @@ inp_get_password(void)
     char *password = NULL;
     get_password = TRUE;
     while (!password) {
-        password = inp_readline();
+        password = inp_readline(_inp_wait_timeout());
         ui_update();
     }
     get_password = FALSE;
@@ -196,6 +196,23 @@ notify_remind(void)
     }
 }
 
+// milliseconds until the next reminder is due, -1 when reminders are off
+gint
+notify_remind_timeout(void)
+{
+    gint remind_period = prefs_get_notify_remind();
+    if (remind_period <= 0) {
+        return -1;
+    }
+
+    gdouble remaining = remind_period - g_timer_elapsed(remind_timer, NULL);
+    if (remaining <= 0) {
+        return 0;
+    }
+
+    return remaining * 1000 + 1;
+}
+
 void
 notify(const char *const message, int timeout, const char *const category)
 {
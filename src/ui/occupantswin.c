@@ -33,12 +33,16 @@
  */
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "config/preferences.h"
 #include "ui/ui.h"
 #include "ui/window.h"
 #include "ui/window_list.h"
 
+static GHashTable *pending_rooms;
+
 static void
 _occuptantswin_occupant(ProfLayoutSplit *layout, Occupant *occupant, gboolean showjid)
 {
@@ -61,8 +65,18 @@ _occuptantswin_occupant(ProfLayoutSplit *layout, Occupant *occupant, gboolean sh
     wattroff(layout->subwin, theme_attrs(presence_colour));
 }
 
-void
-occupantswin_occupants(const char *const roomjid)
+static void
+_occupantswin_occupants_list(ProfLayoutSplit *layout, GList *occupants, gboolean showjid)
+{
+    GList *curr = occupants;
+    while (curr) {
+        _occuptantswin_occupant(layout, curr->data, showjid);
+        curr = g_list_next(curr);
+    }
+}
+
+static void
+_occupantswin_draw(const char *const roomjid)
 {
     ProfMucWin *mucwin = wins_get_muc(roomjid);
     if (mucwin) {
@@ -74,54 +88,88 @@ occupantswin_occupants(const char *const roomjid)
             werase(layout->subwin);
 
             if (prefs_get_boolean(PREF_MUC_PRIVILEGES)) {
-                wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                win_sub_print(layout->subwin, " -Moderators", TRUE, FALSE, 0);
-                wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                GList *roster_curr = occupants;
+                // split by role in one pass, each list keeps the roster order
+                GList *moderators = NULL;
+                GList *participants = NULL;
+                GList *visitors = NULL;
+                GList *roster_curr = g_list_last(occupants);
                 while (roster_curr) {
                     Occupant *occupant = roster_curr->data;
                     if (occupant->role == MUC_ROLE_MODERATOR) {
-                        _occuptantswin_occupant(layout, occupant, mucwin->showjid);
+                        moderators = g_list_prepend(moderators, occupant);
+                    } else if (occupant->role == MUC_ROLE_PARTICIPANT) {
+                        participants = g_list_prepend(participants, occupant);
+                    } else if (occupant->role == MUC_ROLE_VISITOR) {
+                        visitors = g_list_prepend(visitors, occupant);
                     }
-                    roster_curr = g_list_next(roster_curr);
+                    roster_curr = g_list_previous(roster_curr);
                 }
 
+                wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
+                win_sub_print(layout->subwin, " -Moderators", TRUE, FALSE, 0);
+                wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
+                _occupantswin_occupants_list(layout, moderators, mucwin->showjid);
+
                 wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
                 win_sub_print(layout->subwin, " -Participants", TRUE, FALSE, 0);
                 wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                roster_curr = occupants;
-                while (roster_curr) {
-                    Occupant *occupant = roster_curr->data;
-                    if (occupant->role == MUC_ROLE_PARTICIPANT) {
-                        _occuptantswin_occupant(layout, occupant, mucwin->showjid);
-                    }
-                    roster_curr = g_list_next(roster_curr);
-                }
+                _occupantswin_occupants_list(layout, participants, mucwin->showjid);
 
                 wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
                 win_sub_print(layout->subwin, " -Visitors", TRUE, FALSE, 0);
                 wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                roster_curr = occupants;
-                while (roster_curr) {
-                    Occupant *occupant = roster_curr->data;
-                    if (occupant->role == MUC_ROLE_VISITOR) {
-                        _occuptantswin_occupant(layout, occupant, mucwin->showjid);
-                    }
-                    roster_curr = g_list_next(roster_curr);
-                }
+                _occupantswin_occupants_list(layout, visitors, mucwin->showjid);
+
+                g_list_free(moderators);
+                g_list_free(participants);
+                g_list_free(visitors);
             } else {
                 wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
                 win_sub_print(layout->subwin, " -Occupants\n", TRUE, FALSE, 0);
                 wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                GList *roster_curr = occupants;
-                while (roster_curr) {
-                    Occupant *occupant = roster_curr->data;
-                    _occuptantswin_occupant(layout, occupant, mucwin->showjid);
-                    roster_curr = g_list_next(roster_curr);
-                }
+                _occupantswin_occupants_list(layout, occupants, mucwin->showjid);
             }
         }
 
         g_list_free(occupants);
     }
 }
+
+// rooms are redrawn once by occupantswin_update, however many presences
+// arrived since the last ui update
+void
+occupantswin_occupants(const char *const roomjid)
+{
+    // occupants arriving while joining are drawn once the roster is complete
+    if (!muc_roster_complete(roomjid)) {
+        return;
+    }
+
+    if (pending_rooms == NULL) {
+        pending_rooms = g_hash_table_new_full(g_str_hash, g_str_equal, free, NULL);
+    }
+
+    if (!g_hash_table_lookup(pending_rooms, roomjid)) {
+        g_hash_table_insert(pending_rooms, strdup(roomjid), GINT_TO_POINTER(1));
+    }
+}
+
+void
+occupantswin_update(void)
+{
+    if (pending_rooms == NULL) {
+        return;
+    }
+
+    GHashTable *rooms = pending_rooms;
+    pending_rooms = NULL;
+
+    GHashTableIter iter;
+    gpointer roomjid;
+    g_hash_table_iter_init(&iter, rooms);
+    while (g_hash_table_iter_next(&iter, &roomjid, NULL)) {
+        _occupantswin_draw(roomjid);
+    }
+
+    g_hash_table_destroy(rooms);
+}
@@ -49,6 +49,34 @@ typedef enum {
     ROSTER_CONTACT_UNREAD
 } roster_contact_theme_t;
 
+// a row of the roster view model, the drawing ops from one lazy newline to
+// the next and the pad position they were painted at
+typedef struct roster_row_t {
+    GString *ops;
+    int start_y;
+    int start_x;
+    int end_y;
+    int end_x;
+} RosterRow;
+
+// set when the roster needs redrawing, cleared once per ui_update frame
+static gboolean roster_dirty = FALSE;
+
+// rows currently painted in the roster pad, and rows recorded for the next frame
+static GPtrArray *rows_drawn = NULL;
+static GPtrArray *rows_next = NULL;
+static WINDOW *rows_win = NULL;
+static int rows_cols = 0;
+
+static void _rosterwin_draw(void);
+static RosterRow* _rosterwin_row_new(void);
+static void _rosterwin_rows_clear(GPtrArray *rows);
+static void _rosterwin_attron(int attrs);
+static void _rosterwin_attroff(int attrs);
+static void _rosterwin_print(const char *const msg, gboolean wrap, int indent);
+static void _rosterwin_newline(void);
+static void _rosterwin_row_paint(WINDOW *win, RosterRow *row, gboolean attrs_only);
+static void _rosterwin_rows_paint(WINDOW *win);
 static void _rosterwin_contacts_all(ProfLayoutSplit *layout);
 static void _rosterwin_contacts_by_presence(ProfLayoutSplit *layout, const char *const presence, char *title);
 static void _rosterwin_contacts_by_group(ProfLayoutSplit *layout, char *group);
@@ -79,6 +107,23 @@ static int _compare_rooms_unread(ProfMucWin *a, ProfMucWin *b);
 
 void
 rosterwin_roster(void)
+{
+    roster_dirty = TRUE;
+}
+
+void
+rosterwin_update(void)
+{
+    if (!roster_dirty) {
+        return;
+    }
+
+    roster_dirty = FALSE;
+    _rosterwin_draw();
+}
+
+static void
+_rosterwin_draw(void)
 {
     ProfWin *console = wins_get_console();
     if (!console) {
@@ -92,7 +137,12 @@ rosterwin_roster(void)
 
     ProfLayoutSplit *layout = (ProfLayoutSplit*)console->layout;
     assert(layout->memcheck == LAYOUT_SPLIT_MEMCHECK);
-    werase(layout->subwin);
+
+    if (!rows_next) {
+        rows_next = g_ptr_array_new();
+        rows_drawn = g_ptr_array_new();
+    }
+    _rosterwin_rows_clear(rows_next);
 
     char *roomspos = prefs_get_string(PREF_ROSTER_ROOMS_POS);
     if (prefs_get_boolean(PREF_ROSTER_ROOMS) && (g_strcmp0(roomspos, "first") == 0)) {
@@ -189,6 +239,206 @@ rosterwin_roster(void)
     }
 
     prefs_free_string(roomspos);
+
+    _rosterwin_rows_paint(layout->subwin);
+}
+
+static RosterRow*
+_rosterwin_row_new(void)
+{
+    RosterRow *row = malloc(sizeof(RosterRow));
+    row->ops = g_string_new("");
+    row->start_y = 0;
+    row->start_x = 0;
+    row->end_y = 0;
+    row->end_x = 0;
+    g_ptr_array_add(rows_next, row);
+
+    return row;
+}
+
+static void
+_rosterwin_rows_clear(GPtrArray *rows)
+{
+    int i;
+    for (i = 0; i < rows->len; i++) {
+        RosterRow *row = g_ptr_array_index(rows, i);
+        g_string_free(row->ops, TRUE);
+        free(row);
+    }
+    g_ptr_array_set_size(rows, 0);
+}
+
+static GString*
+_rosterwin_ops(void)
+{
+    if (rows_next->len == 0) {
+        _rosterwin_row_new();
+    }
+    RosterRow *row = g_ptr_array_index(rows_next, rows_next->len - 1);
+
+    return row->ops;
+}
+
+static void
+_rosterwin_attron(int attrs)
+{
+    GString *ops = _rosterwin_ops();
+    g_string_append_c(ops, 'A');
+    g_string_append_len(ops, (const char *)&attrs, sizeof(int));
+}
+
+static void
+_rosterwin_attroff(int attrs)
+{
+    GString *ops = _rosterwin_ops();
+    g_string_append_c(ops, 'a');
+    g_string_append_len(ops, (const char *)&attrs, sizeof(int));
+}
+
+static void
+_rosterwin_print(const char *const msg, gboolean wrap, int indent)
+{
+    GString *ops = _rosterwin_ops();
+    g_string_append_c(ops, 'P');
+    g_string_append_c(ops, wrap ? 1 : 0);
+    g_string_append_len(ops, (const char *)&indent, sizeof(int));
+    g_string_append_len(ops, msg, strlen(msg) + 1);
+}
+
+static void
+_rosterwin_newline(void)
+{
+    RosterRow *row = _rosterwin_row_new();
+    g_string_append_c(row->ops, 'N');
+}
+
+// replay a row's ops, skipped rows only replay attributes so the pad is left
+// in the same attribute state as if they had been painted
+static void
+_rosterwin_row_paint(WINDOW *win, RosterRow *row, gboolean attrs_only)
+{
+    const char *op = row->ops->str;
+    const char *end = op + row->ops->len;
+    int val;
+
+    while (op < end) {
+        switch (*op++) {
+        case 'A':
+            memcpy(&val, op, sizeof(int));
+            op += sizeof(int);
+            wattron(win, val);
+            break;
+        case 'a':
+            memcpy(&val, op, sizeof(int));
+            op += sizeof(int);
+            wattroff(win, val);
+            break;
+        case 'N':
+            if (!attrs_only) {
+                win_sub_newline_lazy(win);
+            }
+            break;
+        case 'P':
+        {
+            gboolean wrap = *op++;
+            memcpy(&val, op, sizeof(int));
+            op += sizeof(int);
+            if (!attrs_only) {
+                win_sub_print(win, (char *)op, FALSE, wrap, val);
+            }
+            op += strlen(op) + 1;
+            break;
+        }
+        default:
+            return;
+        }
+    }
+}
+
+// paint the recorded frame, rows equal to the row drawn at the same position
+// last frame are left alone, everything after the first row that changes
+// height is repainted
+static void
+_rosterwin_rows_paint(WINDOW *win)
+{
+    int y = 0;
+    int x = 0;
+
+    // a new or resized pad, or one drawn over, gets a full repaint
+    if (rows_drawn->len > 0) {
+        RosterRow *last = g_ptr_array_index(rows_drawn, rows_drawn->len - 1);
+        y = last->end_y;
+        x = last->end_x;
+    }
+    if (win != rows_win || getmaxx(win) != rows_cols || getcury(win) != y || getcurx(win) != x) {
+        werase(win);
+        _rosterwin_rows_clear(rows_drawn);
+        rows_win = win;
+        rows_cols = getmaxx(win);
+    }
+
+    y = 0;
+    x = 0;
+    gboolean shifted = FALSE;
+    int i;
+    for (i = 0; i < rows_next->len; i++) {
+        RosterRow *row = g_ptr_array_index(rows_next, i);
+        RosterRow *old = NULL;
+        if (!shifted && i < rows_drawn->len) {
+            old = g_ptr_array_index(rows_drawn, i);
+            if (old->start_y != y || old->start_x != x) {
+                old = NULL;
+            }
+        }
+        if (!old && !shifted) {
+            wmove(win, y, x);
+            wclrtobot(win);
+            shifted = TRUE;
+        }
+
+        row->start_y = y;
+        row->start_x = x;
+
+        if (old && old->ops->len == row->ops->len && memcmp(old->ops->str, row->ops->str, row->ops->len) == 0) {
+            _rosterwin_row_paint(win, row, TRUE);
+            y = old->end_y;
+            x = old->end_x;
+        } else {
+            if (old) {
+                wmove(win, old->start_y, old->start_x);
+                wclrtoeol(win);
+                int old_y;
+                for (old_y = old->start_y + 1; old_y <= old->end_y; old_y++) {
+                    wmove(win, old_y, 0);
+                    wclrtoeol(win);
+                }
+            }
+            wmove(win, y, x);
+            _rosterwin_row_paint(win, row, FALSE);
+            getyx(win, y, x);
+
+            // the rows below moved, clear them to be repainted
+            if (old && (old->end_y != y || old->end_x != x)) {
+                wclrtobot(win);
+                shifted = TRUE;
+            }
+        }
+
+        row->end_y = y;
+        row->end_x = x;
+    }
+
+    if (!shifted && rows_next->len < rows_drawn->len) {
+        wmove(win, y, x);
+        wclrtobot(win);
+    }
+    wmove(win, y, x);
+
+    GPtrArray *drawn = rows_drawn;
+    rows_drawn = rows_next;
+    rows_next = drawn;
+    _rosterwin_rows_clear(rows_next);
 }
 
 static void
@@ -311,7 +561,7 @@ _rosterwin_unsubscribed_item(ProfLayoutSplit *layout, ProfChatWin *chatwin)
 
     theme_item_t presence_colour = _get_roster_theme(theme_type, presence);
 
-    wattron(layout->subwin, theme_attrs(presence_colour));
+    _rosterwin_attron(theme_attrs(presence_colour));
     GString *msg = g_string_new(" ");
     int indent = prefs_get_roster_contact_indent();
     int current_indent = 0;
@@ -339,11 +589,11 @@ _rosterwin_unsubscribed_item(ProfLayoutSplit *layout, ProfChatWin *chatwin)
     }
     prefs_free_string(unreadpos);
 
-    win_sub_newline_lazy(layout->subwin);
+    _rosterwin_newline();
     gboolean wrap = prefs_get_boolean(PREF_ROSTER_WRAP);
-    win_sub_print(layout->subwin, msg->str, FALSE, wrap, current_indent);
+    _rosterwin_print(msg->str, wrap, current_indent);
     g_string_free(msg, TRUE);
-    wattroff(layout->subwin, theme_attrs(presence_colour));
+    _rosterwin_attroff(theme_attrs(presence_colour));
 }
 
 static void
@@ -368,7 +618,7 @@ _rosterwin_contact(ProfLayoutSplit *layout, PContact contact)
 
     theme_item_t presence_colour = _get_roster_theme(theme_type, presence);
 
-    wattron(layout->subwin, theme_attrs(presence_colour));
+    _rosterwin_attron(theme_attrs(presence_colour));
     GString *msg = g_string_new(" ");
     int indent = prefs_get_roster_contact_indent();
     int current_indent = 0;
@@ -400,11 +650,11 @@ _rosterwin_contact(ProfLayoutSplit *layout, PContact contact)
     }
     prefs_free_string(unreadpos);
 
-    win_sub_newline_lazy(layout->subwin);
+    _rosterwin_newline();
     gboolean wrap = prefs_get_boolean(PREF_ROSTER_WRAP);
-    win_sub_print(layout->subwin, msg->str, FALSE, wrap, current_indent);
+    _rosterwin_print(msg->str, wrap, current_indent);
     g_string_free(msg, TRUE);
-    wattroff(layout->subwin, theme_attrs(presence_colour));
+    _rosterwin_attroff(theme_attrs(presence_colour));
 
     if (prefs_get_boolean(PREF_ROSTER_RESOURCE)) {
         _rosterwin_resources(layout, contact, current_indent, theme_type, unread);
@@ -412,10 +662,10 @@ _rosterwin_contact(ProfLayoutSplit *layout, PContact contact)
         if (unread > 0) {
             GString *unreadmsg = g_string_new("");
             g_string_append_printf(unreadmsg, " (%d)", unread);
-            wattron(layout->subwin, theme_attrs(presence_colour));
-            win_sub_print(layout->subwin, unreadmsg->str, FALSE, wrap, current_indent);
+            _rosterwin_attron(theme_attrs(presence_colour));
+            _rosterwin_print(unreadmsg->str, wrap, current_indent);
             g_string_free(unreadmsg, TRUE);
-            wattroff(layout->subwin, theme_attrs(presence_colour));
+            _rosterwin_attroff(theme_attrs(presence_colour));
         }
 
         _rosterwin_presence(layout, presence, status, current_indent);
@@ -448,13 +698,13 @@ _rosterwin_presence(ProfLayoutSplit *layout, const char *presence, const char *s
     if (by_presence) {
         if (status && prefs_get_boolean(PREF_ROSTER_STATUS)) {
 
-            wattron(layout->subwin, theme_attrs(colour));
+            _rosterwin_attron(theme_attrs(colour));
             if (presence_indent == -1) {
                 GString *msg = g_string_new("");
                 g_string_append_printf(msg, ": \"%s\"", status);
-                win_sub_print(layout->subwin, msg->str, FALSE, wrap, current_indent);
+                _rosterwin_print(msg->str, wrap, current_indent);
                 g_string_free(msg, TRUE);
-                wattroff(layout->subwin, theme_attrs(colour));
+                _rosterwin_attroff(theme_attrs(colour));
             } else {
                 GString *msg = g_string_new(" ");
                 while (current_indent > 0) {
@@ -462,16 +712,16 @@ _rosterwin_presence(ProfLayoutSplit *layout, const char *presence, const char *s
                     current_indent--;
                 }
                 g_string_append_printf(msg, "\"%s\"", status);
-                win_sub_newline_lazy(layout->subwin);
-                win_sub_print(layout->subwin, msg->str, FALSE, wrap, current_indent);
+                _rosterwin_newline();
+                _rosterwin_print(msg->str, wrap, current_indent);
                 g_string_free(msg, TRUE);
-                wattroff(layout->subwin, theme_attrs(colour));
+                _rosterwin_attroff(theme_attrs(colour));
             }
         }
 
     // show both presence and status when not grouped by presence
     } else if (prefs_get_boolean(PREF_ROSTER_PRESENCE) || (status && prefs_get_boolean(PREF_ROSTER_STATUS))) {
-        wattron(layout->subwin, theme_attrs(colour));
+        _rosterwin_attron(theme_attrs(colour));
         if (presence_indent == -1) {
             GString *msg = g_string_new("");
             if (prefs_get_boolean(PREF_ROSTER_PRESENCE)) {
@@ -482,9 +732,9 @@ _rosterwin_presence(ProfLayoutSplit *layout, const char *presence, const char *s
             } else if (status && prefs_get_boolean(PREF_ROSTER_STATUS)) {
                 g_string_append_printf(msg, ": \"%s\"", status);
             }
-            win_sub_print(layout->subwin, msg->str, FALSE, wrap, current_indent);
+            _rosterwin_print(msg->str, wrap, current_indent);
             g_string_free(msg, TRUE);
-            wattroff(layout->subwin, theme_attrs(colour));
+            _rosterwin_attroff(theme_attrs(colour));
         } else {
             GString *msg = g_string_new(" ");
             while (current_indent > 0) {
@@ -499,10 +749,10 @@ _rosterwin_presence(ProfLayoutSplit *layout, const char *presence, const char *s
             } else if (status && prefs_get_boolean(PREF_ROSTER_STATUS)) {
                 g_string_append_printf(msg, "\"%s\"", status);
             }
-            win_sub_newline_lazy(layout->subwin);
-            win_sub_print(layout->subwin, msg->str, FALSE, wrap, current_indent);
+            _rosterwin_newline();
+            _rosterwin_print(msg->str, wrap, current_indent);
             g_string_free(msg, TRUE);
-            wattroff(layout->subwin, theme_attrs(colour));
+            _rosterwin_attroff(theme_attrs(colour));
         }
     }
 }
@@ -522,7 +772,7 @@ _rosterwin_resources(ProfLayoutSplit *layout, PContact contact, int current_inde
             const char *resource_presence = string_from_resource_presence(resource->presence);
             theme_item_t resource_presence_colour = _get_roster_theme(theme_type, resource_presence);
 
-            wattron(layout->subwin, theme_attrs(resource_presence_colour));
+            _rosterwin_attron(theme_attrs(resource_presence_colour));
             GString *msg = g_string_new("");
             char ch = prefs_get_roster_resource_char();
             if (ch) {
@@ -542,9 +792,9 @@ _rosterwin_resources(ProfLayoutSplit *layout, PContact contact, int current_inde
             prefs_free_string(unreadpos);
 
             gboolean wrap = prefs_get_boolean(PREF_ROSTER_WRAP);
-            win_sub_print(layout->subwin, msg->str, FALSE, wrap, 0);
+            _rosterwin_print(msg->str, wrap, 0);
             g_string_free(msg, TRUE);
-            wattroff(layout->subwin, theme_attrs(resource_presence_colour));
+            _rosterwin_attroff(theme_attrs(resource_presence_colour));
 
             if (prefs_get_boolean(PREF_ROSTER_PRESENCE) || prefs_get_boolean(PREF_ROSTER_STATUS)) {
                 _rosterwin_presence(layout, resource_presence, resource->status, current_indent);
@@ -562,9 +812,9 @@ _rosterwin_resources(ProfLayoutSplit *layout, PContact contact, int current_inde
                 const char *presence = p_contact_presence(contact);
                 theme_item_t presence_colour = _get_roster_theme(theme_type, presence);
 
-                wattron(layout->subwin, theme_attrs(presence_colour));
-                win_sub_print(layout->subwin, unreadmsg->str, FALSE, wrap, current_indent);
-                wattroff(layout->subwin, theme_attrs(presence_colour));
+                _rosterwin_attron(theme_attrs(presence_colour));
+                _rosterwin_print(unreadmsg->str, wrap, current_indent);
+                _rosterwin_attroff(theme_attrs(presence_colour));
             }
             prefs_free_string(unreadpos);
 
@@ -579,7 +829,7 @@ _rosterwin_resources(ProfLayoutSplit *layout, PContact contact, int current_inde
                 const char *resource_presence = string_from_resource_presence(resource->presence);
                 theme_item_t resource_presence_colour = _get_roster_theme(ROSTER_CONTACT, resource_presence);
 
-                wattron(layout->subwin, theme_attrs(resource_presence_colour));
+                _rosterwin_attron(theme_attrs(resource_presence_colour));
                 GString *msg = g_string_new(" ");
                 int this_indent = current_indent;
                 while (this_indent > 0) {
@@ -594,10 +844,10 @@ _rosterwin_resources(ProfLayoutSplit *layout, PContact contact, int current_inde
                 if (prefs_get_boolean(PREF_ROSTER_PRIORITY)) {
                     g_string_append_printf(msg, " %d", resource->priority);
                 }
-                win_sub_newline_lazy(layout->subwin);
-                win_sub_print(layout->subwin, msg->str, FALSE, wrap, current_indent);
+                _rosterwin_newline();
+                _rosterwin_print(msg->str, wrap, current_indent);
                 g_string_free(msg, TRUE);
-                wattroff(layout->subwin, theme_attrs(resource_presence_colour));
+                _rosterwin_attroff(theme_attrs(resource_presence_colour));
 
                 if (prefs_get_boolean(PREF_ROSTER_PRESENCE) || prefs_get_boolean(PREF_ROSTER_STATUS)) {
                     _rosterwin_presence(layout, resource_presence, resource->status, current_indent);
@@ -617,9 +867,9 @@ _rosterwin_resources(ProfLayoutSplit *layout, PContact contact, int current_inde
             GString *unreadmsg = g_string_new("");
             g_string_append_printf(unreadmsg, " (%d)", unread);
 
-            wattron(layout->subwin, theme_attrs(presence_colour));
-            win_sub_print(layout->subwin, unreadmsg->str, FALSE, wrap, current_indent);
-            wattroff(layout->subwin, theme_attrs(presence_colour));
+            _rosterwin_attron(theme_attrs(presence_colour));
+            _rosterwin_print(unreadmsg->str, wrap, current_indent);
+            _rosterwin_attroff(theme_attrs(presence_colour));
         }
         prefs_free_string(unreadpos);
         _rosterwin_presence(layout, presence, status, current_indent);
@@ -633,9 +883,9 @@ _rosterwin_resources(ProfLayoutSplit *layout, PContact contact, int current_inde
             const char *presence = p_contact_presence(contact);
             theme_item_t presence_colour = _get_roster_theme(theme_type, presence);
 
-            wattron(layout->subwin, theme_attrs(presence_colour));
-            win_sub_print(layout->subwin, unreadmsg->str, FALSE, wrap, current_indent);
-            wattroff(layout->subwin, theme_attrs(presence_colour));
+            _rosterwin_attron(theme_attrs(presence_colour));
+            _rosterwin_print(unreadmsg->str, wrap, current_indent);
+            _rosterwin_attroff(theme_attrs(presence_colour));
         }
         prefs_free_string(unreadpos);
     }
@@ -729,13 +979,13 @@ _rosterwin_room(ProfLayoutSplit *layout, ProfMucWin *mucwin)
     GString *msg = g_string_new(" ");
 
     if (mucwin->unread_mentions) {
-        wattron(layout->subwin, theme_attrs(THEME_ROSTER_ROOM_MENTION));
+        _rosterwin_attron(theme_attrs(THEME_ROSTER_ROOM_MENTION));
     } else if (mucwin->unread_triggers) {
-        wattron(layout->subwin, theme_attrs(THEME_ROSTER_ROOM_TRIGGER));
+        _rosterwin_attron(theme_attrs(THEME_ROSTER_ROOM_TRIGGER));
     } else if (mucwin->unread > 0) {
-        wattron(layout->subwin, theme_attrs(THEME_ROSTER_ROOM_UNREAD));
+        _rosterwin_attron(theme_attrs(THEME_ROSTER_ROOM_UNREAD));
     } else {
-        wattron(layout->subwin, theme_attrs(THEME_ROSTER_ROOM));
+        _rosterwin_attron(theme_attrs(THEME_ROSTER_ROOM));
     }
 
     int indent = prefs_get_roster_contact_indent();
@@ -770,19 +1020,19 @@ _rosterwin_room(ProfLayoutSplit *layout, ProfMucWin *mucwin)
     }
     prefs_free_string(unreadpos);
 
-    win_sub_newline_lazy(layout->subwin);
+    _rosterwin_newline();
     gboolean wrap = prefs_get_boolean(PREF_ROSTER_WRAP);
-    win_sub_print(layout->subwin, msg->str, FALSE, wrap, current_indent);
+    _rosterwin_print(msg->str, wrap, current_indent);
     g_string_free(msg, TRUE);
 
     if (mucwin->unread_mentions) {
-        wattroff(layout->subwin, theme_attrs(THEME_ROSTER_ROOM_MENTION));
+        _rosterwin_attroff(theme_attrs(THEME_ROSTER_ROOM_MENTION));
     } else if (mucwin->unread_triggers) {
-        wattroff(layout->subwin, theme_attrs(THEME_ROSTER_ROOM_TRIGGER));
+        _rosterwin_attroff(theme_attrs(THEME_ROSTER_ROOM_TRIGGER));
     } else if (mucwin->unread > 0) {
-        wattroff(layout->subwin, theme_attrs(THEME_ROSTER_ROOM_UNREAD));
+        _rosterwin_attroff(theme_attrs(THEME_ROSTER_ROOM_UNREAD));
     } else {
-        wattroff(layout->subwin, theme_attrs(THEME_ROSTER_ROOM));
+        _rosterwin_attroff(theme_attrs(THEME_ROSTER_ROOM));
     }
 
     char *privpref = prefs_get_string(PREF_ROSTER_PRIVATE);
@@ -791,7 +1041,7 @@ _rosterwin_room(ProfLayoutSplit *layout, ProfMucWin *mucwin)
         GList *curr = privs;
         while (curr) {
             ProfPrivateWin *privwin = curr->data;
-            win_sub_newline_lazy(layout->subwin);
+            _rosterwin_newline();
 
             GString *privmsg = g_string_new(" ");
             indent = prefs_get_roster_contact_indent();
@@ -846,9 +1096,9 @@ _rosterwin_room(ProfLayoutSplit *layout, ProfMucWin *mucwin)
                 colour = _get_roster_theme(ROSTER_CONTACT_ACTIVE, presence);
             }
 
-            wattron(layout->subwin, theme_attrs(colour));
-            win_sub_print(layout->subwin, privmsg->str, FALSE, wrap, current_indent);
-            wattroff(layout->subwin, theme_attrs(colour));
+            _rosterwin_attron(theme_attrs(colour));
+            _rosterwin_print(privmsg->str, wrap, current_indent);
+            _rosterwin_attroff(theme_attrs(colour));
 
             g_string_free(privmsg, TRUE);
             curr = g_list_next(curr);
@@ -882,7 +1132,7 @@ _rosterwin_private_chats(ProfLayoutSplit *layout, GList *orphaned_privchats)
         GList *curr = privs;
         while (curr) {
             ProfPrivateWin *privwin = curr->data;
-            win_sub_newline_lazy(layout->subwin);
+            _rosterwin_newline();
 
             GString *privmsg = g_string_new(" ");
             int indent = prefs_get_roster_contact_indent();
@@ -930,9 +1180,9 @@ _rosterwin_private_chats(ProfLayoutSplit *layout, GList *orphaned_privchats)
 
             gboolean wrap = prefs_get_boolean(PREF_ROSTER_WRAP);
 
-            wattron(layout->subwin, theme_attrs(colour));
-            win_sub_print(layout->subwin, privmsg->str, FALSE, wrap, current_indent);
-            wattroff(layout->subwin, theme_attrs(colour));
+            _rosterwin_attron(theme_attrs(colour));
+            _rosterwin_print(privmsg->str, wrap, current_indent);
+            _rosterwin_attroff(theme_attrs(colour));
 
             g_string_free(privmsg, TRUE);
             curr = g_list_next(curr);
@@ -974,7 +1224,7 @@ _compare_rooms_unread(ProfMucWin *a, ProfMucWin *b)
 static void
 _rosterwin_unsubscribed_header(ProfLayoutSplit *layout, GList *wins)
 {
-    win_sub_newline_lazy(layout->subwin);
+    _rosterwin_newline();
 
     GString *header = g_string_new(" ");
     char ch = prefs_get_roster_header_char();
@@ -1010,9 +1260,9 @@ _rosterwin_unsubscribed_header(ProfLayoutSplit *layout, GList *wins)
 
     gboolean wrap = prefs_get_boolean(PREF_ROSTER_WRAP);
 
-    wattron(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
-    win_sub_print(layout->subwin, header->str, FALSE, wrap, 1);
-    wattroff(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
+    _rosterwin_attron(theme_attrs(THEME_ROSTER_HEADER));
+    _rosterwin_print(header->str, wrap, 1);
+    _rosterwin_attroff(theme_attrs(THEME_ROSTER_HEADER));
 
     g_string_free(header, TRUE);
 }
@@ -1020,7 +1270,7 @@ _rosterwin_unsubscribed_header(ProfLayoutSplit *layout, GList *wins)
 static void
 _rosterwin_contacts_header(ProfLayoutSplit *layout, const char *const title, GSList *contacts)
 {
-    win_sub_newline_lazy(layout->subwin);
+    _rosterwin_newline();
 
     GString *header = g_string_new(" ");
     char ch = prefs_get_roster_header_char();
@@ -1060,9 +1310,9 @@ _rosterwin_contacts_header(ProfLayoutSplit *layout, const char *const title, GSL
 
     gboolean wrap = prefs_get_boolean(PREF_ROSTER_WRAP);
 
-    wattron(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
-    win_sub_print(layout->subwin, header->str, FALSE, wrap, 1);
-    wattroff(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
+    _rosterwin_attron(theme_attrs(THEME_ROSTER_HEADER));
+    _rosterwin_print(header->str, wrap, 1);
+    _rosterwin_attroff(theme_attrs(THEME_ROSTER_HEADER));
 
     g_string_free(header, TRUE);
 }
@@ -1070,7 +1320,7 @@ _rosterwin_contacts_header(ProfLayoutSplit *layout, const char *const title, GSL
 static void
 _rosterwin_rooms_header(ProfLayoutSplit *layout, GList *rooms, char *title)
 {
-    win_sub_newline_lazy(layout->subwin);
+    _rosterwin_newline();
     GString *header = g_string_new(" ");
     char ch = prefs_get_roster_header_char();
     if (ch) {
@@ -1120,9 +1370,9 @@ _rosterwin_rooms_header(ProfLayoutSplit *layout, GList *rooms, char *title)
 
     gboolean wrap = prefs_get_boolean(PREF_ROSTER_WRAP);
 
-    wattron(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
-    win_sub_print(layout->subwin, header->str, FALSE, wrap, 1);
-    wattroff(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
+    _rosterwin_attron(theme_attrs(THEME_ROSTER_HEADER));
+    _rosterwin_print(header->str, wrap, 1);
+    _rosterwin_attroff(theme_attrs(THEME_ROSTER_HEADER));
 
     g_string_free(header, TRUE);
 }
@@ -1130,7 +1380,7 @@ _rosterwin_rooms_header(ProfLayoutSplit *layout, GList *rooms, char *title)
 static void
 _rosterwin_private_header(ProfLayoutSplit *layout, GList *privs)
 {
-    win_sub_newline_lazy(layout->subwin);
+    _rosterwin_newline();
 
     GString *title_str = g_string_new(" ");
     char ch = prefs_get_roster_header_char();
@@ -1165,9 +1415,9 @@ _rosterwin_private_header(ProfLayoutSplit *layout, GList *privs)
 
     gboolean wrap = prefs_get_boolean(PREF_ROSTER_WRAP);
 
-    wattron(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
-    win_sub_print(layout->subwin, title_str->str, FALSE, wrap, 1);
-    wattroff(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
+    _rosterwin_attron(theme_attrs(THEME_ROSTER_HEADER));
+    _rosterwin_print(title_str->str, wrap, 1);
+    _rosterwin_attroff(theme_attrs(THEME_ROSTER_HEADER));
 
     g_string_free(title_str, TRUE);
 }
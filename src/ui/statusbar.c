@@ -106,6 +106,28 @@ create_status_bar(void)
     _status_bar_draw();
 }
 
+// milliseconds until the displayed time changes, -1 when the time is not shown
+int
+status_bar_clock_timeout(void)
+{
+    const char *time_pref = prefs_peek_string(PREF_TIME_STATUSBAR);
+    if (time_pref == NULL || g_strcmp0(time_pref, "off") == 0) {
+        return -1;
+    }
+
+    GDateTime *now = g_date_time_new_now_local();
+    gint second = g_date_time_get_second(now);
+    gint millis = g_date_time_get_microsecond(now) / 1000;
+    g_date_time_unref(now);
+
+    if (strstr(time_pref, "%S") || strstr(time_pref, "%T") || strstr(time_pref, "%s") ||
+            strstr(time_pref, "%r") || strstr(time_pref, "%X") || strstr(time_pref, "%c")) {
+        return 1000 - millis;
+    }
+
+    return (60 - second) * 1000 - millis;
+}
+
 void
 status_bar_update_virtual(void)
 {
@@ -131,7 +153,7 @@ status_bar_resize(void)
     wattroff(status_bar, bracket_attrs);
 
     if (message) {
-        char *time_pref = prefs_get_string(PREF_TIME_STATUSBAR);
+        const char *time_pref = prefs_peek_string(PREF_TIME_STATUSBAR);
 
         gchar *date_fmt = NULL;
         if (g_strcmp0(time_pref, "off") == 0) {
@@ -149,7 +171,6 @@ status_bar_resize(void)
         } else {
             mvwprintw(status_bar, 0, 1, message);
         }
-        prefs_free_string(time_pref);
     }
     if (last_time) {
         g_date_time_unref(last_time);
@@ -316,7 +337,7 @@ status_bar_print_message(const char *const msg)
     }
     message = strdup(msg);
 
-    char *time_pref = prefs_get_string(PREF_TIME_STATUSBAR);
+    const char *time_pref = prefs_peek_string(PREF_TIME_STATUSBAR);
     gchar *date_fmt = NULL;
     if (g_strcmp0(time_pref, "off") == 0) {
         date_fmt = g_strdup("");
@@ -332,7 +353,6 @@ status_bar_print_message(const char *const msg)
     } else {
         mvwprintw(status_bar, 0, 1, message);
     }
-    prefs_free_string(time_pref);
 
     int cols = getmaxx(stdscr);
     int bracket_attrs = theme_attrs(THEME_STATUS_BRACKET);
@@ -458,7 +478,7 @@ _status_bar_draw(void)
 
     int bracket_attrs = theme_attrs(THEME_STATUS_BRACKET);
 
-    char *time_pref = prefs_get_string(PREF_TIME_STATUSBAR);
+    const char *time_pref = prefs_peek_string(PREF_TIME_STATUSBAR);
     if (g_strcmp0(time_pref, "off") != 0) {
         gchar *date_fmt = g_date_time_format(last_time, time_pref);
         assert(date_fmt != NULL);
@@ -472,7 +492,6 @@ _status_bar_draw(void)
         wattroff(status_bar, bracket_attrs);
         g_free(date_fmt);
     }
-    prefs_free_string(time_pref);
 
     _update_win_statuses();
     wnoutrefresh(status_bar);
@@ -37,6 +37,7 @@
 
 void create_status_bar(void);
 void status_bar_update_virtual(void);
+int status_bar_clock_timeout(void);
 void status_bar_resize(void);
 void status_bar_clear(void);
 void status_bar_clear_message(void);
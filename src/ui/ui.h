@@ -63,11 +63,13 @@ typedef enum {
 void ui_init(void);
 void ui_load_colours(void);
 void ui_update(void);
+gint ui_frame_timeout(void);
 void ui_close(void);
 void ui_redraw(void);
 void ui_resize(void);
 void ui_focus_win(ProfWin *window);
 void ui_sigwinch_handler(int sig);
+int ui_get_resize_fd(void);
 void ui_handle_otr_error(const char *const barejid, const char *const message);
 unsigned long ui_get_idle_time(void);
 void ui_reset_idle_time(void);
@@ -132,6 +134,7 @@ ProfChatWin* chatwin_new(const char *const barejid);
 void chatwin_incoming_msg(ProfChatWin *chatwin, const char *const resource, const char *const message,
     GDateTime *timestamp, gboolean win_created, prof_enc_t enc_mode);
 void chatwin_receipt_received(ProfChatWin *chatwin, const char *const id);
+gboolean chatwin_history_page_up(ProfChatWin *chatwin);
 void chatwin_recipient_gone(ProfChatWin *chatwin);
 void chatwin_outgoing_msg(ProfChatWin *chatwin, const char *const message, char *id, prof_enc_t enc_mode,
     gboolean request_receipt);
@@ -236,8 +239,9 @@ void xmlwin_show(ProfXMLWin *xmlwin, const char *const msg);
 char* xmlwin_get_string(ProfXMLWin *xmlwin);
 
 // Input window
-char* inp_readline(void);
+char* inp_readline(gint timeout);
 void inp_nonblocking(gboolean reset);
+gint inp_get_timeout(void);
 
 // Console window
 void cons_show(const char *const msg, ...);
@@ -307,6 +311,7 @@ void cons_occupants_setting(void);
 void cons_roster_setting(void);
 void cons_presence_setting(void);
 void cons_wrap_setting(void);
+void cons_fuzzy_setting(void);
 void cons_winstidy_setting(void);
 void cons_time_setting(void);
 void cons_titlebar_setting(void);
@@ -327,6 +332,7 @@ void cons_reconnect_setting(void);
 void cons_autoping_setting(void);
 void cons_autoconnect_setting(void);
 void cons_inpblock_setting(void);
+void cons_maxfps_setting(void);
 void cons_show_contact_online(PContact contact, Resource *resource, GDateTime *last_activity);
 void cons_show_contact_offline(PContact contact, char *resource, char *status);
 void cons_theme_properties(void);
@@ -345,9 +351,11 @@ void status_bar_set_all_inactive(void);
 
 // roster window
 void rosterwin_roster(void);
+void rosterwin_update(void);
 
 // occupants window
 void occupantswin_occupants(const char *const room);
+void occupantswin_update(void);
 
 // window interface
 ProfWin* win_create_console(void);
@@ -385,6 +393,7 @@ void notify_typing(const char *const name);
 void notify_message(const char *const name, int win, const char *const text);
 void notify_room_message(const char *const nick, const char *const room, int win, const char *const text);
 void notify_remind(void);
+gint notify_remind_timeout(void);
 void notify_invite(const char *const from, const char *const room, const char *const reason);
 void notify(const char *const message, int timeout, const char *const category);
 void notify_subscription(const char *const from);
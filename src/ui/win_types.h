@@ -48,6 +48,7 @@
 
 #include "tools/autocomplete.h"
 #include "ui/buffer.h"
+#include "log.h"
 #include "xmpp/chat_state.h"
 
 #define LAYOUT_SPLIT_MEMCHECK       12345671
@@ -154,6 +155,7 @@ typedef struct prof_chat_win_t {
     gboolean pgp_recv;
     char *resource_override;
     gboolean history_shown;
+    ChatLogHistory history;
     unsigned long memcheck;
     char *enctext;
     char *incoming_char;
@@ -81,7 +81,7 @@ win_occpuants_cols(void)
 }
 
 static ProfLayout*
-_win_create_simple_layout(void)
+_win_create_simple_layout(int capacity)
 {
     int cols = getmaxx(stdscr);
 
@@ -89,7 +89,7 @@ _win_create_simple_layout(void)
     layout->base.type = LAYOUT_SIMPLE;
     layout->base.win = newpad(PAD_SIZE, cols);
     wbkgd(layout->base.win, theme_attrs(THEME_TEXT));
-    layout->base.buffer = buffer_create();
+    layout->base.buffer = buffer_create(capacity);
     layout->base.y_pos = 0;
     layout->base.paged = 0;
     scrollok(layout->base.win, TRUE);
@@ -98,7 +98,7 @@ _win_create_simple_layout(void)
 }
 
 static ProfLayout*
-_win_create_split_layout(void)
+_win_create_split_layout(int capacity)
 {
     int cols = getmaxx(stdscr);
 
@@ -106,7 +106,7 @@ _win_create_split_layout(void)
     layout->base.type = LAYOUT_SPLIT;
     layout->base.win = newpad(PAD_SIZE, cols);
     wbkgd(layout->base.win, theme_attrs(THEME_TEXT));
-    layout->base.buffer = buffer_create();
+    layout->base.buffer = buffer_create(capacity);
     layout->base.y_pos = 0;
     layout->base.paged = 0;
     scrollok(layout->base.win, TRUE);
@@ -122,7 +122,7 @@ win_create_console(void)
 {
     ProfConsoleWin *new_win = malloc(sizeof(ProfConsoleWin));
     new_win->window.type = WIN_CONSOLE;
-    new_win->window.layout = _win_create_split_layout();
+    new_win->window.layout = _win_create_split_layout(BUFF_SIZE);
 
     return &new_win->window;
 }
@@ -132,7 +132,7 @@ win_create_chat(const char *const barejid)
 {
     ProfChatWin *new_win = malloc(sizeof(ProfChatWin));
     new_win->window.type = WIN_CHAT;
-    new_win->window.layout = _win_create_simple_layout();
+    new_win->window.layout = _win_create_simple_layout(BUFF_SIZE);
 
     new_win->barejid = strdup(barejid);
     new_win->resource_override = NULL;
@@ -141,6 +141,7 @@ win_create_chat(const char *const barejid)
     new_win->pgp_recv = FALSE;
     new_win->pgp_send = FALSE;
     new_win->history_shown = FALSE;
+    new_win->history = NULL;
     new_win->unread = 0;
     new_win->state = chat_state_new();
     new_win->enctext = NULL;
@@ -176,7 +177,7 @@ win_create_muc(const char *const roomjid)
     }
     layout->sub_y_pos = 0;
     layout->memcheck = LAYOUT_SPLIT_MEMCHECK;
-    layout->base.buffer = buffer_create();
+    layout->base.buffer = buffer_create(BUFF_SIZE);
     layout->base.y_pos = 0;
     layout->base.paged = 0;
     scrollok(layout->base.win, TRUE);
@@ -204,7 +205,7 @@ win_create_muc_config(const char *const roomjid, DataForm *form)
 {
     ProfMucConfWin *new_win = malloc(sizeof(ProfMucConfWin));
     new_win->window.type = WIN_MUC_CONFIG;
-    new_win->window.layout = _win_create_simple_layout();
+    new_win->window.layout = _win_create_simple_layout(BUFF_SIZE);
 
     new_win->roomjid = strdup(roomjid);
     new_win->form = form;
@@ -219,7 +220,7 @@ win_create_private(const char *const fulljid)
 {
     ProfPrivateWin *new_win = malloc(sizeof(ProfPrivateWin));
     new_win->window.type = WIN_PRIVATE;
-    new_win->window.layout = _win_create_simple_layout();
+    new_win->window.layout = _win_create_simple_layout(BUFF_SIZE);
 
     new_win->fulljid = strdup(fulljid);
     new_win->unread = 0;
@@ -236,7 +237,7 @@ win_create_xmlconsole(void)
 {
     ProfXMLWin *new_win = malloc(sizeof(ProfXMLWin));
     new_win->window.type = WIN_XML;
-    new_win->window.layout = _win_create_simple_layout();
+    new_win->window.layout = _win_create_simple_layout(BUFF_SIZE);
 
     new_win->memcheck = PROFXMLWIN_MEMCHECK;
 
@@ -248,7 +249,7 @@ win_create_plugin(const char *const plugin_name, const char *const tag)
 {
     ProfPluginWin *new_win = malloc(sizeof(ProfPluginWin));
     new_win->super.type = WIN_PLUGIN;
-    new_win->super.layout = _win_create_simple_layout();
+    new_win->super.layout = _win_create_simple_layout(BUFF_SIZE);
 
     new_win->tag = strdup(tag);
     new_win->plugin_name = strdup(plugin_name);
@@ -435,6 +436,7 @@ win_free(ProfWin* window)
         free(chatwin->enctext);
         free(chatwin->incoming_char);
         free(chatwin->outgoing_char);
+        chat_log_history_free(chatwin->history);
         chat_state_free(chatwin->state);
         break;
     }
@@ -481,6 +483,15 @@ win_page_up(ProfWin *window)
     int page_space = rows - 4;
     int *page_start = &(window->layout->y_pos);
 
+    // at the top of a chat window, load older history above the current lines
+    if (*page_start == 0 && window->type == WIN_CHAT) {
+        if (chatwin_history_page_up((ProfChatWin*)window)) {
+            int new_y = getcury(window->layout->win);
+            *page_start += new_y - y;
+            y = new_y;
+        }
+    }
+
     *page_start -= page_space;
 
     // went past beginning, show first page
@@ -1076,6 +1087,24 @@ win_print_with_receipt(ProfWin *window, const char show_char, int pad_indent, GT
     g_date_time_unref(time);
 }
 
+gboolean
+win_print_front(ProfWin *window, const char show_char, int pad_indent, GDateTime *timestamp,
+    int flags, theme_item_t theme_item, const char *const from, const char *const message)
+{
+    if (timestamp == NULL) {
+        timestamp = g_date_time_new_now_local();
+    } else {
+        g_date_time_ref(timestamp);
+    }
+
+    // callers redraw once all entries have been added
+    gboolean added = buffer_push_front(window->layout->buffer, show_char, pad_indent, timestamp, flags, theme_item,
+        from, message, NULL);
+    g_date_time_unref(timestamp);
+
+    return added;
+}
+
 void
 win_mark_received(ProfWin *window, const char *const id)
 {
@@ -1144,25 +1173,25 @@ _win_print(ProfWin *window, const char show_char, int pad_indent, GDateTime *tim
     int colour = theme_attrs(THEME_ME);
     size_t indent = 0;
 
-    char *time_pref = NULL;
+    const char *time_pref = NULL;
     switch (window->type) {
         case WIN_CHAT:
-            time_pref = prefs_get_string(PREF_TIME_CHAT);
+            time_pref = prefs_peek_string(PREF_TIME_CHAT);
             break;
         case WIN_MUC:
-            time_pref = prefs_get_string(PREF_TIME_MUC);
+            time_pref = prefs_peek_string(PREF_TIME_MUC);
             break;
         case WIN_MUC_CONFIG:
-            time_pref = prefs_get_string(PREF_TIME_MUCCONFIG);
+            time_pref = prefs_peek_string(PREF_TIME_MUCCONFIG);
             break;
         case WIN_PRIVATE:
-            time_pref = prefs_get_string(PREF_TIME_PRIVATE);
+            time_pref = prefs_peek_string(PREF_TIME_PRIVATE);
             break;
         case WIN_XML:
-            time_pref = prefs_get_string(PREF_TIME_XMLCONSOLE);
+            time_pref = prefs_peek_string(PREF_TIME_XMLCONSOLE);
             break;
         default:
-            time_pref = prefs_get_string(PREF_TIME_CONSOLE);
+            time_pref = prefs_peek_string(PREF_TIME_CONSOLE);
             break;
     }
 
@@ -1172,7 +1201,6 @@ _win_print(ProfWin *window, const char show_char, int pad_indent, GDateTime *tim
     } else {
         date_fmt = g_date_time_format(time, time_pref);
     }
-    prefs_free_string(time_pref);
     assert(date_fmt != NULL);
 
     if(strlen(date_fmt) != 0){
@@ -63,6 +63,8 @@ void win_print_incoming_message(ProfWin *window, GDateTime *timestamp,
     const char *const from, const char *const message, prof_enc_t enc_mode);
 void win_print_with_receipt(ProfWin *window, const char show_char, int pad_indent, GTimeVal *tstamp, int flags,
     theme_item_t theme_item, const char *const from, const char *const message, char *id);
+gboolean win_print_front(ProfWin *window, const char show_char, int pad_indent, GDateTime *timestamp, int flags,
+    theme_item_t theme_item, const char *const from, const char *const message);
 void win_newline(ProfWin *window);
 void win_redraw(ProfWin *window);
 int win_roster_cols(void);
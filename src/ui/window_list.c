@@ -55,13 +55,28 @@ static int current;
 static Autocomplete wins_ac;
 static Autocomplete wins_close_ac;
 
+// windows indexed by barejid, roomjid, fulljid or plugin tag, keys are
+// owned by the windows
+static GHashTable *chat_index;
+static GHashTable *muc_index;
+static GHashTable *muc_conf_index;
+static GHashTable *private_index;
+static GHashTable *plugin_index;
+
 static int _wins_cmp_num(gconstpointer a, gconstpointer b);
 static int _wins_get_next_available_num(GList *used);
+static void _wins_index_add(ProfWin *window);
+static void _wins_index_remove(ProfWin *window);
 
 void
 wins_init(void)
 {
     windows = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)win_free);
+    chat_index = g_hash_table_new(g_str_hash, g_str_equal);
+    muc_index = g_hash_table_new(g_str_hash, g_str_equal);
+    muc_conf_index = g_hash_table_new(g_str_hash, g_str_equal);
+    private_index = g_hash_table_new(g_str_hash, g_str_equal);
+    plugin_index = g_hash_table_new(g_str_hash, g_str_equal);
 
     ProfWin *console = win_create_console();
     g_hash_table_insert(windows, GINT_TO_POINTER(1), console);
@@ -92,23 +107,11 @@ wins_chat_exists(const char *const barejid)
 ProfChatWin*
 wins_get_chat(const char *const barejid)
 {
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        if (window->type == WIN_CHAT) {
-            ProfChatWin *chatwin = (ProfChatWin*)window;
-            if (g_strcmp0(chatwin->barejid, barejid) == 0) {
-                g_list_free(values);
-                return chatwin;
-            }
-        }
-        curr = g_list_next(curr);
+    if (barejid == NULL) {
+        return NULL;
     }
 
-    g_list_free(values);
-    return NULL;
+    return g_hash_table_lookup(chat_index, barejid);
 }
 
 static gint
@@ -143,89 +146,41 @@ wins_get_chat_unsubscribed(void)
 ProfMucConfWin*
 wins_get_muc_conf(const char *const roomjid)
 {
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        if (window->type == WIN_MUC_CONFIG) {
-            ProfMucConfWin *confwin = (ProfMucConfWin*)window;
-            if (g_strcmp0(confwin->roomjid, roomjid) == 0) {
-                g_list_free(values);
-                return confwin;
-            }
-        }
-        curr = g_list_next(curr);
+    if (roomjid == NULL) {
+        return NULL;
     }
 
-    g_list_free(values);
-    return NULL;
+    return g_hash_table_lookup(muc_conf_index, roomjid);
 }
 
 ProfMucWin*
 wins_get_muc(const char *const roomjid)
 {
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        if (window->type == WIN_MUC) {
-            ProfMucWin *mucwin = (ProfMucWin*)window;
-            if (g_strcmp0(mucwin->roomjid, roomjid) == 0) {
-                g_list_free(values);
-                return mucwin;
-            }
-        }
-        curr = g_list_next(curr);
+    if (roomjid == NULL) {
+        return NULL;
     }
 
-    g_list_free(values);
-    return NULL;
+    return g_hash_table_lookup(muc_index, roomjid);
 }
 
 ProfPrivateWin*
 wins_get_private(const char *const fulljid)
 {
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        if (window->type == WIN_PRIVATE) {
-            ProfPrivateWin *privatewin = (ProfPrivateWin*)window;
-            if (g_strcmp0(privatewin->fulljid, fulljid) == 0) {
-                g_list_free(values);
-                return privatewin;
-            }
-        }
-        curr = g_list_next(curr);
+    if (fulljid == NULL) {
+        return NULL;
     }
 
-    g_list_free(values);
-    return NULL;
+    return g_hash_table_lookup(private_index, fulljid);
 }
 
 ProfPluginWin*
 wins_get_plugin(const char *const tag)
 {
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        if (window->type == WIN_PLUGIN) {
-            ProfPluginWin *pluginwin = (ProfPluginWin*)window;
-            if (g_strcmp0(pluginwin->tag, tag) == 0) {
-                g_list_free(values);
-                return pluginwin;
-            }
-        }
-        curr = g_list_next(curr);
+    if (tag == NULL) {
+        return NULL;
     }
 
-    g_list_free(values);
-    return NULL;
+    return g_hash_table_lookup(plugin_index, tag);
 }
 
 void
@@ -276,10 +231,12 @@ wins_private_nick_change(const char *const roomjid, const char *const oldnick, c
 
     ProfPrivateWin *privwin = wins_get_private(oldjid->fulljid);
     if (privwin) {
+        _wins_index_remove((ProfWin*)privwin);
         free(privwin->fulljid);
 
         Jid *newjid = jid_create_from_bare_and_resource(roomjid, newnick);
         privwin->fulljid = strdup(newjid->fulljid);
+        _wins_index_add((ProfWin*)privwin);
         win_vprint((ProfWin*)privwin, '!', 0, NULL, 0, THEME_THEM, NULL, "** %s is now known as %s.", oldjid->resourcepart, newjid->resourcepart);
 
         autocomplete_remove(wins_ac, oldjid->fulljid);
@@ -591,6 +548,8 @@ wins_close_by_num(int i)
             default:
                 break;
             }
+
+            _wins_index_remove(window);
         }
 
         g_hash_table_remove(windows, GINT_TO_POINTER(i));
@@ -631,6 +590,7 @@ wins_new_chat(const char *const barejid)
     g_list_free(keys);
     ProfWin *newwin = win_create_chat(barejid);
     g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    _wins_index_add(newwin);
 
     autocomplete_add(wins_ac, barejid);
     autocomplete_add(wins_close_ac, barejid);
@@ -654,6 +614,7 @@ wins_new_muc(const char *const roomjid)
     g_list_free(keys);
     ProfWin *newwin = win_create_muc(roomjid);
     g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    _wins_index_add(newwin);
     autocomplete_add(wins_ac, roomjid);
     autocomplete_add(wins_close_ac, roomjid);
     return newwin;
@@ -667,6 +628,7 @@ wins_new_muc_config(const char *const roomjid, DataForm *form)
     g_list_free(keys);
     ProfWin *newwin = win_create_muc_config(roomjid, form);
     g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    _wins_index_add(newwin);
     return newwin;
 }
 
@@ -678,6 +640,7 @@ wins_new_private(const char *const fulljid)
     g_list_free(keys);
     ProfWin *newwin = win_create_private(fulljid);
     g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    _wins_index_add(newwin);
     autocomplete_add(wins_ac, fulljid);
     autocomplete_add(wins_close_ac, fulljid);
     return newwin;
@@ -691,6 +654,7 @@ wins_new_plugin(const char *const plugin_name, const char * const tag)
     g_list_free(keys);
     ProfWin *newwin = win_create_plugin(plugin_name, tag);
     g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    _wins_index_add(newwin);
     autocomplete_add(wins_ac, tag);
     autocomplete_add(wins_close_ac, tag);
     return newwin;
@@ -1099,7 +1063,57 @@ win_close_reset_search_attempts(void)
 void
 wins_destroy(void)
 {
+    g_hash_table_destroy(chat_index);
+    g_hash_table_destroy(muc_index);
+    g_hash_table_destroy(muc_conf_index);
+    g_hash_table_destroy(private_index);
+    g_hash_table_destroy(plugin_index);
     g_hash_table_destroy(windows);
     autocomplete_free(wins_ac);
     autocomplete_free(wins_close_ac);
 }
+
+static GHashTable*
+_wins_index_for(ProfWin *window, const char **key)
+{
+    switch (window->type) {
+    case WIN_CHAT:
+        *key = ((ProfChatWin*)window)->barejid;
+        return chat_index;
+    case WIN_MUC:
+        *key = ((ProfMucWin*)window)->roomjid;
+        return muc_index;
+    case WIN_MUC_CONFIG:
+        *key = ((ProfMucConfWin*)window)->roomjid;
+        return muc_conf_index;
+    case WIN_PRIVATE:
+        *key = ((ProfPrivateWin*)window)->fulljid;
+        return private_index;
+    case WIN_PLUGIN:
+        *key = ((ProfPluginWin*)window)->tag;
+        return plugin_index;
+    default:
+        return NULL;
+    }
+}
+
+static void
+_wins_index_add(ProfWin *window)
+{
+    const char *key = NULL;
+    GHashTable *index = _wins_index_for(window, &key);
+    if (index && key) {
+        // replace the key too, it belongs to the window
+        g_hash_table_replace(index, (gpointer)key, window);
+    }
+}
+
+static void
+_wins_index_remove(ProfWin *window)
+{
+    const char *key = NULL;
+    GHashTable *index = _wins_index_for(window, &key);
+    if (index && key && g_hash_table_lookup(index, key) == window) {
+        g_hash_table_remove(index, key);
+    }
+}
@@ -50,6 +50,7 @@
 
 #include "common.h"
 #include "log.h"
+#include "config/preferences.h"
 #include "event/server_events.h"
 #include "plugins/plugins.h"
 #include "ui/ui.h"
@@ -214,7 +215,11 @@ bookmark_get_list(void)
 char*
 bookmark_find(const char *const search_str)
 {
-    return autocomplete_complete(bookmark_ac, search_str, TRUE);
+    if (prefs_get_boolean(PREF_COMPLETION_FUZZY)) {
+        return autocomplete_complete_fuzzy(bookmark_ac, search_str, TRUE);
+    } else {
+        return autocomplete_complete(bookmark_ac, search_str, TRUE);
+    }
 }
 
 void
@@ -38,8 +38,14 @@
 #include "gitversion.h"
 #endif
 
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
 
 #include <glib.h>
 #include <glib/gstdio.h>
@@ -63,8 +69,65 @@
 #include "xmpp/form.h"
 #include "xmpp/capabilities.h"
 
+// The cache file is an append only log of records after CACHE_MAGIC, shared
+// by every running instance. A caps record is its length followed by the ver,
+// the identity and software version fields and the features, each stored as
+// a length and its bytes, so records do not depend on each other. Integers
+// are stored little endian, CACHE_NO_STRING as a length marks a missing field.
+#define CACHE_MAGIC "PROFCAPS2"
+#define CACHE_RECORD_CAPS 'C'
+#define CACHE_NO_STRING G_MAXUINT32
+
+typedef enum {
+    CACHE_FIELD_CATEGORY,
+    CACHE_FIELD_TYPE,
+    CACHE_FIELD_NAME,
+    CACHE_FIELD_SOFTWARE,
+    CACHE_FIELD_SOFTWARE_VERSION,
+    CACHE_FIELD_OS,
+    CACHE_FIELD_OS_VERSION,
+    CACHE_FIELD_COUNT
+} cache_field_t;
+
+// features not in known_features are kept as string ids
+typedef struct caps_entry_t {
+    guint32 fields[CACHE_FIELD_COUNT];
+    guint64 known_features;
+    guint32 features_len;
+    guint32 *features;
+} CapsEntry;
+
+// feature namespaces checked on hot paths, each gets a bit in the
+// known_features set of EntityCapabilities and CapsEntry, at most 64
+static const char *const known_features[] = {
+    STANZA_NS_CHATSTATES,
+    STANZA_NS_RECEIPTS,
+    STANZA_NS_CARBONS,
+    STANZA_NS_BLOCKING,
+    STANZA_NS_LASTACTIVITY,
+    STANZA_NS_MUC,
+    STANZA_NS_CONFERENCE,
+    STANZA_NS_CAPS,
+    STANZA_NS_PING,
+    STANZA_NS_VERSION,
+    STANZA_NS_HTTP_UPLOAD,
+    STANZA_NS_X_OOB,
+    STANZA_NS_PUBSUB,
+    XMPP_NS_DISCO_INFO,
+    XMPP_NS_DISCO_ITEMS,
+};
+
+static GHashTable *known_feature_ids;
+
 static char *cache_loc;
-static GKeyFile *cache;
+static int cache_fd = -1;
+
+// interned strings, id to string and string to id + 1
+static GPtrArray *cache_strings;
+static GHashTable *cache_string_ids;
+
+// ver to CapsEntry
+static GHashTable *cache;
 
 static GHashTable *jid_to_ver;
 static GHashTable *jid_to_caps;
@@ -72,7 +135,12 @@ static GHashTable *jid_to_caps;
 static GHashTable *prof_features;
 static char *my_sha1;
 
-static void _save_cache(void);
+static void _cache_load(void);
+static void _cache_migrate(const char *const keyfile_loc);
+static void _cache_add(const char *const ver, EntityCapabilities *caps, GString *out);
+static gboolean _cache_append(GString *out);
+static guint32 _cache_intern_id(const char *const str);
+static gboolean _caps_entry_has_feature(CapsEntry *entry, int id, const char *const feature);
 static EntityCapabilities* _caps_by_ver(const char *const ver);
 static EntityCapabilities* _caps_by_jid(const char *const jid);
 static EntityCapabilities* _caps_copy(EntityCapabilities *caps);
@@ -81,14 +149,19 @@ void
 caps_init(void)
 {
     log_info("Loading capabilities cache");
-    cache_loc = files_get_data_path(FILE_CAPSCACHE);
+    cache_loc = files_get_data_path(FILE_CAPSCACHE_BIN);
+    cache_fd = -1;
+    cache_strings = g_ptr_array_new_with_free_func(free);
+    cache_string_ids = g_hash_table_new(g_str_hash, g_str_equal);
+    cache = g_hash_table_new_full(g_str_hash, g_str_equal, free, free);
 
-    if (g_file_test(cache_loc, G_FILE_TEST_EXISTS)) {
-        g_chmod(cache_loc, S_IRUSR | S_IWUSR);
-    }
+    _cache_load();
 
-    cache = g_key_file_new();
-    g_key_file_load_from_file(cache, cache_loc, G_KEY_FILE_KEEP_COMMENTS, NULL);
+    char *keyfile_loc = files_get_data_path(FILE_CAPSCACHE);
+    if (g_file_test(keyfile_loc, G_FILE_TEST_EXISTS)) {
+        _cache_migrate(keyfile_loc);
+    }
+    free(keyfile_loc);
 
     jid_to_ver = g_hash_table_new_full(g_str_hash, g_str_equal, free, free);
     jid_to_caps = g_hash_table_new_full(g_str_hash, g_str_equal, free, (GDestroyNotify)caps_destroy);
@@ -202,9 +275,14 @@ caps_create(const char *const category, const char *const type, const char *cons
     }
 
     result->features = NULL;
+    result->known_features = 0;
     GSList *curr = features;
     while (curr) {
         result->features = g_slist_append(result->features, strdup(curr->data));
+        int id = caps_feature_id(curr->data);
+        if (id >= 0) {
+            result->known_features |= CAPS_FEATURE_BIT(id);
+        }
         curr = g_slist_next(curr);
     }
 
@@ -218,53 +296,14 @@ caps_add_by_ver(const char *const ver, EntityCapabilities *caps)
         return;
     }
 
-    gboolean cached = g_key_file_has_group(cache, ver);
-    if (cached) {
+    if (g_hash_table_lookup(cache, ver) != NULL) {
         return;
     }
 
-    if (caps->identity) {
-        DiscoIdentity *identity = caps->identity;
-        if (identity->name) {
-            g_key_file_set_string(cache, ver, "name", identity->name);
-        }
-        if (identity->category) {
-            g_key_file_set_string(cache, ver, "category", identity->category);
-        }
-        if (identity->type) {
-            g_key_file_set_string(cache, ver, "type", identity->type);
-        }
-    }
-
-    if (caps->software_version) {
-        SoftwareVersion *software_version = caps->software_version;
-        if (software_version->software) {
-            g_key_file_set_string(cache, ver, "software", software_version->software);
-        }
-        if (software_version->software_version) {
-            g_key_file_set_string(cache, ver, "software_version", software_version->software_version);
-        }
-        if (software_version->os) {
-            g_key_file_set_string(cache, ver, "os", software_version->os);
-        }
-        if (software_version->os_version) {
-            g_key_file_set_string(cache, ver, "os_version", software_version->os_version);
-        }
-    }
-
-    if (caps->features) {
-        GSList *curr_feature = caps->features;
-        int num = g_slist_length(caps->features);
-        const gchar* features_list[num];
-        int curr = 0;
-        while (curr_feature) {
-            features_list[curr++] = curr_feature->data;
-            curr_feature = g_slist_next(curr_feature);
-        }
-        g_key_file_set_string_list(cache, ver, "features", features_list, num);
-    }
-
-    _save_cache();
+    GString *out = g_string_new("");
+    _cache_add(ver, caps, out);
+    _cache_append(out);
+    g_string_free(out, TRUE);
 }
 
 void
@@ -282,7 +321,7 @@ caps_map_jid_to_ver(const char *const jid, const char *const ver)
 gboolean
 caps_cache_contains(const char *const ver)
 {
-    return (g_key_file_has_group(cache, ver));
+    return g_hash_table_lookup(cache, ver) != NULL;
 }
 
 EntityCapabilities*
@@ -310,18 +349,42 @@ caps_lookup(const char *const jid)
 gboolean
 caps_jid_has_feature(const char *const jid, const char *const feature)
 {
-    EntityCapabilities *caps = caps_lookup(jid);
+    int id = caps_feature_id(feature);
 
+    char *ver = g_hash_table_lookup(jid_to_ver, jid);
+    if (ver) {
+        CapsEntry *entry = g_hash_table_lookup(cache, ver);
+        return entry && _caps_entry_has_feature(entry, id, feature);
+    }
+
+    EntityCapabilities *caps = _caps_by_jid(jid);
     if (caps == NULL) {
         return FALSE;
     }
 
-    GSList *found = g_slist_find_custom(caps->features, feature, (GCompareFunc)g_strcmp0);
-    gboolean result = found != NULL;
+    if (id >= 0) {
+        return (caps->known_features & CAPS_FEATURE_BIT(id)) != 0;
+    }
 
-    caps_destroy(caps);
+    return g_slist_find_custom(caps->features, feature, (GCompareFunc)g_strcmp0) != NULL;
+}
 
-    return result;
+int
+caps_feature_id(const char *const feature)
+{
+    if (feature == NULL) {
+        return -1;
+    }
+
+    if (known_feature_ids == NULL) {
+        known_feature_ids = g_hash_table_new(g_str_hash, g_str_equal);
+        int i;
+        for (i = 0; i < G_N_ELEMENTS(known_features); i++) {
+            g_hash_table_insert(known_feature_ids, (gpointer)known_features[i], GINT_TO_POINTER(i + 1));
+        }
+    }
+
+    return GPOINTER_TO_INT(g_hash_table_lookup(known_feature_ids, feature)) - 1;
 }
 
 char*
@@ -348,57 +411,88 @@ caps_reset_ver(void)
 void
 caps_close(void)
 {
-    g_key_file_free(cache);
+    if (cache_fd >= 0) {
+        close(cache_fd);
+        cache_fd = -1;
+    }
+    g_hash_table_destroy(cache);
     cache = NULL;
+    g_hash_table_destroy(cache_string_ids);
+    cache_string_ids = NULL;
+    g_ptr_array_free(cache_strings, TRUE);
+    cache_strings = NULL;
     g_hash_table_destroy(jid_to_ver);
     g_hash_table_destroy(jid_to_caps);
     free(cache_loc);
     cache_loc = NULL;
     g_hash_table_destroy(prof_features);
     prof_features = NULL;
+    if (known_feature_ids) {
+        g_hash_table_destroy(known_feature_ids);
+        known_feature_ids = NULL;
+    }
 }
 
-static EntityCapabilities*
-_caps_by_ver(const char *const ver)
+static const char*
+_cache_string(guint32 id)
 {
-    if (!g_key_file_has_group(cache, ver)) {
+    if (id == CACHE_NO_STRING || id >= cache_strings->len) {
         return NULL;
     }
 
-    char *category = g_key_file_get_string(cache, ver, "category", NULL);
-    char *type = g_key_file_get_string(cache, ver, "type", NULL);
-    char *name = g_key_file_get_string(cache, ver, "name", NULL);
+    return g_ptr_array_index(cache_strings, id);
+}
 
-    char *software = g_key_file_get_string(cache, ver, "software", NULL);
-    char *software_version = g_key_file_get_string(cache, ver, "software_version", NULL);
-    char *os = g_key_file_get_string(cache, ver, "os", NULL);
-    char *os_version = g_key_file_get_string(cache, ver, "os_version", NULL);
+static gboolean
+_caps_entry_has_feature(CapsEntry *entry, int id, const char *const feature)
+{
+    if (id >= 0) {
+        return (entry->known_features & CAPS_FEATURE_BIT(id)) != 0;
+    }
+
+    guint32 feature_id = _cache_intern_id(feature);
+    if (feature_id == CACHE_NO_STRING) {
+        return FALSE;
+    }
+
+    guint32 i;
+    for (i = 0; i < entry->features_len; i++) {
+        if (entry->features[i] == feature_id) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static EntityCapabilities*
+_caps_by_ver(const char *const ver)
+{
+    CapsEntry *entry = g_hash_table_lookup(cache, ver);
+    if (entry == NULL) {
+        return NULL;
+    }
 
-    gsize features_len = 0;
-    gchar **features_list = g_key_file_get_string_list(cache, ver, "features", &features_len, NULL);
     GSList *features = NULL;
-    if (features_list && features_len > 0) {
-        int i;
-        for (i = 0; i < features_len; i++) {
-            features = g_slist_append(features, features_list[i]);
+    int i;
+    for (i = entry->features_len - 1; i >= 0; i--) {
+        features = g_slist_prepend(features, (gpointer)_cache_string(entry->features[i]));
+    }
+    for (i = G_N_ELEMENTS(known_features) - 1; i >= 0; i--) {
+        if (entry->known_features & CAPS_FEATURE_BIT(i)) {
+            features = g_slist_prepend(features, (gpointer)known_features[i]);
         }
     }
 
     EntityCapabilities *result = caps_create(
-        category, type, name,
-        software, software_version, os, os_version,
+        _cache_string(entry->fields[CACHE_FIELD_CATEGORY]),
+        _cache_string(entry->fields[CACHE_FIELD_TYPE]),
+        _cache_string(entry->fields[CACHE_FIELD_NAME]),
+        _cache_string(entry->fields[CACHE_FIELD_SOFTWARE]),
+        _cache_string(entry->fields[CACHE_FIELD_SOFTWARE_VERSION]),
+        _cache_string(entry->fields[CACHE_FIELD_OS]),
+        _cache_string(entry->fields[CACHE_FIELD_OS_VERSION]),
         features);
-
-    g_free(category);
-    g_free(type);
-    g_free(name);
-    g_free(software);
-    g_free(software_version);
-    g_free(os);
-    g_free(os_version);
-    if (features_list) {
-        g_strfreev(features_list);
-    }
     g_slist_free(features);
 
     return result;
@@ -466,11 +560,425 @@ caps_destroy(EntityCapabilities *caps)
 }
 
 static void
-_save_cache(void)
+_put_u32(GString *out, guint32 value)
+{
+    g_string_append_c(out, value & 0xff);
+    g_string_append_c(out, (value >> 8) & 0xff);
+    g_string_append_c(out, (value >> 16) & 0xff);
+    g_string_append_c(out, (value >> 24) & 0xff);
+}
+
+static gboolean
+_get_u32(const guchar **pos, const guchar *end, guint32 *value)
+{
+    if (end - *pos < 4) {
+        return FALSE;
+    }
+
+    const guchar *p = *pos;
+    *value = p[0] | (p[1] << 8) | (p[2] << 16) | ((guint32)p[3] << 24);
+    *pos += 4;
+
+    return TRUE;
+}
+
+static void
+_put_string(GString *out, const char *const str)
+{
+    if (str == NULL) {
+        _put_u32(out, CACHE_NO_STRING);
+        return;
+    }
+
+    size_t len = strlen(str);
+    _put_u32(out, len);
+    g_string_append_len(out, str, len);
+}
+
+// str points into the record and is not terminated, NULL for a missing field
+static gboolean
+_get_string(const guchar **pos, const guchar *end, const char **str, guint32 *len)
+{
+    if (!_get_u32(pos, end, len)) {
+        return FALSE;
+    }
+
+    if (*len == CACHE_NO_STRING) {
+        *str = NULL;
+        return TRUE;
+    }
+
+    if ((size_t)(end - *pos) < *len) {
+        return FALSE;
+    }
+
+    *str = (const char*)*pos;
+    *pos += *len;
+
+    return TRUE;
+}
+
+static guint32
+_cache_intern_id(const char *const str)
+{
+    gpointer id = g_hash_table_lookup(cache_string_ids, str);
+    if (id) {
+        return GPOINTER_TO_UINT(id) - 1;
+    }
+
+    return CACHE_NO_STRING;
+}
+
+// strings are shared in memory by all entries, the file stores them inline
+static guint32
+_cache_intern(const char *const str, gsize len)
+{
+    if (str == NULL) {
+        return CACHE_NO_STRING;
+    }
+
+    char *copy = g_strndup(str, len);
+    guint32 id = _cache_intern_id(copy);
+    if (id != CACHE_NO_STRING) {
+        g_free(copy);
+        return id;
+    }
+
+    g_ptr_array_add(cache_strings, copy);
+    id = cache_strings->len - 1;
+    g_hash_table_insert(cache_string_ids, copy, GUINT_TO_POINTER(id + 1));
+
+    return id;
+}
+
+// known features go into the bitset, only the rest keep their string ids
+static CapsEntry*
+_cache_entry_new(guint32 *fields, guint32 *features, guint32 features_len)
+{
+    guint64 known = 0;
+    guint32 unknown_len = 0;
+    int *ids = g_new(int, features_len);
+    guint32 f;
+    for (f = 0; f < features_len; f++) {
+        ids[f] = caps_feature_id(_cache_string(features[f]));
+        if (ids[f] >= 0) {
+            known |= CAPS_FEATURE_BIT(ids[f]);
+        } else {
+            unknown_len++;
+        }
+    }
+
+    CapsEntry *entry = malloc(sizeof(CapsEntry) + unknown_len * sizeof(guint32));
+    memcpy(entry->fields, fields, sizeof(entry->fields));
+    entry->known_features = known;
+    entry->features = (guint32*)(entry + 1);
+    entry->features_len = 0;
+    for (f = 0; f < features_len; f++) {
+        if (ids[f] < 0) {
+            entry->features[entry->features_len++] = features[f];
+        }
+    }
+    g_free(ids);
+
+    return entry;
+}
+
+// add an entry and write its caps record to out
+static void
+_cache_add(const char *const ver, EntityCapabilities *caps, GString *out)
+{
+    const char *fields[CACHE_FIELD_COUNT] = { NULL };
+    if (caps->identity) {
+        fields[CACHE_FIELD_CATEGORY] = caps->identity->category;
+        fields[CACHE_FIELD_TYPE] = caps->identity->type;
+        fields[CACHE_FIELD_NAME] = caps->identity->name;
+    }
+    if (caps->software_version) {
+        fields[CACHE_FIELD_SOFTWARE] = caps->software_version->software;
+        fields[CACHE_FIELD_SOFTWARE_VERSION] = caps->software_version->software_version;
+        fields[CACHE_FIELD_OS] = caps->software_version->os;
+        fields[CACHE_FIELD_OS_VERSION] = caps->software_version->os_version;
+    }
+
+    guint32 features_len = g_slist_length(caps->features);
+    guint32 *features = g_new(guint32, features_len);
+    GString *record = g_string_new("");
+
+    _put_string(record, ver);
+    guint32 field_ids[CACHE_FIELD_COUNT];
+    int i;
+    for (i = 0; i < CACHE_FIELD_COUNT; i++) {
+        field_ids[i] = fields[i] ? _cache_intern(fields[i], strlen(fields[i])) : CACHE_NO_STRING;
+        _put_string(record, fields[i]);
+    }
+    _put_u32(record, features_len);
+    guint32 f = 0;
+    GSList *curr = caps->features;
+    while (curr) {
+        features[f++] = _cache_intern(curr->data, strlen(curr->data));
+        _put_string(record, curr->data);
+        curr = g_slist_next(curr);
+    }
+
+    g_string_append_c(out, CACHE_RECORD_CAPS);
+    _put_u32(out, record->len);
+    g_string_append_len(out, record->str, record->len);
+    g_string_free(record, TRUE);
+
+    g_hash_table_insert(cache, strdup(ver), _cache_entry_new(field_ids, features, features_len));
+    g_free(features);
+}
+
+// parse one caps record, FALSE when it is damaged
+static gboolean
+_cache_read_record(const guchar *pos, const guchar *end)
+{
+    const char *str;
+    guint32 len;
+    if (!_get_string(&pos, end, &str, &len) || str == NULL) {
+        return FALSE;
+    }
+    char *ver = g_strndup(str, len);
+
+    guint32 fields[CACHE_FIELD_COUNT];
+    int i;
+    for (i = 0; i < CACHE_FIELD_COUNT; i++) {
+        if (!_get_string(&pos, end, &str, &len)) {
+            g_free(ver);
+            return FALSE;
+        }
+        fields[i] = _cache_intern(str, len);
+    }
+
+    guint32 features_len;
+    if (!_get_u32(&pos, end, &features_len) || (size_t)(end - pos) / 4 < features_len) {
+        g_free(ver);
+        return FALSE;
+    }
+
+    guint32 *features = g_new(guint32, features_len);
+    guint32 f;
+    for (f = 0; f < features_len; f++) {
+        if (!_get_string(&pos, end, &str, &len) || str == NULL) {
+            break;
+        }
+        features[f] = _cache_intern(str, len);
+    }
+    if (f < features_len || pos != end) {
+        g_free(features);
+        g_free(ver);
+        return FALSE;
+    }
+
+    g_hash_table_replace(cache, strdup(ver), _cache_entry_new(fields, features, features_len));
+    g_free(features);
+    g_free(ver);
+
+    return TRUE;
+}
+
+static gboolean
+_cache_open(void)
+{
+    if (cache_fd >= 0) {
+        return TRUE;
+    }
+
+    cache_fd = open(cache_loc, O_RDWR | O_APPEND | O_CREAT, S_IRUSR | S_IWUSR);
+    if (cache_fd < 0) {
+        log_error("Could not open capabilities cache %s: %s", cache_loc, strerror(errno));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static gboolean
+_cache_write(const char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t written = write(cache_fd, buf, len);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return FALSE;
+        }
+        buf += written;
+        len -= written;
+    }
+
+    return TRUE;
+}
+
+// other instances append to the same file, the lock keeps their records
+// whole and a failed write is cut off so later records stay readable
+static gboolean
+_cache_append(GString *out)
+{
+    if (!_cache_open()) {
+        return FALSE;
+    }
+
+    if (flock(cache_fd, LOCK_EX) != 0) {
+        log_error("Could not lock capabilities cache %s: %s", cache_loc, strerror(errno));
+        return FALSE;
+    }
+
+    struct stat st;
+    if (fstat(cache_fd, &st) != 0) {
+        log_error("Could not read capabilities cache %s: %s", cache_loc, strerror(errno));
+        flock(cache_fd, LOCK_UN);
+        return FALSE;
+    }
+
+    gboolean written = TRUE;
+    if (st.st_size == 0) {
+        written = _cache_write(CACHE_MAGIC, strlen(CACHE_MAGIC));
+    }
+    written = written && _cache_write(out->str, out->len);
+    if (!written) {
+        log_error("Could not write capabilities cache %s: %s", cache_loc, strerror(errno));
+        if (ftruncate(cache_fd, st.st_size) != 0) {
+            log_error("Could not truncate capabilities cache %s", cache_loc);
+        }
+    }
+
+    flock(cache_fd, LOCK_UN);
+
+    return written;
+}
+
+// replay the records in the cache file, a damaged tail is truncated so
+// later appends follow the last complete record
+static void
+_cache_replay(void)
 {
-    gsize g_data_size;
-    gchar *g_cache_data = g_key_file_to_data(cache, &g_data_size, NULL);
-    g_file_set_contents(cache_loc, g_cache_data, g_data_size, NULL);
-    g_chmod(cache_loc, S_IRUSR | S_IWUSR);
-    g_free(g_cache_data);
+    GMappedFile *mapped = g_mapped_file_new(cache_loc, FALSE, NULL);
+    if (mapped == NULL) {
+        log_error("Could not read capabilities cache %s", cache_loc);
+        return;
+    }
+
+    const guchar *data = (const guchar*)g_mapped_file_get_contents(mapped);
+    const guchar *end = data + g_mapped_file_get_length(mapped);
+    if (data == end) {
+        g_mapped_file_unref(mapped);
+        return;
+    }
+
+    size_t magic_len = strlen(CACHE_MAGIC);
+    if ((size_t)(end - data) < magic_len || memcmp(data, CACHE_MAGIC, magic_len) != 0) {
+        log_error("Capabilities cache %s has an unknown format, discarding", cache_loc);
+        g_mapped_file_unref(mapped);
+        if (ftruncate(cache_fd, 0) != 0) {
+            log_error("Could not truncate capabilities cache %s", cache_loc);
+        }
+        return;
+    }
+
+    const guchar *pos = data + magic_len;
+    const guchar *valid = pos;
+    int entries = 0;
+    while (pos < end) {
+        guint32 len;
+        if (*pos++ != CACHE_RECORD_CAPS || !_get_u32(&pos, end, &len) || (size_t)(end - pos) < len) {
+            break;
+        }
+        if (!_cache_read_record(pos, pos + len)) {
+            break;
+        }
+        pos += len;
+        valid = pos;
+        entries++;
+    }
+
+    if (valid != end) {
+        log_error("Capabilities cache %s is damaged, keeping %d entries", cache_loc, entries);
+        if (ftruncate(cache_fd, valid - data) != 0) {
+            log_error("Could not truncate capabilities cache %s", cache_loc);
+        }
+    }
+
+    g_mapped_file_unref(mapped);
+    log_info("Loaded %d capabilities cache entries", entries);
+}
+
+static void
+_cache_load(void)
+{
+    if (!g_file_test(cache_loc, G_FILE_TEST_EXISTS) || !_cache_open()) {
+        return;
+    }
+
+    // no other instance may append while a damaged tail is cut off
+    if (flock(cache_fd, LOCK_EX) != 0) {
+        log_error("Could not lock capabilities cache %s: %s", cache_loc, strerror(errno));
+        return;
+    }
+    _cache_replay();
+    flock(cache_fd, LOCK_UN);
+}
+
+// convert the key file cache used by earlier versions
+static void
+_cache_migrate(const char *const keyfile_loc)
+{
+    GKeyFile *keyfile = g_key_file_new();
+    if (!g_key_file_load_from_file(keyfile, keyfile_loc, G_KEY_FILE_NONE, NULL)) {
+        g_key_file_free(keyfile);
+        return;
+    }
+
+    GString *out = g_string_new("");
+    gsize groups_len = 0;
+    gchar **groups = g_key_file_get_groups(keyfile, &groups_len);
+    gsize i;
+    for (i = 0; i < groups_len; i++) {
+        const char *ver = groups[i];
+        if (g_hash_table_lookup(cache, ver) != NULL) {
+            continue;
+        }
+
+        char *category = g_key_file_get_string(keyfile, ver, "category", NULL);
+        char *type = g_key_file_get_string(keyfile, ver, "type", NULL);
+        char *name = g_key_file_get_string(keyfile, ver, "name", NULL);
+        char *software = g_key_file_get_string(keyfile, ver, "software", NULL);
+        char *software_version = g_key_file_get_string(keyfile, ver, "software_version", NULL);
+        char *os = g_key_file_get_string(keyfile, ver, "os", NULL);
+        char *os_version = g_key_file_get_string(keyfile, ver, "os_version", NULL);
+
+        gsize features_len = 0;
+        gchar **features_list = g_key_file_get_string_list(keyfile, ver, "features", &features_len, NULL);
+        GSList *features = NULL;
+        gsize f;
+        for (f = 0; features_list && f < features_len; f++) {
+            features = g_slist_append(features, features_list[f]);
+        }
+
+        EntityCapabilities *caps = caps_create(category, type, name, software, software_version, os, os_version,
+            features);
+        _cache_add(ver, caps, out);
+        caps_destroy(caps);
+
+        g_free(category);
+        g_free(type);
+        g_free(name);
+        g_free(software);
+        g_free(software_version);
+        g_free(os);
+        g_free(os_version);
+        g_slist_free(features);
+        g_strfreev(features_list);
+    }
+    g_strfreev(groups);
+    g_key_file_free(keyfile);
+
+    gboolean written = _cache_append(out);
+    g_string_free(out, TRUE);
+
+    if (written) {
+        log_info("Migrated %d capabilities cache entries from %s", (int)groups_len, keyfile_loc);
+        g_remove(keyfile_loc);
+    }
 }
@@ -47,8 +47,12 @@
 
 #include "xmpp/xmpp.h"
 
+#define CAPS_FEATURE_BIT(id) ((guint64)1 << (id))
+
 void caps_init(void);
 
+int caps_feature_id(const char *const feature);
+
 EntityCapabilities* caps_create(const char *const category, const char *const type, const char *const name,
     const char *const software, const char *const software_version,
     const char *const os, const char *const os_version,
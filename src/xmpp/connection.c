@@ -50,8 +50,20 @@
 #include "config/preferences.h"
 #include "event/server_events.h"
 #include "xmpp/connection.h"
+#include "xmpp/capabilities.h"
 #include "xmpp/session.h"
 #include "xmpp/iq.h"
+#include "xmpp/stanza.h"
+#include "xmpp/stream_mgmt.h"
+
+// stream management (XEP-0198) progress on the current connection, the counts
+// that outlive it are kept in stream_mgmt.c
+typedef struct prof_sm_t {
+    gboolean supported;
+    gboolean counting;
+    gboolean enabled;
+    gboolean ack_requested;
+} ProfStreamManagement;
 
 typedef struct prof_conn_t {
     xmpp_log_t *xmpp_log;
@@ -63,6 +75,8 @@ typedef struct prof_conn_t {
     char *domain;
     GHashTable *available_resources;
     GHashTable *features_by_jid;
+    guint64 known_features;
+    ProfStreamManagement sm;
 } ProfConnection;
 
 static ProfConnection conn;
@@ -72,6 +86,22 @@ static void _xmpp_file_logger(void *const userdata, const xmpp_log_level_t level
 
 static void _connection_handler(xmpp_conn_t *const xmpp_conn, const xmpp_conn_event_t status, const int error,
     xmpp_stream_error_t *const stream_error, void *const userdata);
+static void _connection_login_success(void);
+static void _connection_set_domain(void);
+static void _connection_features_init(void);
+
+static void _connection_sm_handlers_add(void);
+static void _connection_sm_enable(void);
+static void _connection_sm_request_ack(void);
+static void _connection_sm_lost(void);
+static void _connection_sm_resend(GQueue *unacked);
+static gboolean _connection_sm_resendable(const char *const text);
+static gboolean _connection_sm_advertised(const char *const features);
+static int _connection_sm_inbound_handler(xmpp_conn_t *const xmpp_conn, xmpp_stanza_t *const stanza, void *const userdata);
+static int _connection_sm_enabled_handler(xmpp_conn_t *const xmpp_conn, xmpp_stanza_t *const stanza, void *const userdata);
+static int _connection_sm_failed_handler(xmpp_conn_t *const xmpp_conn, xmpp_stanza_t *const stanza, void *const userdata);
+static int _connection_sm_request_handler(xmpp_conn_t *const xmpp_conn, xmpp_stanza_t *const stanza, void *const userdata);
+static int _connection_sm_ack_handler(xmpp_conn_t *const xmpp_conn, xmpp_stanza_t *const stanza, void *const userdata);
 
 #ifdef HAVE_LIBMESODE
 TLSCertificate* _xmppcert_to_profcert(xmpp_tlscert_t *xmpptlscert);
@@ -88,7 +118,10 @@ connection_init(void)
     conn.presence_message = NULL;
     conn.domain = NULL;
     conn.features_by_jid = NULL;
+    conn.known_features = 0;
     conn.available_resources = g_hash_table_new_full(g_str_hash, g_str_equal, free, (GDestroyNotify)resource_destroy);
+    memset(&conn.sm, 0, sizeof(conn.sm));
+    stream_mgmt_init();
 }
 
 void
@@ -101,6 +134,8 @@ void
 connection_shutdown(void)
 {
     connection_clear_data();
+    connection_sm_clear();
+    stream_mgmt_shutdown();
     xmpp_shutdown();
 
     free(conn.xmpp_log);
@@ -147,6 +182,7 @@ connection_connect(const char *const jid, const char *const passwd, const char *
     }
     xmpp_conn_set_jid(conn.xmpp_conn, jid);
     xmpp_conn_set_pass(conn.xmpp_conn, passwd);
+    conn.sm.supported = FALSE;
 
     if (!tls_policy || (g_strcmp0(tls_policy, "force") == 0)) {
         xmpp_conn_set_flags(conn.xmpp_conn, XMPP_CONN_FLAG_MANDATORY_TLS);
@@ -189,6 +225,7 @@ connection_connect(const char *const jid, const char *const passwd, const char *
 void
 connection_disconnect(void)
 {
+    _connection_sm_lost();
     conn.conn_status = JABBER_DISCONNECTING;
     xmpp_disconnect(conn.xmpp_conn);
 
@@ -222,6 +259,7 @@ connection_clear_data(void)
         g_hash_table_destroy(conn.features_by_jid);
         conn.features_by_jid = NULL;
     }
+    conn.known_features = 0;
 
     if (conn.available_resources) {
         g_hash_table_remove_all(conn.available_resources);
@@ -257,13 +295,61 @@ connection_send_stanza(const char *const stanza)
         return FALSE;
     } else {
         xmpp_send_raw_string(conn.xmpp_conn, "%s", stanza);
+        connection_sm_queue_text(stanza);
         return TRUE;
     }
 }
 
+void
+connection_sm_clear(void)
+{
+    conn.sm.counting = FALSE;
+    conn.sm.enabled = FALSE;
+    conn.sm.ack_requested = FALSE;
+    stream_mgmt_clear();
+}
+
+void
+connection_sm_queue_stanza(xmpp_stanza_t *const stanza)
+{
+    if (!conn.sm.counting) {
+        return;
+    }
+
+    char *text;
+    size_t text_size;
+    if (xmpp_stanza_to_text(stanza, &text, &text_size) != 0) {
+        log_error("Stream management: could not serialise outgoing stanza");
+        return;
+    }
+
+    connection_sm_queue_text(text);
+    xmpp_free(conn.xmpp_ctx, text);
+}
+
+void
+connection_sm_queue_text(const char *const text)
+{
+    if (!conn.sm.counting) {
+        return;
+    }
+
+    stream_mgmt_queue(text);
+    _connection_sm_request_ack();
+}
+
 gboolean
 connection_supports(const char *const feature)
 {
+    int id = caps_feature_id(feature);
+    if (id >= 0) {
+        return (conn.known_features & CAPS_FEATURE_BIT(id)) != 0;
+    }
+
+    if (conn.features_by_jid == NULL) {
+        return FALSE;
+    }
+
     GList *jids = g_hash_table_get_keys(conn.features_by_jid);
 
     GList *curr = jids;
@@ -271,6 +357,7 @@ connection_supports(const char *const feature)
         char *jid = curr->data;
         GHashTable *features = g_hash_table_lookup(conn.features_by_jid, jid);
         if (features && g_hash_table_lookup(features, feature)) {
+            g_list_free(jids);
             return TRUE;
         }
 
@@ -358,6 +445,22 @@ connection_get_features(const char *const jid)
     return g_hash_table_lookup(conn.features_by_jid, jid);
 }
 
+void
+connection_add_feature(const char *const jid, const char *const feature)
+{
+    GHashTable *features = g_hash_table_lookup(conn.features_by_jid, jid);
+    if (features == NULL) {
+        return;
+    }
+
+    g_hash_table_add(features, strdup(feature));
+
+    int id = caps_feature_id(feature);
+    if (id >= 0) {
+        conn.known_features |= CAPS_FEATURE_BIT(id);
+    }
+}
+
 GList*
 connection_get_available_resources(void)
 {
@@ -426,16 +529,8 @@ _connection_handler(xmpp_conn_t *const xmpp_conn, const xmpp_conn_event_t status
     // login success
     case XMPP_CONN_CONNECT:
         log_debug("Connection handler: XMPP_CONN_CONNECT");
-        conn.conn_status = JABBER_CONNECTED;
-
-        Jid *my_jid = jid_create(xmpp_conn_get_jid(conn.xmpp_conn));
-        conn.domain = strdup(my_jid->domainpart);
-        jid_destroy(my_jid);
-
-        conn.features_by_jid = g_hash_table_new_full(g_str_hash, g_str_equal, free, (GDestroyNotify)g_hash_table_destroy);
-        g_hash_table_insert(conn.features_by_jid, strdup(conn.domain), g_hash_table_new_full(g_str_hash, g_str_equal, free, NULL));
-
-        session_login_success(connection_is_secured());
+        _connection_sm_handlers_add();
+        _connection_login_success();
 
         break;
 
@@ -446,6 +541,7 @@ _connection_handler(xmpp_conn_t *const xmpp_conn, const xmpp_conn_event_t status
         // lost connection for unknown reason
         if (conn.conn_status == JABBER_CONNECTED) {
             log_debug("Connection handler: Lost connection for unknown reason");
+            _connection_sm_lost();
             session_lost_connection();
 
         // login attempt failed
@@ -471,6 +567,213 @@ _connection_handler(xmpp_conn_t *const xmpp_conn, const xmpp_conn_event_t status
     }
 }
 
+static void
+_connection_login_success(void)
+{
+    conn.conn_status = JABBER_CONNECTED;
+    _connection_set_domain();
+    _connection_features_init();
+
+    // messages a lost connection never confirmed go out again on this one
+    GQueue *unacked = stream_mgmt_take_unacked();
+
+    // enable before anything is sent so the whole session is counted
+    _connection_sm_enable();
+
+    session_login_success(connection_is_secured());
+
+    _connection_sm_resend(unacked);
+}
+
+static void
+_connection_set_domain(void)
+{
+    FREE_SET_NULL(conn.domain);
+
+    Jid *my_jid = jid_create(xmpp_conn_get_jid(conn.xmpp_conn));
+    conn.domain = strdup(my_jid->domainpart);
+    jid_destroy(my_jid);
+}
+
+static void
+_connection_features_init(void)
+{
+    if (conn.features_by_jid) {
+        g_hash_table_destroy(conn.features_by_jid);
+    }
+    conn.features_by_jid = g_hash_table_new_full(g_str_hash, g_str_equal, free, (GDestroyNotify)g_hash_table_destroy);
+    g_hash_table_insert(conn.features_by_jid, strdup(conn.domain), g_hash_table_new_full(g_str_hash, g_str_equal, free, NULL));
+    conn.known_features = 0;
+}
+
+static void
+_connection_sm_handlers_add(void)
+{
+    xmpp_handler_add(conn.xmpp_conn, _connection_sm_inbound_handler, NULL, NULL, NULL, NULL);
+    xmpp_handler_add(conn.xmpp_conn, _connection_sm_enabled_handler, STANZA_NS_SM, STANZA_NAME_ENABLED, NULL, NULL);
+    xmpp_handler_add(conn.xmpp_conn, _connection_sm_failed_handler, STANZA_NS_SM, STANZA_NAME_FAILED, NULL, NULL);
+    xmpp_handler_add(conn.xmpp_conn, _connection_sm_request_handler, STANZA_NS_SM, STANZA_NAME_SM_REQUEST, NULL, NULL);
+    xmpp_handler_add(conn.xmpp_conn, _connection_sm_ack_handler, STANZA_NS_SM, STANZA_NAME_SM_ACK, NULL, NULL);
+}
+
+static void
+_connection_sm_enable(void)
+{
+    connection_sm_clear();
+    if (!conn.sm.supported) {
+        return;
+    }
+
+    xmpp_stanza_t *enable = stanza_create_sm_enable(conn.xmpp_ctx);
+    xmpp_send(conn.xmpp_conn, enable);
+    xmpp_stanza_release(enable);
+
+    // the server counts our stanzas from the enable request, its own from the reply
+    conn.sm.counting = TRUE;
+}
+
+static void
+_connection_sm_request_ack(void)
+{
+    // one request in flight at a time, the answer covers everything sent before it
+    if (!conn.sm.enabled || conn.sm.ack_requested || !stream_mgmt_has_unacked()) {
+        return;
+    }
+
+    xmpp_stanza_t *request = stanza_create_sm_request(conn.xmpp_ctx);
+    xmpp_send(conn.xmpp_conn, request);
+    xmpp_stanza_release(request);
+    conn.sm.ack_requested = TRUE;
+}
+
+static void
+_connection_sm_lost(void)
+{
+    conn.sm.counting = FALSE;
+    conn.sm.enabled = FALSE;
+    conn.sm.ack_requested = FALSE;
+}
+
+static void
+_connection_sm_resend(GQueue *unacked)
+{
+    char *text = g_queue_pop_head(unacked);
+    while (text) {
+        if (_connection_sm_resendable(text)) {
+            xmpp_send_raw_string(conn.xmpp_conn, "%s", text);
+            connection_sm_queue_text(text);
+        }
+        free(text);
+        text = g_queue_pop_head(unacked);
+    }
+    g_queue_free(unacked);
+}
+
+// only chat messages go out again on a new session, groupchat messages would be
+// sent to rooms that have not been joined again yet
+static gboolean
+_connection_sm_resendable(const char *const text)
+{
+    if (!g_str_has_prefix(text, "<" STANZA_NAME_MESSAGE " ")) {
+        return FALSE;
+    }
+
+    const char *end = strchr(text, '>');
+    gchar *tag = end ? g_strndup(text, end - text) : g_strdup(text);
+    gboolean groupchat = strstr(tag, "type=\"" STANZA_TYPE_GROUPCHAT "\"") ||
+        strstr(tag, "type='" STANZA_TYPE_GROUPCHAT "'");
+    g_free(tag);
+
+    return !groupchat;
+}
+
+// the features sent after authentication are the last ones before login, so they decide
+static gboolean
+_connection_sm_advertised(const char *const features)
+{
+    gboolean advertised = FALSE;
+
+    const char *sm = strstr(features, "<" STANZA_NAME_SM " ");
+    while (sm && !advertised) {
+        const char *end = strchr(sm, '>');
+        if (end == NULL) {
+            break;
+        }
+        gchar *tag = g_strndup(sm, end - sm);
+        advertised = strstr(tag, "xmlns=\"" STANZA_NS_SM "\"") || strstr(tag, "xmlns='" STANZA_NS_SM "'");
+        g_free(tag);
+        sm = strstr(end, "<" STANZA_NAME_SM " ");
+    }
+
+    return advertised;
+}
+
+static int
+_connection_sm_inbound_handler(xmpp_conn_t *const xmpp_conn, xmpp_stanza_t *const stanza, void *const userdata)
+{
+    if (!conn.sm.enabled) {
+        return 1;
+    }
+
+    const char *name = xmpp_stanza_get_name(stanza);
+    if ((g_strcmp0(name, STANZA_NAME_MESSAGE) == 0) || (g_strcmp0(name, STANZA_NAME_PRESENCE) == 0) ||
+            (g_strcmp0(name, STANZA_NAME_IQ) == 0)) {
+        stream_mgmt_handled();
+    }
+
+    return 1;
+}
+
+static int
+_connection_sm_enabled_handler(xmpp_conn_t *const xmpp_conn, xmpp_stanza_t *const stanza, void *const userdata)
+{
+    conn.sm.enabled = TRUE;
+    stream_mgmt_enabled();
+
+    log_info("Stream management enabled");
+
+    _connection_sm_request_ack();
+
+    return 1;
+}
+
+static int
+_connection_sm_failed_handler(xmpp_conn_t *const xmpp_conn, xmpp_stanza_t *const stanza, void *const userdata)
+{
+    log_info("Stream management: server refused to enable");
+    connection_sm_clear();
+
+    return 1;
+}
+
+static int
+_connection_sm_request_handler(xmpp_conn_t *const xmpp_conn, xmpp_stanza_t *const stanza, void *const userdata)
+{
+    if (!conn.sm.enabled) {
+        return 1;
+    }
+
+    xmpp_stanza_t *ack = stanza_create_sm_ack(conn.xmpp_ctx, stream_mgmt_get_handled());
+    xmpp_send(conn.xmpp_conn, ack);
+    xmpp_stanza_release(ack);
+
+    return 1;
+}
+
+static int
+_connection_sm_ack_handler(xmpp_conn_t *const xmpp_conn, xmpp_stanza_t *const stanza, void *const userdata)
+{
+    if (!conn.sm.enabled) {
+        return 1;
+    }
+
+    conn.sm.ack_requested = FALSE;
+    stream_mgmt_acked(xmpp_stanza_get_attribute(stanza, STANZA_ATTR_H));
+    _connection_sm_request_ack();
+
+    return 1;
+}
+
 #ifdef HAVE_LIBMESODE
 static int
 _connection_certfail_cb(xmpp_tlscert_t *xmpptlscert, const char *const errormsg)
@@ -536,4 +839,13 @@ _xmpp_file_logger(void *const userdata, const xmpp_log_level_t xmpp_level, const
     if ((g_strcmp0(area, "xmpp") == 0) || (g_strcmp0(area, "conn")) == 0) {
         sv_ev_xmpp_stanza(msg);
     }
+
+    // libstrophe handles stream features itself and only passes stanzas to handlers once the
+    // session is established, the features it received are logged here as stanza text
+    if ((g_strcmp0(area, "xmpp") == 0) && g_str_has_prefix(msg, "RECV: ")) {
+        const char *stanza = msg + strlen("RECV: ");
+        if (g_str_has_prefix(stanza, "<stream:features") || g_str_has_prefix(stanza, "<features")) {
+            conn.sm.supported = _connection_sm_advertised(stanza);
+        }
+    }
 }
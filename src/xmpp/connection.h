@@ -54,9 +54,14 @@ xmpp_conn_t* connection_get_conn(void);
 xmpp_ctx_t* connection_get_ctx(void);
 char *connection_get_domain(void);
 GHashTable* connection_get_features(const char *const jid);
+void connection_add_feature(const char *const jid, const char *const feature);
 
 void connection_clear_data(void);
 
+void connection_sm_clear(void);
+void connection_sm_queue_stanza(xmpp_stanza_t *const stanza);
+void connection_sm_queue_text(const char *const text);
+
 void connection_add_available_resource(Resource *resource);
 void connection_remove_available_resource(const char *const resource);
 
@@ -135,13 +135,15 @@ _iq_handler(xmpp_conn_t *const conn, xmpp_stanza_t *const stanza, void *const us
 {
     log_debug("iq stanza handler fired");
 
-    char *text;
-    size_t text_size;
-    xmpp_stanza_to_text(stanza, &text, &text_size);
-    gboolean cont = plugins_on_iq_stanza_receive(text);
-    xmpp_free(connection_get_ctx(), text);
-    if (!cont) {
-        return 1;
+    if (plugins_has_hook(PLUGIN_HOOK_IQ_STANZA_RECEIVE)) {
+        char *text;
+        size_t text_size;
+        xmpp_stanza_to_text(stanza, &text, &text_size);
+        gboolean cont = plugins_on_iq_stanza_receive(text);
+        xmpp_free(connection_get_ctx(), text);
+        if (!cont) {
+            return 1;
+        }
     }
 
     const char *type = xmpp_stanza_get_type(stanza);
@@ -182,7 +184,9 @@ _iq_handler(xmpp_conn_t *const conn, xmpp_stanza_t *const stanza, void *const us
     if (roster && (g_strcmp0(type, STANZA_TYPE_SET) == 0)) {
         roster_set_handler(stanza);
     }
-    if (roster && (g_strcmp0(type, STANZA_TYPE_RESULT) == 0)) {
+    // a versioned roster request is answered without a query when unchanged, the
+    // handler checks it came from the server
+    if ((roster || g_strcmp0(xmpp_stanza_get_id(stanza), "roster") == 0) && (g_strcmp0(type, STANZA_TYPE_RESULT) == 0)) {
         roster_result_handler(stanza);
     }
 
@@ -1911,7 +1915,7 @@ _disco_info_response_id_handler_onconnect(xmpp_stanza_t *const stanza, void *con
             if (g_strcmp0(stanza_name, STANZA_NAME_FEATURE) == 0) {
                 const char *var = xmpp_stanza_get_attribute(child, STANZA_ATTR_VAR);
                 if (var) {
-                    g_hash_table_add(features, strdup(var));
+                    connection_add_feature(from, var);
                 }
             }
             child = xmpp_stanza_get_next(child);
@@ -2035,17 +2039,25 @@ _disco_items_result_handler(xmpp_stanza_t *const stanza)
 void
 iq_send_stanza(xmpp_stanza_t *const stanza)
 {
+    xmpp_conn_t *conn = connection_get_conn();
+    if (!plugins_has_hook(PLUGIN_HOOK_IQ_STANZA_SEND)) {
+        xmpp_send(conn, stanza);
+        connection_sm_queue_stanza(stanza);
+        return;
+    }
+
     char *text;
     size_t text_size;
     xmpp_stanza_to_text(stanza, &text, &text_size);
 
-    xmpp_conn_t *conn = connection_get_conn();
     char *plugin_text = plugins_on_iq_stanza_send(text);
     if (plugin_text) {
         xmpp_send_raw_string(conn, "%s", plugin_text);
+        connection_sm_queue_text(plugin_text);
         free(plugin_text);
     } else {
         xmpp_send_raw_string(conn, "%s", text);
+        connection_sm_queue_text(text);
     }
     xmpp_free(connection_get_ctx(), text);
 
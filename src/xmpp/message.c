@@ -79,13 +79,15 @@ _message_handler(xmpp_conn_t *const conn, xmpp_stanza_t *const stanza, void *con
 {
     log_debug("Message stanza handler fired");
 
-    char *text;
-    size_t text_size;
-    xmpp_stanza_to_text(stanza, &text, &text_size);
-    gboolean cont = plugins_on_message_stanza_receive(text);
-    xmpp_free(connection_get_ctx(), text);
-    if (!cont) {
-        return 1;
+    if (plugins_has_hook(PLUGIN_HOOK_MESSAGE_STANZA_RECEIVE)) {
+        char *text;
+        size_t text_size;
+        xmpp_stanza_to_text(stanza, &text, &text_size);
+        gboolean cont = plugins_on_message_stanza_receive(text);
+        xmpp_free(connection_get_ctx(), text);
+        if (!cont) {
+            return 1;
+        }
     }
 
     const char *type = xmpp_stanza_get_type(stanza);
@@ -846,17 +848,25 @@ _handle_chat(xmpp_stanza_t *const stanza)
 static void
 _send_message_stanza(xmpp_stanza_t *const stanza)
 {
+    xmpp_conn_t *conn = connection_get_conn();
+    if (!plugins_has_hook(PLUGIN_HOOK_MESSAGE_STANZA_SEND)) {
+        xmpp_send(conn, stanza);
+        connection_sm_queue_stanza(stanza);
+        return;
+    }
+
     char *text;
     size_t text_size;
     xmpp_stanza_to_text(stanza, &text, &text_size);
 
-    xmpp_conn_t *conn = connection_get_conn();
     char *plugin_text = plugins_on_message_stanza_send(text);
     if (plugin_text) {
         xmpp_send_raw_string(conn, "%s", plugin_text);
+        connection_sm_queue_text(plugin_text);
         free(plugin_text);
     } else {
         xmpp_send_raw_string(conn, "%s", text);
+        connection_sm_queue_text(text);
     }
     xmpp_free(connection_get_ctx(), text);
 }
@@ -39,7 +39,9 @@
 #include <glib.h>
 
 #include "common.h"
+#include "config/preferences.h"
 #include "tools/autocomplete.h"
+#include "tools/matcher.h"
 #include "ui/ui.h"
 #include "ui/window_list.h"
 #include "xmpp/jid.h"
@@ -59,25 +61,41 @@ typedef struct _muc_room_t {
     gboolean autojoin;
     gboolean pending_nick_change;
     GHashTable *roster;
+    // occupants in nick order, kept sorted as the roster changes
+    GSequence *roster_sorted;
     Autocomplete nick_ac;
     Autocomplete jid_ac;
     GHashTable *nick_changes;
     gboolean roster_received;
     muc_member_type_t member_type;
+
+    // scanner for our nick and the room triggers, rebuilt when either changes
+    Matcher matcher;
+    GList *matcher_triggers;
+    guint matcher_triggers_generation;
 } ChatRoom;
 
+// matcher id for our nick, triggers use their position in the trigger list
+#define MUC_MATCH_NICK -1
+
 GHashTable *rooms = NULL;
 GHashTable *invite_passwords = NULL;
 Autocomplete invite_ac;
 
 static void _free_room(ChatRoom *room);
+static void _muc_matcher_build(ChatRoom *chat_room);
+static void _muc_matcher_clear(ChatRoom *chat_room);
 static gint _compare_occupants(Occupant *a, Occupant *b);
+static gint _compare_occupants_data(Occupant *a, Occupant *b, gpointer data);
+static void _muc_roster_remove(ChatRoom *chat_room, const char *const nick);
 static muc_role_t _role_from_string(const char *const role);
 static muc_affiliation_t _affiliation_from_string(const char *const affiliation);
 static char* _role_to_string(muc_role_t role);
 static char* _affiliation_to_string(muc_affiliation_t affiliation);
 static Occupant* _muc_occupant_new(const char *const nick, const char *const jid, muc_role_t role,
     muc_affiliation_t affiliation, resource_presence_t presence, const char *const status);
+static void _muc_occupant_update(Occupant *occupant, const char *const jid, muc_role_t role,
+    muc_affiliation_t affiliation, resource_presence_t presence, const char *const status);
 static void _occupant_free(Occupant *occupant);
 
 void
@@ -189,6 +207,7 @@ muc_join(const char *const room, const char *const nick, const char *const passw
     new_room->pending_broadcasts = NULL;
     new_room->pending_config = FALSE;
     new_room->roster = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)_occupant_free);
+    new_room->roster_sorted = g_sequence_new(NULL);
     new_room->nick_ac = autocomplete_new();
     new_room->jid_ac = autocomplete_new();
     new_room->nick_changes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
@@ -196,6 +215,9 @@ muc_join(const char *const room, const char *const nick, const char *const passw
     new_room->pending_nick_change = FALSE;
     new_room->autojoin = autojoin;
     new_room->member_type = MUC_MEMBER_TYPE_UNKNOWN;
+    new_room->matcher = NULL;
+    new_room->matcher_triggers = NULL;
+    new_room->matcher_triggers_generation = 0;
 
     g_hash_table_insert(rooms, strdup(room), new_room);
 }
@@ -355,10 +377,11 @@ muc_nick_change_complete(const char *const room, const char *const nick)
 {
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
-        g_hash_table_remove(chat_room->roster, chat_room->nick);
+        _muc_roster_remove(chat_room, chat_room->nick);
         autocomplete_remove(chat_room->nick_ac, chat_room->nick);
         free(chat_room->nick);
         chat_room->nick = strdup(nick);
+        _muc_matcher_clear(chat_room);
         chat_room->pending_nick_change = FALSE;
         g_hash_table_remove(chat_room->nick_changes, nick);
     }
@@ -442,11 +465,17 @@ muc_roster_add(const char *const room, const char *const nick, const char *const
             updated = TRUE;
         }
 
-        resource_presence_t presence = resource_presence_from_string(show);
         muc_role_t role_t = _role_from_string(role);
         muc_affiliation_t affiliation_t = _affiliation_from_string(affiliation);
-        Occupant *occupant = _muc_occupant_new(nick, jid, role_t, affiliation_t, presence, status);
-        g_hash_table_replace(chat_room->roster, strdup(nick), occupant);
+        if (old) {
+            // the nick is unchanged, so the occupant keeps its place in the sorted roster
+            _muc_occupant_update(old, jid, role_t, affiliation_t, new_presence, status);
+        } else {
+            Occupant *occupant = _muc_occupant_new(nick, jid, role_t, affiliation_t, new_presence, status);
+            g_hash_table_insert(chat_room->roster, strdup(nick), occupant);
+            occupant->sorted_iter = g_sequence_insert_sorted(chat_room->roster_sorted, occupant,
+                (GCompareDataFunc)_compare_occupants_data, NULL);
+        }
 
         if (jid) {
             Jid *jidp = jid_create(jid);
@@ -468,7 +497,7 @@ muc_roster_remove(const char *const room, const char *const nick)
 {
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
-        g_hash_table_remove(chat_room->roster, nick);
+        _muc_roster_remove(chat_room, nick);
         autocomplete_remove(chat_room->nick_ac, nick);
     }
 }
@@ -494,16 +523,12 @@ muc_roster(const char *const room)
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
         GList *result = NULL;
-        GList *occupants = g_hash_table_get_values(chat_room->roster);
-
-        GList *curr = occupants;
-        while (curr) {
-            result = g_list_insert_sorted(result, curr->data, (GCompareFunc)_compare_occupants);
-            curr = g_list_next(curr);
+        GSequenceIter *curr = g_sequence_get_end_iter(chat_room->roster_sorted);
+        while (!g_sequence_iter_is_begin(curr)) {
+            curr = g_sequence_iter_prev(curr);
+            result = g_list_prepend(result, g_sequence_get(curr));
         }
 
-        g_list_free(occupants);
-
         return result;
     } else {
         return NULL;
@@ -584,16 +609,14 @@ muc_occupants_by_role(const char *const room, muc_role_t role)
 {
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
+        // walk the sorted roster backwards, prepending keeps the result in order
         GSList *result = NULL;
-        GHashTableIter iter;
-        gpointer key;
-        gpointer value;
-
-        g_hash_table_iter_init(&iter, chat_room->roster);
-        while (g_hash_table_iter_next(&iter, &key, &value)) {
-            Occupant *occupant = (Occupant *)value;
+        GSequenceIter *curr = g_sequence_get_end_iter(chat_room->roster_sorted);
+        while (!g_sequence_iter_is_begin(curr)) {
+            curr = g_sequence_iter_prev(curr);
+            Occupant *occupant = g_sequence_get(curr);
             if (occupant->role == role) {
-                result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_occupants);
+                result = g_slist_prepend(result, occupant);
             }
         }
         return result;
@@ -608,15 +631,12 @@ muc_occupants_by_affiliation(const char *const room, muc_affiliation_t affiliati
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
         GSList *result = NULL;
-        GHashTableIter iter;
-        gpointer key;
-        gpointer value;
-
-        g_hash_table_iter_init(&iter, chat_room->roster);
-        while (g_hash_table_iter_next(&iter, &key, &value)) {
-            Occupant *occupant = (Occupant *)value;
+        GSequenceIter *curr = g_sequence_get_end_iter(chat_room->roster_sorted);
+        while (!g_sequence_iter_is_begin(curr)) {
+            curr = g_sequence_iter_prev(curr);
+            Occupant *occupant = g_sequence_get(curr);
             if (occupant->affiliation == affiliation) {
-                result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_occupants);
+                result = g_slist_prepend(result, occupant);
             }
         }
         return result;
@@ -686,7 +706,12 @@ muc_autocomplete(ProfWin *window, const char *const input)
                 }
             }
 
-            char *result = autocomplete_complete(chat_room->nick_ac, search_str, FALSE);
+            char *result = NULL;
+            if (prefs_get_boolean(PREF_COMPLETION_FUZZY)) {
+                result = autocomplete_complete_fuzzy(chat_room->nick_ac, search_str, FALSE);
+            } else {
+                result = autocomplete_complete(chat_room->nick_ac, search_str, FALSE);
+            }
             if (result) {
                 GString *replace_with = g_string_new(chat_room->autocomplete_prefix);
                 g_string_append(replace_with, result);
@@ -704,6 +729,91 @@ muc_autocomplete(ProfWin *window, const char *const input)
     return NULL;
 }
 
+/*
+ * Find mentions of our nick and the configured room triggers in a single
+ * pass over the message. Mentions are returned as character offsets, and
+ * triggers as copies of each trigger found, in the configured order
+ */
+void
+muc_message_scan(const char *const room, const char *const message, gboolean whole_word,
+    gboolean case_sensitive, GSList **mentions, GList **triggers)
+{
+    ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
+    if (!chat_room || !message) {
+        return;
+    }
+
+    if (chat_room->matcher &&
+            chat_room->matcher_triggers_generation != prefs_get_room_notify_triggers_generation()) {
+        _muc_matcher_clear(chat_room);
+    }
+    if (!chat_room->matcher) {
+        _muc_matcher_build(chat_room);
+    }
+
+    gchar *message_lower = g_utf8_strdown(message, -1);
+    gboolean aligned = strlen(message_lower) == strlen(message);
+    size_t nick_len = strlen(chat_room->nick);
+    gboolean *found_triggers = g_new0(gboolean, g_list_length(chat_room->matcher_triggers) + 1);
+
+    GSList *found_mentions = NULL;
+    GSList *matches = matcher_find_all(chat_room->matcher, message_lower);
+    GSList *curr = matches;
+    while (curr) {
+        MatcherMatch *match = curr->data;
+        curr = g_slist_next(curr);
+
+        if (match->id != MUC_MATCH_NICK) {
+            found_triggers[match->id] = TRUE;
+            continue;
+        }
+
+        if (case_sensitive) {
+            const char *original = aligned ? message + match->start : g_utf8_offset_to_pointer(message, match->offset);
+            if (strncmp(original, chat_room->nick, nick_len) != 0) {
+                continue;
+            }
+        }
+
+        if (whole_word) {
+            gunichar before = 0;
+            if (match->start > 0) {
+                before = g_utf8_get_char(g_utf8_prev_char(message_lower + match->start));
+            }
+            gunichar after = g_utf8_get_char(message_lower + match->start + match->len);
+            if (g_unichar_isalnum(before) || g_unichar_isalnum(after)) {
+                continue;
+            }
+        }
+
+        found_mentions = g_slist_prepend(found_mentions, GINT_TO_POINTER(match->offset));
+    }
+    g_slist_free_full(matches, free);
+    g_free(message_lower);
+
+    *mentions = g_slist_concat(*mentions, g_slist_reverse(found_mentions));
+
+    int i = 0;
+    GList *trigger = chat_room->matcher_triggers;
+    while (trigger) {
+        if (found_triggers[i]) {
+            *triggers = g_list_append(*triggers, strdup(trigger->data));
+        }
+        i++;
+        trigger = g_list_next(trigger);
+    }
+    g_free(found_triggers);
+}
+
+void
+muc_nick_mark_used(const char *const room, const char *const nick)
+{
+    ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
+    if (chat_room) {
+        autocomplete_mark_used(chat_room->nick_ac, nick);
+    }
+}
+
 void
 muc_jid_autocomplete_reset(const char *const room)
 {
@@ -814,6 +924,9 @@ _free_room(ChatRoom *room)
         free(room->subject);
         free(room->password);
         free(room->autocomplete_prefix);
+        if (room->roster_sorted) {
+            g_sequence_free(room->roster_sorted);
+        }
         if (room->roster) {
             g_hash_table_destroy(room->roster);
         }
@@ -825,6 +938,7 @@ _free_room(ChatRoom *room)
         if (room->pending_broadcasts) {
             g_list_free_full(room->pending_broadcasts, free);
         }
+        _muc_matcher_clear(room);
         free(room);
     }
 }
@@ -840,6 +954,22 @@ _compare_occupants(Occupant *a, Occupant *b)
     return result;
 }
 
+static gint
+_compare_occupants_data(Occupant *a, Occupant *b, gpointer data)
+{
+    return _compare_occupants(a, b);
+}
+
+static void
+_muc_roster_remove(ChatRoom *chat_room, const char *const nick)
+{
+    Occupant *occupant = g_hash_table_lookup(chat_room->roster, nick);
+    if (occupant) {
+        g_sequence_remove(occupant->sorted_iter);
+        g_hash_table_remove(chat_room->roster, nick);
+    }
+}
+
 static muc_role_t
 _role_from_string(const char *const role)
 {
@@ -963,10 +1093,30 @@ _muc_occupant_new(const char *const nick, const char *const jid, muc_role_t role
 
     occupant->role = role;
     occupant->affiliation = affiliation;
+    occupant->sorted_iter = NULL;
 
     return occupant;
 }
 
+static void
+_muc_occupant_update(Occupant *occupant, const char *const jid, muc_role_t role, muc_affiliation_t affiliation,
+    resource_presence_t presence, const char *const status)
+{
+    if (g_strcmp0(occupant->jid, jid) != 0) {
+        free(occupant->jid);
+        occupant->jid = jid ? strdup(jid) : NULL;
+    }
+
+    if (g_strcmp0(occupant->status, status) != 0) {
+        free(occupant->status);
+        occupant->status = status ? strdup(status) : NULL;
+    }
+
+    occupant->presence = presence;
+    occupant->role = role;
+    occupant->affiliation = affiliation;
+}
+
 static void
 _occupant_free(Occupant *occupant)
 {
@@ -978,3 +1128,35 @@ _occupant_free(Occupant *occupant)
         free(occupant);
     }
 }
+
+static void
+_muc_matcher_build(ChatRoom *chat_room)
+{
+    chat_room->matcher = matcher_new();
+
+    gchar *nick_lower = g_utf8_strdown(chat_room->nick, -1);
+    matcher_add(chat_room->matcher, nick_lower, MUC_MATCH_NICK);
+    g_free(nick_lower);
+
+    chat_room->matcher_triggers = prefs_get_room_notify_triggers();
+    chat_room->matcher_triggers_generation = prefs_get_room_notify_triggers_generation();
+
+    int i = 0;
+    GList *curr = chat_room->matcher_triggers;
+    while (curr) {
+        gchar *trigger_lower = g_utf8_strdown(curr->data, -1);
+        matcher_add(chat_room->matcher, trigger_lower, i);
+        g_free(trigger_lower);
+        i++;
+        curr = g_list_next(curr);
+    }
+}
+
+static void
+_muc_matcher_clear(ChatRoom *chat_room)
+{
+    matcher_free(chat_room->matcher);
+    chat_room->matcher = NULL;
+    g_list_free_full(chat_room->matcher_triggers, free);
+    chat_room->matcher_triggers = NULL;
+}
@@ -71,6 +71,8 @@ typedef struct _muc_occupant_t {
     muc_affiliation_t affiliation;
     resource_presence_t presence;
     char *status;
+    // position in the room's sorted roster
+    GSequenceIter *sorted_iter;
 } Occupant;
 
 void muc_init(void);
@@ -104,6 +106,9 @@ GList* muc_roster(const char *const room);
 Autocomplete muc_roster_ac(const char *const room);
 Autocomplete muc_roster_jid_ac(const char *const room);
 void muc_jid_autocomplete_reset(const char *const room);
+void muc_nick_mark_used(const char *const room, const char *const nick);
+void muc_message_scan(const char *const room, const char *const message, gboolean whole_word,
+    gboolean case_sensitive, GSList **mentions, GList **triggers);
 void muc_jid_autocomplete_add_all(const char *const room, GSList *jids);
 
 Occupant* muc_roster_item(const char *const room, const char *const nick);
@@ -50,6 +50,7 @@
 
 #include "profanity.h"
 #include "log.h"
+#include "common.h"
 #include "config/preferences.h"
 #include "plugins/plugins.h"
 #include "event/server_events.h"
@@ -60,6 +61,7 @@
 #include "xmpp/iq.h"
 #include "xmpp/connection.h"
 #include "xmpp/roster.h"
+#include "xmpp/roster_cache.h"
 #include "xmpp/roster_list.h"
 #include "xmpp/stanza.h"
 #include "xmpp/xmpp.h"
@@ -77,12 +79,17 @@ static void _free_group_data(GroupData *data);
 
 // helper functions
 GSList* _get_groups_from_item(xmpp_stanza_t *item);
+static gboolean _roster_from_self(xmpp_stanza_t *const stanza);
 
 void
 roster_request(void)
 {
+    Jid *my_jid = jid_create(connection_get_fulljid());
+    roster_cache_load(my_jid ? my_jid->barejid : NULL);
+    jid_destroy(my_jid);
+
     xmpp_ctx_t * const ctx = connection_get_ctx();
-    xmpp_stanza_t *iq = stanza_create_roster_iq(ctx);
+    xmpp_stanza_t *iq = stanza_create_roster_iq(ctx, roster_cache_get_ver());
     iq_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
@@ -217,13 +224,9 @@ roster_set_handler(xmpp_stanza_t *const stanza)
     }
 
     // if from attribute exists and it is not current users barejid, ignore push
-    Jid *my_jid = jid_create(connection_get_fulljid());
-    const char *from = xmpp_stanza_get_from(stanza);
-    if (from && (strcmp(from, my_jid->barejid) != 0)) {
-        jid_destroy(my_jid);
+    if (!_roster_from_self(stanza)) {
         return;
     }
-    jid_destroy(my_jid);
 
     const char *barejid = xmpp_stanza_get_attribute(item, STANZA_ATTR_JID);
     gchar *barejid_lower = g_utf8_strdown(barejid, -1);
@@ -270,6 +273,8 @@ roster_set_handler(xmpp_stanza_t *const stanza)
 
     g_free(barejid_lower);
 
+    roster_cache_push(xmpp_stanza_get_attribute(query, STANZA_ATTR_VER));
+
     return;
 }
 
@@ -282,8 +287,30 @@ roster_result_handler(xmpp_stanza_t *const stanza)
         return;
     }
 
+    // an empty result would otherwise let anyone keep a stale cached roster
+    if (!_roster_from_self(stanza)) {
+        log_warning("Ignoring roster result from %s", xmpp_stanza_get_from(stanza));
+        return;
+    }
+
     // handle initial roster response
     xmpp_stanza_t *query = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_QUERY);
+
+    // unchanged since the cached version, any changes follow as pushes
+    if (query == NULL) {
+        if (!roster_cache_is_loaded()) {
+            log_warning("Empty roster result without a cached roster");
+        }
+        sv_ev_roster_received();
+        return;
+    }
+
+    // the full roster replaces the cached one
+    if (roster_cache_is_loaded()) {
+        roster_destroy();
+        roster_create();
+    }
+
     xmpp_stanza_t *item = xmpp_stanza_get_children(query);
 
     while (item) {
@@ -312,6 +339,8 @@ roster_result_handler(xmpp_stanza_t *const stanza)
         item = xmpp_stanza_get_next(item);
     }
 
+    roster_cache_replace(xmpp_stanza_get_attribute(query, STANZA_ATTR_VER));
+
     sv_ev_roster_received();
 
     return;
@@ -345,3 +374,18 @@ _free_group_data(GroupData *data)
         free(data);
     }
 }
+
+static gboolean
+_roster_from_self(xmpp_stanza_t *const stanza)
+{
+    const char *from = xmpp_stanza_get_from(stanza);
+    if (from == NULL) {
+        return TRUE;
+    }
+
+    Jid *my_jid = jid_create(connection_get_fulljid());
+    gboolean result = my_jid && g_strcmp0(from, my_jid->barejid) == 0;
+    jid_destroy(my_jid);
+
+    return result;
+}
@@ -0,0 +1,262 @@
+/*
+ * roster_cache.c
+ *
+ * Copyright (C) 2012 - 2017 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "log.h"
+#include "common.h"
+#include "config/files.h"
+#include "xmpp/contact.h"
+#include "xmpp/roster_cache.h"
+#include "xmpp/roster_list.h"
+
+#define ROSTER_CACHE_GROUP "roster"
+#define ROSTER_CACHE_CONTACT_PREFIX "contact "
+
+// local copy of a versioned roster (XEP-0237), only kept when the server
+// returns a roster version
+static char *cacheloc;
+static char *ver;
+static gboolean loaded;
+static gboolean dirty;
+
+static void _roster_cache_save(void);
+
+static char*
+_roster_cache_path(const char *const barejid)
+{
+    char *rosterdir = files_get_data_path(DIR_ROSTER);
+    errno = 0;
+    if (g_mkdir_with_parents(rosterdir, S_IRWXU) == -1) {
+        log_error("Error creating directory: %s, %s", rosterdir, strerror(errno));
+    }
+
+    gchar *account_file = str_replace(barejid, "@", "_at_");
+    char *result = g_strdup_printf("%s/%s", rosterdir, account_file);
+    free(account_file);
+    free(rosterdir);
+
+    return result;
+}
+
+// contacts are read into the roster list, which must be empty
+void
+roster_cache_load(const char *const barejid)
+{
+    roster_cache_close();
+
+    if (barejid == NULL) {
+        return;
+    }
+
+    cacheloc = _roster_cache_path(barejid);
+    if (!g_file_test(cacheloc, G_FILE_TEST_EXISTS)) {
+        return;
+    }
+
+    GKeyFile *cache = g_key_file_new();
+    if (!g_key_file_load_from_file(cache, cacheloc, G_KEY_FILE_NONE, NULL)) {
+        g_key_file_free(cache);
+        return;
+    }
+
+    char *cached_ver = g_key_file_get_string(cache, ROSTER_CACHE_GROUP, "ver", NULL);
+    if (cached_ver == NULL) {
+        g_key_file_free(cache);
+        return;
+    }
+
+    // jids may hold characters group names cannot, so groups are numbered
+    gsize groups_len = 0;
+    gchar **groups = g_key_file_get_groups(cache, &groups_len);
+    int contacts = 0;
+    gsize i;
+    for (i = 0; i < groups_len; i++) {
+        if (!g_str_has_prefix(groups[i], ROSTER_CACHE_CONTACT_PREFIX)) {
+            continue;
+        }
+
+        char *contact_jid = g_key_file_get_string(cache, groups[i], "jid", NULL);
+        if (contact_jid == NULL) {
+            continue;
+        }
+        char *name = g_key_file_get_string(cache, groups[i], "name", NULL);
+        char *sub = g_key_file_get_string(cache, groups[i], "subscription", NULL);
+        gboolean pending_out = g_key_file_get_boolean(cache, groups[i], "pending_out", NULL);
+
+        GSList *contact_groups = NULL;
+        gsize contact_groups_len = 0;
+        gchar **contact_groups_list = g_key_file_get_string_list(cache, groups[i], "groups", &contact_groups_len, NULL);
+        gsize j;
+        for (j = 0; contact_groups_list && j < contact_groups_len; j++) {
+            contact_groups = g_slist_append(contact_groups, strdup(contact_groups_list[j]));
+        }
+        g_strfreev(contact_groups_list);
+
+        if (roster_add(contact_jid, name, contact_groups, sub, pending_out)) {
+            contacts++;
+        }
+
+        g_free(contact_jid);
+        g_free(name);
+        g_free(sub);
+    }
+    g_strfreev(groups);
+    g_key_file_free(cache);
+
+    ver = strdup(cached_ver);
+    g_free(cached_ver);
+    loaded = TRUE;
+
+    log_info("Loaded %d contacts from roster cache, version %s", contacts, ver);
+}
+
+void
+roster_cache_close(void)
+{
+    if (dirty) {
+        _roster_cache_save();
+    }
+
+    free(cacheloc);
+    cacheloc = NULL;
+    free(ver);
+    ver = NULL;
+    loaded = FALSE;
+    dirty = FALSE;
+}
+
+gboolean
+roster_cache_is_loaded(void)
+{
+    return loaded;
+}
+
+const char*
+roster_cache_get_ver(void)
+{
+    return ver;
+}
+
+// pushes are saved with the roster on close
+void
+roster_cache_push(const char *const push_ver)
+{
+    if (push_ver) {
+        free(ver);
+        ver = strdup(push_ver);
+    }
+    dirty = TRUE;
+}
+
+// the full roster is in the roster list, a roster without a version is not kept
+void
+roster_cache_replace(const char *const roster_ver)
+{
+    free(ver);
+    ver = roster_ver ? strdup(roster_ver) : NULL;
+    loaded = FALSE;
+    dirty = FALSE;
+
+    if (ver) {
+        _roster_cache_save();
+    } else if (cacheloc) {
+        g_remove(cacheloc);
+    }
+}
+
+static void
+_roster_cache_save(void)
+{
+    if (cacheloc == NULL || ver == NULL) {
+        return;
+    }
+
+    GKeyFile *cache = g_key_file_new();
+    g_key_file_set_string(cache, ROSTER_CACHE_GROUP, "ver", ver);
+
+    GSList *contacts = roster_get_contacts(ROSTER_ORD_NAME);
+    GSList *curr = contacts;
+    int index = 0;
+    while (curr) {
+        PContact contact = curr->data;
+        char *group = g_strdup_printf("%s%d", ROSTER_CACHE_CONTACT_PREFIX, index++);
+        g_key_file_set_string(cache, group, "jid", p_contact_barejid(contact));
+
+        const char *name = p_contact_name(contact);
+        if (name) {
+            g_key_file_set_string(cache, group, "name", name);
+        }
+        const char *sub = p_contact_subscription(contact);
+        if (sub) {
+            g_key_file_set_string(cache, group, "subscription", sub);
+        }
+        g_key_file_set_boolean(cache, group, "pending_out", p_contact_pending_out(contact));
+
+        GSList *contact_groups = p_contact_groups(contact);
+        guint groups_len = g_slist_length(contact_groups);
+        if (groups_len > 0) {
+            const gchar **groups_list = g_new(const gchar*, groups_len);
+            guint i = 0;
+            GSList *curr_group = contact_groups;
+            while (curr_group) {
+                groups_list[i++] = curr_group->data;
+                curr_group = g_slist_next(curr_group);
+            }
+            g_key_file_set_string_list(cache, group, "groups", groups_list, groups_len);
+            g_free(groups_list);
+        }
+
+        g_free(group);
+        curr = g_slist_next(curr);
+    }
+    g_slist_free(contacts);
+
+    gsize g_data_size;
+    gchar *g_cache_data = g_key_file_to_data(cache, &g_data_size, NULL);
+    g_file_set_contents(cacheloc, g_cache_data, g_data_size, NULL);
+    g_chmod(cacheloc, S_IRUSR | S_IWUSR);
+    g_free(g_cache_data);
+    g_key_file_free(cache);
+
+    dirty = FALSE;
+}
@@ -46,10 +46,27 @@
 #include "xmpp/contact.h"
 #include "xmpp/jid.h"
 
+// contacts kept in name and presence order
+typedef struct roster_index_t {
+    GSequence *by_name;
+    GSequence *by_presence;
+
+    // contact to its position in each sequence
+    GHashTable *name_pos;
+    GHashTable *presence_pos;
+} RosterIndex;
+
 typedef struct prof_roster_t {
     // contacts, indexed on barejid
     GHashTable *contacts;
 
+    // all contacts in display order
+    RosterIndex *index;
+
+    // group name to members of the group, and contacts in no group
+    GHashTable *group_index;
+    RosterIndex *ungrouped;
+
     // nicknames
     Autocomplete name_ac;
 
@@ -75,6 +92,13 @@ static void _replace_name(const char *const current_name, const char *const new_
 static void _add_name_and_barejid(const char *const name, const char *const barejid);
 static gint _compare_name(PContact a, PContact b);
 static gint _compare_presence(PContact a, PContact b);
+static RosterIndex* _index_new(void);
+static void _index_free(RosterIndex *index);
+static void _index_add(RosterIndex *index, PContact contact);
+static void _index_remove(RosterIndex *index, PContact contact);
+static GSList* _index_list(RosterIndex *index, roster_ord_t order);
+static void _roster_index_contact(PContact contact);
+static void _roster_unindex_contact(PContact contact);
 
 void
 roster_create(void)
@@ -89,6 +113,9 @@ roster_create(void)
     roster->name_to_barejid = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
     roster->groups_ac = autocomplete_new();
     roster->group_count = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    roster->index = _index_new();
+    roster->group_index = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)_index_free);
+    roster->ungrouped = _index_new();
 }
 
 void
@@ -96,6 +123,9 @@ roster_destroy(void)
 {
     assert(roster != NULL);
 
+    _index_free(roster->index);
+    g_hash_table_destroy(roster->group_index);
+    _index_free(roster->ungrouped);
     g_hash_table_destroy(roster->contacts);
     autocomplete_free(roster->name_ac);
     autocomplete_free(roster->barejid_ac);
@@ -123,7 +153,9 @@ roster_update_presence(const char *const barejid, Resource *resource, GDateTime
     if (!_datetimes_equal(p_contact_last_activity(contact), last_activity)) {
         p_contact_set_last_activity(contact, last_activity);
     }
+    _roster_unindex_contact(contact);
     p_contact_set_presence(contact, resource);
+    _roster_index_contact(contact);
     Jid *jid = jid_create_from_bare_and_resource(barejid, resource->name);
     autocomplete_add(roster->fulljid_ac, jid->fulljid);
     jid_destroy(jid);
@@ -185,7 +217,9 @@ roster_contact_offline(const char *const barejid, const char *const resource, co
     if (resource == NULL) {
         return TRUE;
     } else {
+        _roster_unindex_contact(contact);
         gboolean result = p_contact_remove_resource(contact, resource);
+        _roster_index_contact(contact);
         if (result == TRUE) {
             Jid *jid = jid_create_from_bare_and_resource(barejid, resource);
             autocomplete_remove(roster->fulljid_ac, jid->fulljid);
@@ -221,7 +255,9 @@ roster_change_name(PContact contact, const char *const new_name)
         current_name = strdup(p_contact_name(contact));
     }
 
+    _roster_unindex_contact(contact);
     p_contact_set_name(contact, new_name);
+    _roster_index_contact(contact);
     _replace_name(current_name, new_name, barejid);
 }
 
@@ -264,6 +300,8 @@ roster_remove(const char *const name, const char *const barejid)
             }
             curr = g_slist_next(curr);
         }
+
+        _roster_unindex_contact(contact);
     }
 
     // remove the contact
@@ -279,6 +317,8 @@ roster_update(const char *const barejid, const char *const name, GSList *groups,
     PContact contact = roster_get_contact(barejid);
     assert(contact != NULL);
 
+    _roster_unindex_contact(contact);
+
     p_contact_set_subscription(contact, subscription);
     p_contact_set_pending_out(contact, pending_out);
 
@@ -334,6 +374,8 @@ roster_update(const char *const barejid, const char *const name, GSList *groups,
     }
 
     p_contact_set_groups(contact, groups);
+
+    _roster_index_contact(contact);
 }
 
 gboolean
@@ -365,6 +407,7 @@ roster_add(const char *const barejid, const char *const name, GSList *groups, co
     }
 
     g_hash_table_insert(roster->contacts, strdup(barejid), contact);
+    _roster_index_contact(contact);
     autocomplete_add(roster->barejid_ac, barejid);
     _add_name_and_barejid(name, barejid);
 
@@ -389,15 +432,12 @@ roster_get_contacts_by_presence(const char *const presence)
     assert(roster != NULL);
 
     GSList *result = NULL;
-    GHashTableIter iter;
-    gpointer key;
-    gpointer value;
-
-    g_hash_table_iter_init(&iter, roster->contacts);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        PContact contact = (PContact)value;
+    GSequenceIter *iter = g_sequence_get_end_iter(roster->index->by_name);
+    while (!g_sequence_iter_is_begin(iter)) {
+        iter = g_sequence_iter_prev(iter);
+        PContact contact = g_sequence_get(iter);
         if (g_strcmp0(p_contact_presence(contact), presence) == 0) {
-            result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_name);
+            result = g_slist_prepend(result, contact);
         }
     }
 
@@ -410,25 +450,8 @@ roster_get_contacts(roster_ord_t order)
 {
     assert(roster != NULL);
 
-    GSList *result = NULL;
-    GHashTableIter iter;
-    gpointer key;
-    gpointer value;
-
-    GCompareFunc cmp_func;
-    if (order == ROSTER_ORD_PRESENCE) {
-        cmp_func = (GCompareFunc) _compare_presence;
-    } else {
-        cmp_func = (GCompareFunc) _compare_name;
-    }
-
-    g_hash_table_iter_init(&iter, roster->contacts);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        result = g_slist_insert_sorted(result, value, cmp_func);
-    }
-
     // return all contact structs
-    return result;
+    return _index_list(roster->index, order);
 }
 
 GSList*
@@ -437,14 +460,13 @@ roster_get_contacts_online(void)
     assert(roster != NULL);
 
     GSList *result = NULL;
-    GHashTableIter iter;
-    gpointer key;
-    gpointer value;
-
-    g_hash_table_iter_init(&iter, roster->contacts);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        if(strcmp(p_contact_presence(value), "offline"))
-            result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_name);
+    GSequenceIter *iter = g_sequence_get_end_iter(roster->index->by_name);
+    while (!g_sequence_iter_is_begin(iter)) {
+        iter = g_sequence_iter_prev(iter);
+        PContact contact = g_sequence_get(iter);
+        if (strcmp(p_contact_presence(contact), "offline")) {
+            result = g_slist_prepend(result, contact);
+        }
     }
 
     // return all contact structs
@@ -476,7 +498,28 @@ roster_contact_autocomplete(const char *const search_str)
 {
     assert(roster != NULL);
 
-    return autocomplete_complete(roster->name_ac, search_str, TRUE);
+    if (prefs_get_boolean(PREF_COMPLETION_FUZZY)) {
+        return autocomplete_complete_fuzzy(roster->name_ac, search_str, TRUE);
+    } else {
+        return autocomplete_complete(roster->name_ac, search_str, TRUE);
+    }
+}
+
+void
+roster_contact_mark_used(const char *const barejid)
+{
+    assert(roster != NULL);
+
+    PContact contact = roster_get_contact(barejid);
+    if (contact == NULL) {
+        return;
+    }
+
+    if (p_contact_name(contact)) {
+        autocomplete_mark_used(roster->name_ac, p_contact_name(contact));
+    } else {
+        autocomplete_mark_used(roster->name_ac, p_contact_barejid(contact));
+    }
 }
 
 char*
@@ -492,38 +535,19 @@ roster_get_group(const char *const group, roster_ord_t order)
 {
     assert(roster != NULL);
 
-    GSList *result = NULL;
-    GHashTableIter iter;
-    gpointer key;
-    gpointer value;
-
-    GCompareFunc cmp_func;
-    if (order == ROSTER_ORD_PRESENCE) {
-        cmp_func = (GCompareFunc) _compare_presence;
+    RosterIndex *index = NULL;
+    if (group == NULL) {
+        index = roster->ungrouped;
     } else {
-        cmp_func = (GCompareFunc) _compare_name;
+        index = g_hash_table_lookup(roster->group_index, group);
     }
 
-    g_hash_table_iter_init(&iter, roster->contacts);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        GSList *groups = p_contact_groups(value);
-        if (group == NULL) {
-            if (groups == NULL) {
-                result = g_slist_insert_sorted(result, value, cmp_func);
-            }
-        } else {
-            while (groups) {
-                if (strcmp(groups->data, group) == 0) {
-                    result = g_slist_insert_sorted(result, value, cmp_func);
-                    break;
-                }
-                groups = g_slist_next(groups);
-            }
-        }
+    if (index == NULL) {
+        return NULL;
     }
 
     // return all contact structs
-    return result;
+    return _index_list(index, order);
 }
 
 GSList*
@@ -666,3 +690,136 @@ _compare_presence(PContact a, PContact b)
         return _compare_name(a, b);
     }
 }
+
+static gint
+_index_compare_name(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    return _compare_name((PContact)a, (PContact)b);
+}
+
+static gint
+_index_compare_presence(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    return _compare_presence((PContact)a, (PContact)b);
+}
+
+static RosterIndex*
+_index_new(void)
+{
+    RosterIndex *index = malloc(sizeof(RosterIndex));
+    index->by_name = g_sequence_new(NULL);
+    index->by_presence = g_sequence_new(NULL);
+    index->name_pos = g_hash_table_new(g_direct_hash, g_direct_equal);
+    index->presence_pos = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    return index;
+}
+
+static void
+_index_free(RosterIndex *index)
+{
+    if (index) {
+        g_sequence_free(index->by_name);
+        g_sequence_free(index->by_presence);
+        g_hash_table_destroy(index->name_pos);
+        g_hash_table_destroy(index->presence_pos);
+        free(index);
+    }
+}
+
+static void
+_index_add(RosterIndex *index, PContact contact)
+{
+    GSequenceIter *name_iter = g_sequence_insert_sorted(index->by_name, contact, _index_compare_name, NULL);
+    g_hash_table_insert(index->name_pos, contact, name_iter);
+
+    GSequenceIter *presence_iter = g_sequence_insert_sorted(index->by_presence, contact, _index_compare_presence, NULL);
+    g_hash_table_insert(index->presence_pos, contact, presence_iter);
+}
+
+static void
+_index_remove(RosterIndex *index, PContact contact)
+{
+    GSequenceIter *name_iter = g_hash_table_lookup(index->name_pos, contact);
+    if (name_iter) {
+        g_sequence_remove(name_iter);
+        g_hash_table_remove(index->name_pos, contact);
+    }
+
+    GSequenceIter *presence_iter = g_hash_table_lookup(index->presence_pos, contact);
+    if (presence_iter) {
+        g_sequence_remove(presence_iter);
+        g_hash_table_remove(index->presence_pos, contact);
+    }
+}
+
+static GSList*
+_index_list(RosterIndex *index, roster_ord_t order)
+{
+    GSequence *seq = NULL;
+    if (order == ROSTER_ORD_PRESENCE) {
+        seq = index->by_presence;
+    } else {
+        seq = index->by_name;
+    }
+
+    GSList *result = NULL;
+    GSequenceIter *iter = g_sequence_get_end_iter(seq);
+    while (!g_sequence_iter_is_begin(iter)) {
+        iter = g_sequence_iter_prev(iter);
+        result = g_slist_prepend(result, g_sequence_get(iter));
+    }
+
+    return result;
+}
+
+// add the contact to the roster and group indexes, must be called after any
+// change to its name, presence or groups
+static void
+_roster_index_contact(PContact contact)
+{
+    _index_add(roster->index, contact);
+
+    GSList *groups = p_contact_groups(contact);
+    if (groups == NULL) {
+        _index_add(roster->ungrouped, contact);
+        return;
+    }
+
+    GSList *curr = groups;
+    while (curr) {
+        RosterIndex *group_index = g_hash_table_lookup(roster->group_index, curr->data);
+        if (group_index == NULL) {
+            group_index = _index_new();
+            g_hash_table_insert(roster->group_index, strdup(curr->data), group_index);
+        }
+        _index_add(group_index, contact);
+        curr = g_slist_next(curr);
+    }
+}
+
+// remove the contact from the roster and group indexes, must be called before
+// any change to its name, presence or groups
+static void
+_roster_unindex_contact(PContact contact)
+{
+    _index_remove(roster->index, contact);
+
+    GSList *groups = p_contact_groups(contact);
+    if (groups == NULL) {
+        _index_remove(roster->ungrouped, contact);
+        return;
+    }
+
+    GSList *curr = groups;
+    while (curr) {
+        RosterIndex *group_index = g_hash_table_lookup(roster->group_index, curr->data);
+        if (group_index) {
+            _index_remove(group_index, contact);
+            if (g_hash_table_size(group_index->name_pos) == 0) {
+                g_hash_table_remove(roster->group_index, curr->data);
+            }
+        }
+        curr = g_slist_next(curr);
+    }
+}
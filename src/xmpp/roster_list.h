@@ -63,6 +63,7 @@ GSList* roster_get_contacts(roster_ord_t order);
 GSList* roster_get_contacts_online(void);
 gboolean roster_has_pending_subscriptions(void);
 char* roster_contact_autocomplete(const char *const search_str);
+void roster_contact_mark_used(const char *const barejid);
 char* roster_fulljid_autocomplete(const char *const search_str);
 GSList* roster_get_group(const char *const group, roster_ord_t order);
 GSList* roster_get_groups(void);
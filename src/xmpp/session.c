@@ -54,6 +54,7 @@
 #include "xmpp/message.h"
 #include "xmpp/presence.h"
 #include "xmpp/roster.h"
+#include "xmpp/roster_cache.h"
 #include "xmpp/stanza.h"
 #include "xmpp/xmpp.h"
 #include "xmpp/muc.h"
@@ -108,6 +109,9 @@ session_connect_with_account(const ProfAccount *const account)
 
     log_info("Connecting using account: %s", account->name);
 
+    // messages left unacknowledged by a lost connection belong to the previous login
+    connection_sm_clear();
+
     // save account name and password for reconnect
     if (saved_account.name) {
         free(saved_account.name);
@@ -145,6 +149,8 @@ session_connect_with_details(const char *const jid, const char *const passwd, co
     assert(jid != NULL);
     assert(passwd != NULL);
 
+    connection_sm_clear();
+
     // save details for reconnect, remember name for account creating on success
     saved_details.name = strdup(jid);
     saved_details.passwd = strdup(passwd);
@@ -218,8 +224,10 @@ session_disconnect(void)
         plugins_on_disconnect(account_name, fulljid);
 
         accounts_set_last_activity(session_get_account_name());
+        roster_cache_close();
 
         connection_disconnect();
+        connection_sm_clear();
 
         _session_free_saved_account();
         _session_free_saved_details();
@@ -275,6 +283,28 @@ session_process_events(void)
     }
 }
 
+// milliseconds until the next reconnect attempt, -1 when none is pending
+gint
+session_reconnect_timeout(void)
+{
+    if (connection_get_status() != JABBER_DISCONNECTED) {
+        return -1;
+    }
+
+    int reconnect_sec = prefs_get_reconnect();
+    if ((reconnect_sec == 0) || !reconnect_timer) {
+        return -1;
+    }
+
+    // session_process_events reconnects once a whole second has passed the interval
+    gdouble remaining = (reconnect_sec + 1) - g_timer_elapsed(reconnect_timer, NULL);
+    if (remaining <= 0) {
+        return 0;
+    }
+
+    return remaining * 1000 + 1;
+}
+
 char*
 session_get_account_name(void)
 {
@@ -333,6 +363,7 @@ session_login_failed(void)
     if (reconnect_timer == NULL) {
         log_debug("Connection handler: No reconnect timer");
         sv_ev_failed_login();
+        connection_sm_clear();
         _session_free_saved_account();
         _session_free_saved_details();
     } else {
@@ -350,11 +381,13 @@ session_login_failed(void)
 void
 session_lost_connection(void)
 {
+    roster_cache_close();
     sv_ev_lost_connection();
     if (prefs_get_reconnect() != 0) {
         assert(reconnect_timer == NULL);
         reconnect_timer = g_timer_new();
     } else {
+        connection_sm_clear();
         _session_free_saved_account();
         _session_free_saved_details();
     }
@@ -44,5 +44,6 @@ void session_autoping_fail(void);
 
 void session_init_activity(void);
 void session_check_autoaway(void);
+gint session_reconnect_timeout(void);
 
 #endif
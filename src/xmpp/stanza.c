@@ -888,13 +888,16 @@ stanza_create_software_version_iq(xmpp_ctx_t *ctx, const char *const fulljid)
 }
 
 xmpp_stanza_t*
-stanza_create_roster_iq(xmpp_ctx_t *ctx)
+stanza_create_roster_iq(xmpp_ctx_t *ctx, const char *const ver)
 {
     xmpp_stanza_t *iq = xmpp_iq_new(ctx, STANZA_TYPE_GET, "roster");
 
     xmpp_stanza_t *query = xmpp_stanza_new(ctx);
     xmpp_stanza_set_name(query, STANZA_NAME_QUERY);
     xmpp_stanza_set_ns(query, XMPP_NS_ROSTER);
+    if (ver) {
+        xmpp_stanza_set_attribute(query, STANZA_ATTR_VER, ver);
+    }
 
     xmpp_stanza_add_child(iq, query);
     xmpp_stanza_release(query);
@@ -1053,6 +1056,40 @@ stanza_create_ping_iq(xmpp_ctx_t *ctx, const char *const target)
     return iq;
 }
 
+xmpp_stanza_t*
+stanza_create_sm_enable(xmpp_ctx_t *ctx)
+{
+    xmpp_stanza_t *enable = xmpp_stanza_new(ctx);
+    xmpp_stanza_set_name(enable, STANZA_NAME_ENABLE);
+    xmpp_stanza_set_ns(enable, STANZA_NS_SM);
+
+    return enable;
+}
+
+xmpp_stanza_t*
+stanza_create_sm_request(xmpp_ctx_t *ctx)
+{
+    xmpp_stanza_t *request = xmpp_stanza_new(ctx);
+    xmpp_stanza_set_name(request, STANZA_NAME_SM_REQUEST);
+    xmpp_stanza_set_ns(request, STANZA_NS_SM);
+
+    return request;
+}
+
+xmpp_stanza_t*
+stanza_create_sm_ack(xmpp_ctx_t *ctx, guint32 h)
+{
+    xmpp_stanza_t *ack = xmpp_stanza_new(ctx);
+    xmpp_stanza_set_name(ack, STANZA_NAME_SM_ACK);
+    xmpp_stanza_set_ns(ack, STANZA_NS_SM);
+
+    char *h_str = g_strdup_printf("%u", h);
+    xmpp_stanza_set_attribute(ack, STANZA_ATTR_H, h_str);
+    g_free(h_str);
+
+    return ack;
+}
+
 char*
 stanza_create_caps_sha1_from_query(xmpp_stanza_t *const query)
 {
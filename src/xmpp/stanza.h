@@ -99,6 +99,11 @@
 #define STANZA_NAME_PUT "put"
 #define STANZA_NAME_GET "get"
 #define STANZA_NAME_URL "url"
+#define STANZA_NAME_SM "sm"
+#define STANZA_NAME_ENABLED "enabled"
+#define STANZA_NAME_FAILED "failed"
+#define STANZA_NAME_SM_REQUEST "r"
+#define STANZA_NAME_SM_ACK "a"
 
 // error conditions
 #define STANZA_NAME_BAD_REQUEST "bad-request"
@@ -156,6 +161,7 @@
 #define STANZA_ATTR_REASON "reason"
 #define STANZA_ATTR_AUTOJOIN "autojoin"
 #define STANZA_ATTR_PASSWORD "password"
+#define STANZA_ATTR_H "h"
 
 #define STANZA_TEXT_AWAY "away"
 #define STANZA_TEXT_DND "dnd"
@@ -186,6 +192,7 @@
 #define STANZA_NS_HTTP_UPLOAD "urn:xmpp:http:upload"
 #define STANZA_NS_X_OOB "jabber:x:oob"
 #define STANZA_NS_BLOCKING "urn:xmpp:blocking"
+#define STANZA_NS_SM "urn:xmpp:sm:3"
 
 #define STANZA_DATAFORM_SOFTWARE "urn:xmpp:dataforms:softwareinfo"
 
@@ -237,8 +244,11 @@ xmpp_stanza_t* stanza_create_room_newnick_presence(xmpp_ctx_t *ctx,
 xmpp_stanza_t* stanza_create_room_leave_presence(xmpp_ctx_t *ctx,
     const char *const room, const char *const nick);
 
-xmpp_stanza_t* stanza_create_roster_iq(xmpp_ctx_t *ctx);
+xmpp_stanza_t* stanza_create_roster_iq(xmpp_ctx_t *ctx, const char *const ver);
 xmpp_stanza_t* stanza_create_ping_iq(xmpp_ctx_t *ctx, const char *const target);
+xmpp_stanza_t* stanza_create_sm_enable(xmpp_ctx_t *ctx);
+xmpp_stanza_t* stanza_create_sm_request(xmpp_ctx_t *ctx);
+xmpp_stanza_t* stanza_create_sm_ack(xmpp_ctx_t *ctx, guint32 h);
 xmpp_stanza_t* stanza_create_disco_info_iq(xmpp_ctx_t *ctx, const char *const id,
     const char *const to, const char *const node);
 
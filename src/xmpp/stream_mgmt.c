@@ -0,0 +1,151 @@
+/*
+ * stream_mgmt.c
+ *
+ * Copyright (C) 2012 - 2017 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "log.h"
+#include "xmpp/stream_mgmt.h"
+
+// stream management (XEP-0198) counts, the unacked queue is kept across a lost
+// connection so chat messages can be sent again on the next login
+typedef struct stream_mgmt_t {
+    guint32 handled_in;
+    guint32 acked_out;
+    GQueue *unacked;
+} StreamMgmt;
+
+static StreamMgmt sm;
+
+void
+stream_mgmt_init(void)
+{
+    memset(&sm, 0, sizeof(sm));
+    sm.unacked = g_queue_new();
+}
+
+void
+stream_mgmt_shutdown(void)
+{
+    stream_mgmt_clear();
+    g_queue_free(sm.unacked);
+    sm.unacked = NULL;
+}
+
+void
+stream_mgmt_clear(void)
+{
+    sm.handled_in = 0;
+    sm.acked_out = 0;
+    if (sm.unacked) {
+        g_queue_foreach(sm.unacked, (GFunc)free, NULL);
+        g_queue_clear(sm.unacked);
+    }
+}
+
+// the server counts its own stanzas from <enabled/>
+void
+stream_mgmt_enabled(void)
+{
+    sm.handled_in = 0;
+}
+
+void
+stream_mgmt_handled(void)
+{
+    sm.handled_in++;
+}
+
+guint32
+stream_mgmt_get_handled(void)
+{
+    return sm.handled_in;
+}
+
+void
+stream_mgmt_queue(const char *const text)
+{
+    g_queue_push_tail(sm.unacked, strdup(text));
+}
+
+gboolean
+stream_mgmt_has_unacked(void)
+{
+    return !g_queue_is_empty(sm.unacked);
+}
+
+GList*
+stream_mgmt_get_unacked(void)
+{
+    return sm.unacked->head;
+}
+
+// the caller owns the returned queue and its strings
+GQueue*
+stream_mgmt_take_unacked(void)
+{
+    GQueue *unacked = sm.unacked;
+    sm.unacked = g_queue_new();
+
+    return unacked;
+}
+
+// h counts every stanza the server has handled modulo 2^32, the difference from
+// the last acknowledgement is how many queued stanzas it covers
+void
+stream_mgmt_acked(const char *const h)
+{
+    if (h == NULL) {
+        log_warning("Stream management: acknowledgement without count");
+        return;
+    }
+
+    guint32 handled = strtoul(h, NULL, 10);
+    guint32 count = handled - sm.acked_out;
+    guint unacked = g_queue_get_length(sm.unacked);
+    if (count > unacked) {
+        log_warning("Stream management: server acknowledged %u stanzas, only %u outstanding", count, unacked);
+        count = unacked;
+    }
+
+    guint32 i;
+    for (i = 0; i < count; i++) {
+        free(g_queue_pop_head(sm.unacked));
+    }
+    sm.acked_out = handled;
+}
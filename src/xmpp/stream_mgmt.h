@@ -0,0 +1,52 @@
+/*
+ * stream_mgmt.h
+ *
+ * Copyright (C) 2012 - 2017 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#ifndef XMPP_STREAM_MGMT_H
+#define XMPP_STREAM_MGMT_H
+
+#include <glib.h>
+
+void stream_mgmt_init(void);
+void stream_mgmt_shutdown(void);
+void stream_mgmt_clear(void);
+void stream_mgmt_enabled(void);
+void stream_mgmt_handled(void);
+guint32 stream_mgmt_get_handled(void);
+void stream_mgmt_queue(const char *const text);
+gboolean stream_mgmt_has_unacked(void);
+GList* stream_mgmt_get_unacked(void);
+GQueue* stream_mgmt_take_unacked(void);
+void stream_mgmt_acked(const char *const h);
+
+#endif
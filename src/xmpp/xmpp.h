@@ -102,6 +102,7 @@ typedef struct entity_capabilities_t {
     DiscoIdentity *identity;
     SoftwareVersion *software_version;
     GSList *features;
+    guint64 known_features;
 } EntityCapabilities;
 
 typedef struct disco_item_t {
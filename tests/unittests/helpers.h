@@ -3,6 +3,9 @@
 void load_preferences(void **state);
 void close_preferences(void **state);
 
+void create_data_dir(void **state);
+void remove_data_dir(void **state);
+
 void init_chat_sessions(void **state);
 void close_chat_sessions(void **state);
 
@@ -52,6 +52,7 @@ log_level_t log_level_from_string(char *log_level)
 void log_stderr_init(log_level_t level) {}
 void log_stderr_close(void) {}
 void log_stderr_handler(void) {}
+int log_stderr_get_fd(void) { return -1; }
 
 void chat_log_init(void) {}
 
@@ -63,12 +64,22 @@ void chat_log_msg_in(const char * const barejid, const char * const msg, GDateTi
 void chat_log_otr_msg_in(const char * const barejid, const char * const msg, gboolean was_decrypted, GDateTime *timestamp) {}
 void chat_log_pgp_msg_in(const char * const barejid, const char * const msg, GDateTime *timestamp) {}
 
+void chat_log_flush(void) {}
+void chat_log_get_stats(ChatLogStats *stats) {}
 void chat_log_close(void) {}
-GSList * chat_log_get_previous(const gchar * const login,
-    const gchar * const recipient)
+ChatLogHistory chat_log_history_new(const gchar * const login, const gchar * const recipient)
+{
+    return NULL;
+}
+GSList * chat_log_history_previous(ChatLogHistory history, int count)
 {
     return mock_ptr_type(GSList *);
 }
+gboolean chat_log_history_finished(ChatLogHistory history)
+{
+    return TRUE;
+}
+void chat_log_history_free(ChatLogHistory history) {}
 
 void groupchat_log_init(void) {}
 void groupchat_log_chat(const gchar * const login, const gchar * const room,
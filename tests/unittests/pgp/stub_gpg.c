@@ -42,6 +42,16 @@ char * p_gpg_decrypt(const char * const cipher)
     return NULL;
 }
 
+void p_gpg_decrypt_async(const char *const cipher, ProfPGPCallback callback, void *userdata, GDestroyNotify free_userdata) {}
+void p_gpg_verify_async(const char *const barejid, const char *const sign) {}
+void p_gpg_sign_async(const char *const str, const char *const fp, ProfPGPCallback callback, void *userdata,
+    GDestroyNotify free_userdata) {}
+int p_gpg_results_fd(void)
+{
+    return -1;
+}
+void p_gpg_process_results(void) {}
+
 void p_gpg_on_connect(const char * const barejid) {}
 void p_gpg_on_disconnect(void) {}
 
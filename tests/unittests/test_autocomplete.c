@@ -4,6 +4,7 @@
 #include <setjmp.h>
 #include <cmocka.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "xmpp/contact.h"
 #include "tools/autocomplete.h"
@@ -117,3 +118,227 @@ void add_two_same_updates(void **state)
     autocomplete_clear(ac);
     g_slist_free_full(result, g_free);
 }
+
+void complete_cycles_back_to_first_match(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "Help");
+    autocomplete_add(ac, "Other");
+    autocomplete_add(ac, "Hello");
+    char *result1 = autocomplete_complete(ac, "Hel", TRUE);
+    char *result2 = autocomplete_complete(ac, result1, TRUE);
+    char *result3 = autocomplete_complete(ac, result2, TRUE);
+
+    assert_string_equal("Hello", result1);
+    assert_string_equal("Help", result2);
+    assert_string_equal("Hello", result3);
+
+    free(result1);
+    free(result2);
+    free(result3);
+    autocomplete_free(ac);
+}
+
+void complete_after_removing_last_found(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "Hello");
+    autocomplete_add(ac, "Help");
+    char *result1 = autocomplete_complete(ac, "Hel", TRUE);
+    autocomplete_remove(ac, "Hello");
+    char *result2 = autocomplete_complete(ac, "Hel", TRUE);
+
+    assert_string_equal("Help", result2);
+    assert_false(autocomplete_contains(ac, "Hello"));
+
+    free(result1);
+    free(result2);
+    autocomplete_free(ac);
+}
+
+void add_many_and_complete(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    int i = 0;
+    for (i = 50000; i > 0; i--) {
+        char *item = g_strdup_printf("contact%d@server.org", i);
+        autocomplete_add(ac, item);
+        g_free(item);
+    }
+
+    assert_int_equal(50000, autocomplete_length(ac));
+    assert_true(autocomplete_contains(ac, "contact25000@server.org"));
+
+    char *result1 = autocomplete_complete(ac, "contact4999", TRUE);
+    char *result2 = autocomplete_complete(ac, result1, TRUE);
+
+    assert_string_equal("contact49990@server.org", result1);
+    assert_string_equal("contact49991@server.org", result2);
+
+    free(result1);
+    free(result2);
+    autocomplete_free(ac);
+}
+
+void fuzzy_matches_subsequence(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "/roster");
+    autocomplete_add(ac, "/rooms");
+    char *result = autocomplete_complete_fuzzy(ac, "/rstr", TRUE);
+
+    assert_string_equal("/roster", result);
+
+    free(result);
+    autocomplete_free(ac);
+}
+
+void fuzzy_ignores_case(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "James Smith");
+    char *result = autocomplete_complete_fuzzy(ac, "smi", FALSE);
+
+    assert_string_equal("James Smith", result);
+
+    free(result);
+    autocomplete_free(ac);
+}
+
+void fuzzy_ranks_prefix_before_substring(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "bobby");
+    autocomplete_add(ac, "alice_bob");
+    autocomplete_add(ac, "bob");
+    char *result1 = autocomplete_complete_fuzzy(ac, "bob", TRUE);
+    char *result2 = autocomplete_complete_fuzzy(ac, result1, TRUE);
+    char *result3 = autocomplete_complete_fuzzy(ac, result2, TRUE);
+    char *result4 = autocomplete_complete_fuzzy(ac, result3, TRUE);
+
+    assert_string_equal("bob", result1);
+    assert_string_equal("bobby", result2);
+    assert_string_equal("alice_bob", result3);
+    assert_string_equal("bob", result4);
+
+    free(result1);
+    free(result2);
+    free(result3);
+    free(result4);
+    autocomplete_free(ac);
+}
+
+void fuzzy_ranks_used_items_first(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "dave");
+    autocomplete_add(ac, "david");
+    autocomplete_mark_used(ac, "david");
+    char *result = autocomplete_complete_fuzzy(ac, "dav", TRUE);
+
+    assert_string_equal("david", result);
+
+    free(result);
+    autocomplete_free(ac);
+}
+
+void fuzzy_keeps_usage_after_clear(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "dave");
+    autocomplete_add(ac, "david");
+    autocomplete_mark_used(ac, "david");
+    autocomplete_clear(ac);
+    autocomplete_add(ac, "dave");
+    autocomplete_add(ac, "david");
+    char *result = autocomplete_complete_fuzzy(ac, "dav", TRUE);
+
+    assert_string_equal("david", result);
+
+    free(result);
+    autocomplete_free(ac);
+}
+
+void fuzzy_returns_null_when_no_match(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "Hello");
+    char *result = autocomplete_complete_fuzzy(ac, "xyz", TRUE);
+
+    assert_null(result);
+
+    autocomplete_free(ac);
+}
+
+void fuzzy_finds_item_added_after_search(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "dave");
+    char *result1 = autocomplete_complete_fuzzy(ac, "da", TRUE);
+    autocomplete_reset(ac);
+    autocomplete_add(ac, "daniel");
+    char *result2 = autocomplete_complete_fuzzy(ac, "dan", TRUE);
+
+    assert_string_equal("dave", result1);
+    assert_string_equal("daniel", result2);
+
+    free(result1);
+    free(result2);
+    autocomplete_free(ac);
+}
+
+void fuzzy_narrows_extended_search(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "bob@server.org");
+    autocomplete_add(ac, "boris@server.org");
+    autocomplete_add(ac, "robert@server.org");
+    char *result1 = autocomplete_complete_fuzzy(ac, "bo", TRUE);
+    autocomplete_reset(ac);
+    char *result2 = autocomplete_complete_fuzzy(ac, "bor", TRUE);
+    autocomplete_reset(ac);
+    char *result3 = autocomplete_complete_fuzzy(ac, "r", TRUE);
+
+    assert_string_equal("bob@server.org", result1);
+    assert_string_equal("boris@server.org", result2);
+    assert_string_equal("robert@server.org", result3);
+
+    free(result1);
+    free(result2);
+    free(result3);
+    autocomplete_free(ac);
+}
+
+// typing a search one character at a time should take under 1ms per keystroke
+void fuzzy_typing_stays_within_budget(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    int i;
+    for (i = 0; i < 20000; i++) {
+        char *item = g_strdup_printf("contact%d@server%d.org", i, i % 7);
+        autocomplete_add(ac, item);
+        g_free(item);
+    }
+
+    // first search builds the index
+    char *result = autocomplete_complete_fuzzy(ac, "x", TRUE);
+    free(result);
+    autocomplete_reset(ac);
+
+    const char *typed = "contact4321@server";
+    GTimer *timer = g_timer_new();
+    for (i = 1; i <= strlen(typed); i++) {
+        char *search = g_strndup(typed, i);
+        result = autocomplete_complete_fuzzy(ac, search, TRUE);
+        free(result);
+        autocomplete_reset(ac);
+        g_free(search);
+    }
+    g_timer_stop(timer);
+    double per_keystroke = g_timer_elapsed(timer, NULL) / strlen(typed);
+    g_timer_destroy(timer);
+
+    assert_true(per_keystroke < 0.001);
+
+    autocomplete_free(ac);
+}
@@ -8,3 +8,15 @@ void add_two_and_complete_returns_second(void **state);
 void add_two_adds_two(void **state);
 void add_two_same_adds_one(void **state);
 void add_two_same_updates(void **state);
+void complete_cycles_back_to_first_match(void **state);
+void complete_after_removing_last_found(void **state);
+void add_many_and_complete(void **state);
+void fuzzy_matches_subsequence(void **state);
+void fuzzy_ignores_case(void **state);
+void fuzzy_ranks_prefix_before_substring(void **state);
+void fuzzy_ranks_used_items_first(void **state);
+void fuzzy_keeps_usage_after_clear(void **state);
+void fuzzy_returns_null_when_no_match(void **state);
+void fuzzy_finds_item_added_after_search(void **state);
+void fuzzy_narrows_extended_search(void **state);
+void fuzzy_typing_stays_within_budget(void **state);
@@ -0,0 +1,223 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+
+#include "ui/buffer.h"
+
+static void
+_push_message(ProfBuff buffer, const char *const message)
+{
+    GDateTime *now = g_date_time_new_now_local();
+    buffer_push(buffer, '-', 0, now, 0, THEME_TEXT, NULL, message, NULL);
+    g_date_time_unref(now);
+}
+
+static void
+_push_with_receipt(ProfBuff buffer, const char *const message, const char *const id)
+{
+    GDateTime *now = g_date_time_new_now_local();
+    DeliveryReceipt *receipt = malloc(sizeof(struct delivery_receipt_t));
+    receipt->id = strdup(id);
+    receipt->received = FALSE;
+    buffer_push(buffer, '-', 0, now, 0, THEME_TEXT, "me", message, receipt);
+    g_date_time_unref(now);
+}
+
+void empty_buffer_has_size_zero(void **state)
+{
+    ProfBuff buffer = buffer_create(BUFF_SIZE);
+
+    assert_int_equal(0, buffer_size(buffer));
+
+    buffer_free(buffer);
+}
+
+void yield_out_of_range_returns_null(void **state)
+{
+    ProfBuff buffer = buffer_create(BUFF_SIZE);
+    _push_message(buffer, "one");
+
+    assert_null(buffer_yield_entry(buffer, 1));
+    assert_null(buffer_yield_entry(buffer, -1));
+
+    buffer_free(buffer);
+}
+
+void push_one_and_yield(void **state)
+{
+    ProfBuff buffer = buffer_create(BUFF_SIZE);
+    _push_message(buffer, "one");
+
+    ProfBuffEntry *entry = buffer_yield_entry(buffer, 0);
+
+    assert_int_equal(1, buffer_size(buffer));
+    assert_string_equal("one", entry->message);
+    assert_null(entry->from);
+
+    buffer_free(buffer);
+}
+
+void push_keeps_order(void **state)
+{
+    ProfBuff buffer = buffer_create(BUFF_SIZE);
+    _push_message(buffer, "one");
+    _push_message(buffer, "two");
+    _push_message(buffer, "three");
+
+    assert_int_equal(3, buffer_size(buffer));
+    assert_string_equal("one", buffer_yield_entry(buffer, 0)->message);
+    assert_string_equal("two", buffer_yield_entry(buffer, 1)->message);
+    assert_string_equal("three", buffer_yield_entry(buffer, 2)->message);
+
+    buffer_free(buffer);
+}
+
+void push_beyond_capacity_evicts_oldest(void **state)
+{
+    ProfBuff buffer = buffer_create(2);
+    _push_message(buffer, "one");
+    _push_message(buffer, "two");
+    _push_message(buffer, "three");
+
+    assert_int_equal(2, buffer_size(buffer));
+    assert_string_equal("two", buffer_yield_entry(buffer, 0)->message);
+    assert_string_equal("three", buffer_yield_entry(buffer, 1)->message);
+
+    buffer_free(buffer);
+}
+
+void push_many_keeps_last_entries(void **state)
+{
+    ProfBuff buffer = buffer_create(BUFF_SIZE);
+    int capacity = buffer_capacity(buffer);
+    int total = 100000;
+    int i;
+    for (i = 0; i < total; i++) {
+        char *message = g_strdup_printf("%d", i);
+        _push_message(buffer, message);
+        g_free(message);
+    }
+
+    assert_int_equal(capacity, buffer_size(buffer));
+    for (i = 0; i < capacity; i++) {
+        char *expected = g_strdup_printf("%d", total - capacity + i);
+        assert_string_equal(expected, buffer_yield_entry(buffer, i)->message);
+        g_free(expected);
+    }
+
+    buffer_free(buffer);
+}
+
+void create_with_capacity_sets_capacity(void **state)
+{
+    ProfBuff buffer = buffer_create(100000);
+
+    assert_int_equal(100000, buffer_capacity(buffer));
+
+    buffer_free(buffer);
+}
+
+void yield_by_id_returns_entry(void **state)
+{
+    ProfBuff buffer = buffer_create(BUFF_SIZE);
+    _push_message(buffer, "one");
+    _push_with_receipt(buffer, "two", "id2");
+    _push_message(buffer, "three");
+
+    ProfBuffEntry *entry = buffer_yield_entry_by_id(buffer, "id2");
+
+    assert_non_null(entry);
+    assert_string_equal("two", entry->message);
+
+    buffer_free(buffer);
+}
+
+void yield_by_id_returns_null_when_evicted(void **state)
+{
+    ProfBuff buffer = buffer_create(2);
+    _push_with_receipt(buffer, "one", "id1");
+    _push_message(buffer, "two");
+    _push_message(buffer, "three");
+
+    assert_null(buffer_yield_entry_by_id(buffer, "id1"));
+
+    buffer_free(buffer);
+}
+
+void mark_received_marks_entry(void **state)
+{
+    ProfBuff buffer = buffer_create(BUFF_SIZE);
+    _push_with_receipt(buffer, "one", "id1");
+
+    gboolean result = buffer_mark_received(buffer, "id1");
+
+    assert_true(result);
+    assert_true(buffer_yield_entry(buffer, 0)->receipt->received);
+
+    buffer_free(buffer);
+}
+
+void mark_received_returns_false_when_already_received(void **state)
+{
+    ProfBuff buffer = buffer_create(BUFF_SIZE);
+    _push_with_receipt(buffer, "one", "id1");
+    buffer_mark_received(buffer, "id1");
+
+    gboolean result = buffer_mark_received(buffer, "id1");
+
+    assert_false(result);
+
+    buffer_free(buffer);
+}
+
+void yield_by_id_survives_eviction_of_duplicate_id(void **state)
+{
+    ProfBuff buffer = buffer_create(2);
+    _push_with_receipt(buffer, "one", "id1");
+    _push_with_receipt(buffer, "two", "id1");
+    _push_message(buffer, "three");
+
+    ProfBuffEntry *entry = buffer_yield_entry_by_id(buffer, "id1");
+
+    assert_non_null(entry);
+    assert_string_equal("two", entry->message);
+
+    buffer_free(buffer);
+}
+
+void push_front_adds_before_existing(void **state)
+{
+    ProfBuff buffer = buffer_create(BUFF_SIZE);
+    _push_message(buffer, "two");
+    GDateTime *now = g_date_time_new_now_local();
+
+    gboolean result = buffer_push_front(buffer, '-', 0, now, 0, THEME_TEXT, NULL, "one", NULL);
+
+    assert_true(result);
+    assert_int_equal(2, buffer_size(buffer));
+    assert_string_equal("one", buffer_yield_entry(buffer, 0)->message);
+    assert_string_equal("two", buffer_yield_entry(buffer, 1)->message);
+
+    g_date_time_unref(now);
+    buffer_free(buffer);
+}
+
+void push_front_does_nothing_when_full(void **state)
+{
+    ProfBuff buffer = buffer_create(1);
+    _push_message(buffer, "two");
+    GDateTime *now = g_date_time_new_now_local();
+
+    gboolean result = buffer_push_front(buffer, '-', 0, now, 0, THEME_TEXT, NULL, "one", NULL);
+
+    assert_false(result);
+    assert_int_equal(1, buffer_size(buffer));
+    assert_string_equal("two", buffer_yield_entry(buffer, 0)->message);
+
+    g_date_time_unref(now);
+    buffer_free(buffer);
+}
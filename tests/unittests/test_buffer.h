@@ -0,0 +1,14 @@
+void empty_buffer_has_size_zero(void **state);
+void yield_out_of_range_returns_null(void **state);
+void push_one_and_yield(void **state);
+void push_keeps_order(void **state);
+void push_beyond_capacity_evicts_oldest(void **state);
+void push_many_keeps_last_entries(void **state);
+void create_with_capacity_sets_capacity(void **state);
+void yield_by_id_returns_entry(void **state);
+void yield_by_id_returns_null_when_evicted(void **state);
+void mark_received_marks_entry(void **state);
+void mark_received_returns_false_when_already_received(void **state);
+void yield_by_id_survives_eviction_of_duplicate_id(void **state);
+void push_front_adds_before_existing(void **state);
+void push_front_does_nothing_when_full(void **state);
@@ -55,3 +55,145 @@ void returns_commands(void **state)
 
     assert_true(foundCommand1 && foundCommand2 && foundCommand3);
 }
+
+static int timed_calls = 0;
+
+static void
+_count_timed_call(PluginTimedFunction *timed_function)
+{
+    timed_calls++;
+}
+
+static PluginTimedFunction*
+_timed_function(int interval_seconds)
+{
+    PluginTimedFunction *timed_function = malloc(sizeof(PluginTimedFunction));
+    timed_function->callback = NULL;
+    timed_function->callback_exec = _count_timed_call;
+    timed_function->callback_destroy = NULL;
+    timed_function->interval_seconds = interval_seconds;
+    timed_function->due = 0;
+    timed_function->heap_index = -1;
+
+    return timed_function;
+}
+
+void no_timed_timeout_when_no_timed_functions(void **state)
+{
+    callbacks_init();
+
+    assert_int_equal(-1, plugins_timed_timeout());
+
+    callbacks_close();
+}
+
+void timed_timeout_is_earliest_due(void **state)
+{
+    callbacks_init();
+    callbacks_add_timed("plugin1", _timed_function(30));
+    callbacks_add_timed("plugin1", _timed_function(5));
+    callbacks_add_timed("plugin2", _timed_function(60));
+
+    gint timeout = plugins_timed_timeout();
+    assert_true(timeout > 4000 && timeout <= 5001);
+
+    callbacks_close();
+}
+
+void timed_timeout_ignores_removed_plugin(void **state)
+{
+    callbacks_init();
+    callbacks_add_timed("plugin1", _timed_function(5));
+    callbacks_add_timed("plugin2", _timed_function(20));
+    callbacks_add_timed("plugin1", _timed_function(10));
+
+    callbacks_remove("plugin1");
+
+    gint timeout = plugins_timed_timeout();
+    assert_true(timeout > 19000 && timeout <= 20001);
+
+    callbacks_close();
+}
+
+void timed_function_not_run_before_due(void **state)
+{
+    callbacks_init();
+    timed_calls = 0;
+    callbacks_add_timed("plugin1", _timed_function(60));
+
+    plugins_run_timed();
+
+    assert_int_equal(0, timed_calls);
+
+    callbacks_close();
+}
+
+static gboolean
+_contains_message_receive(ProfPlugin *plugin, const char *const hook)
+{
+    return g_strcmp0(hook, "prof_on_message_stanza_receive") == 0;
+}
+
+static gboolean
+_on_message_stanza_receive(ProfPlugin *plugin, const char *const text)
+{
+    return TRUE;
+}
+
+static ProfPlugin*
+_hook_plugin(const char *const name)
+{
+    ProfPlugin *plugin = calloc(1, sizeof(ProfPlugin));
+    plugin->name = strdup(name);
+    plugin->lang = LANG_PYTHON;
+    plugin->contains_hook = _contains_message_receive;
+    plugin->on_message_stanza_receive = _on_message_stanza_receive;
+
+    return plugin;
+}
+
+void no_hooks_when_no_plugins(void **state)
+{
+    plugins_init();
+
+    assert_false(plugins_has_hook(PLUGIN_HOOK_MESSAGE_STANZA_RECEIVE));
+    assert_false(plugins_has_hook(PLUGIN_HOOK_IQ_STANZA_SEND));
+
+    plugins_shutdown();
+}
+
+void has_hook_when_plugin_implements_it(void **state)
+{
+    plugins_init();
+    plugins_add("plugin1.py", _hook_plugin("plugin1.py"));
+    plugins_add("plugin2.py", _hook_plugin("plugin2.py"));
+
+    assert_true(plugins_has_hook(PLUGIN_HOOK_MESSAGE_STANZA_RECEIVE));
+    assert_false(plugins_has_hook(PLUGIN_HOOK_MESSAGE_STANZA_SEND));
+    assert_false(plugins_has_hook(PLUGIN_HOOK_PRESENCE_STANZA_RECEIVE));
+    assert_int_equal(2, plugins_get_hook_stats(PLUGIN_HOOK_MESSAGE_STANZA_RECEIVE)->subscribers);
+
+    plugins_shutdown();
+
+    assert_false(plugins_has_hook(PLUGIN_HOOK_MESSAGE_STANZA_RECEIVE));
+}
+
+void hook_stats_count_calls(void **state)
+{
+    plugins_init();
+    plugins_add("plugin1.py", _hook_plugin("plugin1.py"));
+
+    guint calls = plugins_get_hook_stats(PLUGIN_HOOK_MESSAGE_STANZA_RECEIVE)->calls;
+    guint other_calls = plugins_get_hook_stats(PLUGIN_HOOK_IQ_STANZA_RECEIVE)->calls;
+
+    assert_true(plugins_on_message_stanza_receive("<message/>"));
+    assert_true(plugins_on_message_stanza_receive("<message/>"));
+
+    const PluginHookStats *stats = plugins_get_hook_stats(PLUGIN_HOOK_MESSAGE_STANZA_RECEIVE);
+    assert_string_equal("prof_on_message_stanza_receive", stats->name);
+    assert_int_equal(calls + 2, stats->calls);
+    assert_true(stats->elapsed >= 0);
+    assert_int_equal(other_calls, plugins_get_hook_stats(PLUGIN_HOOK_IQ_STANZA_RECEIVE)->calls);
+
+    plugins_shutdown();
+}
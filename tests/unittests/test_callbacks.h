@@ -1,2 +1,9 @@
 void returns_no_commands(void **state);
 void returns_commands(void **state);
+void no_timed_timeout_when_no_timed_functions(void **state);
+void timed_timeout_is_earliest_due(void **state);
+void timed_timeout_ignores_removed_plugin(void **state);
+void timed_function_not_run_before_due(void **state);
+void no_hooks_when_no_plugins(void **state);
+void has_hook_when_plugin_implements_it(void **state);
+void hook_stats_count_calls(void **state);
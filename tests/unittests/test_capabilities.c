@@ -0,0 +1,170 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include "helpers.h"
+#include "xmpp/xmpp.h"
+#include "xmpp/capabilities.h"
+
+#define TEST_CACHE "./tests/files/xdg_data_home/profanity/capscache.bin"
+#define TEST_KEYFILE_CACHE "./tests/files/xdg_data_home/profanity/capscache"
+
+static long
+_file_size(const char *const path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return -1;
+    }
+
+    return st.st_size;
+}
+
+static void
+_append(const char *const path, const char *const data, size_t len)
+{
+    FILE *fp = fopen(path, "ab");
+    assert_non_null(fp);
+    fwrite(data, 1, len, fp);
+    fclose(fp);
+}
+
+static void
+_add_ver(const char *const ver, const char *const name)
+{
+    GSList *features = NULL;
+    features = g_slist_append(features, "urn:xmpp:receipts");
+    features = g_slist_append(features, "urn:example:feature");
+    EntityCapabilities *caps = caps_create("client", "pc", name, "Profanity", "0.5.1", NULL, NULL, features);
+    caps_add_by_ver(ver, caps);
+    caps_destroy(caps);
+    g_slist_free(features);
+}
+
+void create_caps_cache(void **state)
+{
+    load_preferences(state);
+    create_data_dir(state);
+    remove(TEST_CACHE);
+    remove(TEST_KEYFILE_CACHE);
+}
+
+void remove_caps_cache(void **state)
+{
+    remove(TEST_CACHE);
+    remove(TEST_KEYFILE_CACHE);
+    remove_data_dir(state);
+    close_preferences(state);
+}
+
+void caps_cache_loads_saved_entries(void **state)
+{
+    caps_init();
+    _add_ver("ver1", "Bob's client");
+    caps_close();
+
+    caps_init();
+    assert_true(caps_cache_contains("ver1"));
+    assert_false(caps_cache_contains("ver2"));
+
+    caps_map_jid_to_ver("bob@server.org/laptop", "ver1");
+    EntityCapabilities *caps = caps_lookup("bob@server.org/laptop");
+    assert_non_null(caps);
+    assert_string_equal("client", caps->identity->category);
+    assert_string_equal("Bob's client", caps->identity->name);
+    assert_string_equal("0.5.1", caps->software_version->software_version);
+    assert_null(caps->software_version->os);
+    assert_int_equal(2, g_slist_length(caps->features));
+    assert_true(caps_jid_has_feature("bob@server.org/laptop", "urn:xmpp:receipts"));
+    assert_true(caps_jid_has_feature("bob@server.org/laptop", "urn:example:feature"));
+    assert_false(caps_jid_has_feature("bob@server.org/laptop", "urn:example:other"));
+    caps_destroy(caps);
+    caps_close();
+}
+
+void caps_cache_truncates_damaged_tail(void **state)
+{
+    caps_init();
+    _add_ver("ver1", "first");
+    caps_close();
+    long size = _file_size(TEST_CACHE);
+
+    // a record cut off part way through its length
+    _append(TEST_CACHE, "C\x40\x00", 3);
+
+    caps_init();
+    assert_true(caps_cache_contains("ver1"));
+    assert_int_equal(size, _file_size(TEST_CACHE));
+    _add_ver("ver2", "second");
+    caps_close();
+
+    caps_init();
+    assert_true(caps_cache_contains("ver1"));
+    assert_true(caps_cache_contains("ver2"));
+    caps_close();
+}
+
+void caps_cache_truncates_damaged_record(void **state)
+{
+    caps_init();
+    _add_ver("ver1", "first");
+    caps_close();
+    long size = _file_size(TEST_CACHE);
+
+    // a complete record whose ver length runs past the record
+    _append(TEST_CACHE, "C\x04\x00\x00\x00\x10\x00\x00\x00", 9);
+
+    caps_init();
+    assert_true(caps_cache_contains("ver1"));
+    assert_int_equal(size, _file_size(TEST_CACHE));
+    caps_close();
+}
+
+void caps_cache_discards_unknown_format(void **state)
+{
+    _append(TEST_CACHE, "PROFCAPS1S\x03\x00\x00\x00ver", 17);
+
+    caps_init();
+    assert_int_equal(0, _file_size(TEST_CACHE));
+    _add_ver("ver1", "first");
+    caps_close();
+
+    caps_init();
+    assert_true(caps_cache_contains("ver1"));
+    caps_close();
+}
+
+void caps_cache_migrates_key_file(void **state)
+{
+    GKeyFile *keyfile = g_key_file_new();
+    g_key_file_set_string(keyfile, "ver1", "category", "client");
+    g_key_file_set_string(keyfile, "ver1", "name", "Old client");
+    const gchar *features[] = { "urn:xmpp:receipts", "urn:example:feature" };
+    g_key_file_set_string_list(keyfile, "ver1", "features", features, 2);
+    gsize len = 0;
+    gchar *data = g_key_file_to_data(keyfile, &len, NULL);
+    g_file_set_contents(TEST_KEYFILE_CACHE, data, len, NULL);
+    g_free(data);
+    g_key_file_free(keyfile);
+
+    caps_init();
+    assert_true(caps_cache_contains("ver1"));
+    assert_false(g_file_test(TEST_KEYFILE_CACHE, G_FILE_TEST_EXISTS));
+    caps_close();
+
+    caps_init();
+    caps_map_jid_to_ver("bob@server.org/laptop", "ver1");
+    EntityCapabilities *caps = caps_lookup("bob@server.org/laptop");
+    assert_non_null(caps);
+    assert_string_equal("Old client", caps->identity->name);
+    assert_null(caps->software_version);
+    assert_true(caps_jid_has_feature("bob@server.org/laptop", "urn:example:feature"));
+    caps_destroy(caps);
+    caps_close();
+}
@@ -0,0 +1,7 @@
+void create_caps_cache(void **state);
+void remove_caps_cache(void **state);
+void caps_cache_loads_saved_entries(void **state);
+void caps_cache_truncates_damaged_tail(void **state);
+void caps_cache_truncates_damaged_record(void **state);
+void caps_cache_discards_unknown_format(void **state);
+void caps_cache_migrates_key_file(void **state);
@@ -0,0 +1,297 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "tools/log_index.h"
+
+#define TEST_DATA_HOME "./tests/files/xdg_data_home"
+#define TEST_LOGS_DIR TEST_DATA_HOME "/profanity/chatlogs/me_at_server.org"
+#define TEST_LOG TEST_LOGS_DIR "/buddy_at_server.org/2017_01_02.log"
+#define TEST_ROOM_LOG TEST_LOGS_DIR "/rooms/room_at_conf.server.org/2017_01_03.log"
+#define TEST_INDEX_DIR TEST_DATA_HOME "/profanity/search/me_at_server.org"
+
+static void
+_remove_tree(const char *const path)
+{
+    GDir *dir = g_dir_open(path, 0, NULL);
+    if (dir) {
+        const gchar *name = NULL;
+        while ((name = g_dir_read_name(dir)) != NULL) {
+            gchar *child = g_strdup_printf("%s/%s", path, name);
+            _remove_tree(child);
+            g_free(child);
+        }
+        g_dir_close(dir);
+        rmdir(path);
+    } else {
+        remove(path);
+    }
+}
+
+static long
+_append(const char *const path, const char *const line)
+{
+    FILE *fp = fopen(path, "a");
+    assert_non_null(fp);
+    fseek(fp, 0, SEEK_END);
+    long offset = ftell(fp);
+    fputs(line, fp);
+    fclose(fp);
+
+    return offset;
+}
+
+static void
+_connect(void)
+{
+    log_index_on_connect("me@server.org");
+    while (log_index_backfilling()) {
+        g_usleep(1000);
+    }
+}
+
+static int
+_count(const char *const query)
+{
+    GSList *results = log_index_search(query, 100);
+    int count = g_slist_length(results);
+    g_slist_free_full(results, (GDestroyNotify)log_index_free_result);
+
+    return count;
+}
+
+static int
+_count_segments(void)
+{
+    int count = 0;
+    GDir *dir = g_dir_open(TEST_INDEX_DIR, 0, NULL);
+    assert_non_null(dir);
+    const gchar *name = NULL;
+    while ((name = g_dir_read_name(dir)) != NULL) {
+        if (g_str_has_prefix(name, "seg-")) {
+            count++;
+        }
+    }
+    g_dir_close(dir);
+
+    return count;
+}
+
+void
+create_log_index_dir(void **state)
+{
+    setenv("XDG_DATA_HOME", TEST_DATA_HOME, 1);
+    if (!mkdir_recursive(TEST_LOGS_DIR "/buddy_at_server.org") ||
+            !mkdir_recursive(TEST_LOGS_DIR "/rooms/room_at_conf.server.org")) {
+        assert_true(FALSE);
+    }
+}
+
+void
+remove_log_index_dir(void **state)
+{
+    log_index_on_disconnect();
+    _remove_tree(TEST_DATA_HOME);
+    rmdir("./tests/files");
+}
+
+void
+search_finds_backfilled_line(void **state)
+{
+    _append(TEST_LOG, "10:00:00 - buddy: hello there\n");
+    _connect();
+
+    GSList *results = log_index_search("hello", 10);
+
+    assert_int_equal(1, g_slist_length(results));
+    LogIndexResult *result = results->data;
+    assert_string_equal("buddy@server.org", result->jid);
+    assert_false(result->room);
+    assert_string_equal("2017-01-02", result->date);
+    assert_string_equal("10:00:00 - buddy: hello there", result->line);
+
+    g_slist_free_full(results, (GDestroyNotify)log_index_free_result);
+}
+
+void
+search_finds_room_line(void **state)
+{
+    _append(TEST_ROOM_LOG, "11:00:00 - alice: meeting moved\n");
+    _connect();
+
+    GSList *results = log_index_search("meeting", 10);
+
+    assert_int_equal(1, g_slist_length(results));
+    LogIndexResult *result = results->data;
+    assert_string_equal("room@conf.server.org", result->jid);
+    assert_true(result->room);
+
+    g_slist_free_full(results, (GDestroyNotify)log_index_free_result);
+}
+
+void
+search_ignores_case_and_punctuation(void **state)
+{
+    _append(TEST_LOG, "10:00:00 - buddy: Hello, World!\n");
+    _connect();
+
+    assert_int_equal(1, _count("WORLD"));
+    assert_int_equal(1, _count("hello world"));
+    assert_int_equal(1, _count("world, hello."));
+}
+
+void
+search_skips_timestamp_and_short_tokens(void **state)
+{
+    _append(TEST_LOG, "10:00:00 - buddy: a ok\n");
+    _connect();
+
+    assert_int_equal(0, _count("10"));
+    assert_int_equal(0, _count("a"));
+    assert_int_equal(1, _count("ok"));
+}
+
+void
+search_requires_all_tokens(void **state)
+{
+    _append(TEST_LOG, "10:00:00 - buddy: hello world\n");
+    _append(TEST_LOG, "10:00:01 - buddy: hello there\n");
+    _connect();
+
+    assert_int_equal(2, _count("hello"));
+    assert_int_equal(1, _count("hello world"));
+    assert_int_equal(0, _count("world there"));
+    assert_int_equal(0, _count("missing"));
+}
+
+void
+search_returns_latest_matches_up_to_max(void **state)
+{
+    _append(TEST_LOG, "10:00:00 - buddy: ping one\n");
+    _append(TEST_LOG, "10:00:01 - buddy: ping two\n");
+    _append(TEST_LOG, "10:00:02 - buddy: ping three\n");
+    _connect();
+
+    GSList *results = log_index_search("ping", 2);
+
+    assert_int_equal(2, g_slist_length(results));
+    assert_string_equal("10:00:01 - buddy: ping two", ((LogIndexResult*)results->data)->line);
+    assert_string_equal("10:00:02 - buddy: ping three", ((LogIndexResult*)results->next->data)->line);
+
+    g_slist_free_full(results, (GDestroyNotify)log_index_free_result);
+}
+
+void
+add_line_indexes_next_line(void **state)
+{
+    _append(TEST_LOG, "10:00:00 - buddy: first\n");
+    _connect();
+
+    const char *line = "10:00:01 - buddy: second\n";
+    long offset = _append(TEST_LOG, line);
+    log_index_add_line(TEST_LOG, offset, line);
+
+    assert_int_equal(1, _count("first"));
+    assert_int_equal(1, _count("second"));
+}
+
+void
+add_line_after_gap_is_indexed_when_flushed(void **state)
+{
+    _append(TEST_LOG, "10:00:00 - buddy: first\n");
+    _connect();
+
+    // still in the writer's buffer when the line after it is added
+    _append(TEST_LOG, "10:00:01 - buddy: buffered\n");
+    const char *line = "10:00:02 - buddy: latest\n";
+    long offset = _append(TEST_LOG, line);
+    log_index_add_line(TEST_LOG, offset, line);
+
+    assert_int_equal(0, _count("buffered"));
+    assert_int_equal(0, _count("latest"));
+
+    log_index_flushed(TEST_LOG, offset + strlen(line));
+
+    assert_int_equal(1, _count("buffered"));
+    assert_int_equal(1, _count("latest"));
+
+    const char *next = "10:00:03 - buddy: next\n";
+    offset = _append(TEST_LOG, next);
+    log_index_add_line(TEST_LOG, offset, next);
+
+    assert_int_equal(1, _count("next"));
+}
+
+void
+backfill_resumes_from_indexed_offset(void **state)
+{
+    _append(TEST_LOG, "10:00:00 - buddy: before\n");
+    _connect();
+    log_index_on_disconnect();
+
+    _append(TEST_LOG, "10:00:01 - buddy: after\n");
+    _connect();
+
+    assert_int_equal(1, _count("before"));
+    assert_int_equal(1, _count("after"));
+    assert_int_equal(2, _count("buddy"));
+}
+
+void
+backfill_skips_unterminated_line(void **state)
+{
+    _append(TEST_LOG, "10:00:00 - buddy: done\n");
+    _append(TEST_LOG, "10:00:01 - buddy: partial");
+    _connect();
+
+    assert_int_equal(1, _count("done"));
+    assert_int_equal(0, _count("partial"));
+}
+
+void
+connect_twice_keeps_one_index(void **state)
+{
+    _append(TEST_LOG, "10:00:00 - buddy: hello there\n");
+    _connect();
+    _connect();
+
+    assert_int_equal(1, _count("hello"));
+}
+
+void
+index_is_kept_in_segments_across_connects(void **state)
+{
+    // enough lines for several segments, which get merged as they accumulate
+    FILE *fp = fopen(TEST_LOG, "a");
+    assert_non_null(fp);
+    int i;
+    for (i = 0; i < 20480; i++) {
+        fprintf(fp, "10:00:00 - buddy: w%d common\n", i);
+    }
+    fclose(fp);
+
+    _connect();
+
+    assert_int_equal(1, _count("w0"));
+    assert_int_equal(1, _count("w12345"));
+    assert_int_equal(1, _count("w20479 common"));
+
+    log_index_on_disconnect();
+
+    int segments = _count_segments();
+    assert_true(segments > 0);
+    assert_true(segments < 5);
+
+    _connect();
+
+    assert_int_equal(1, _count("w0"));
+    assert_int_equal(1, _count("w20479"));
+    assert_int_equal(1, _count("w7 common"));
+}
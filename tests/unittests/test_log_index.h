@@ -0,0 +1,14 @@
+void create_log_index_dir(void **state);
+void remove_log_index_dir(void **state);
+void search_finds_backfilled_line(void **state);
+void search_finds_room_line(void **state);
+void search_ignores_case_and_punctuation(void **state);
+void search_skips_timestamp_and_short_tokens(void **state);
+void search_requires_all_tokens(void **state);
+void search_returns_latest_matches_up_to_max(void **state);
+void add_line_indexes_next_line(void **state);
+void add_line_after_gap_is_indexed_when_flushed(void **state);
+void backfill_resumes_from_indexed_offset(void **state);
+void backfill_skips_unterminated_line(void **state);
+void connect_twice_keeps_one_index(void **state);
+void index_is_kept_in_segments_across_connects(void **state);
@@ -0,0 +1,151 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+
+#include "tools/matcher.h"
+
+static MatcherMatch*
+_match_at(GSList *matches, int index)
+{
+    return g_slist_nth_data(matches, index);
+}
+
+void
+matcher_finds_nothing_when_empty(void **state)
+{
+    Matcher matcher = matcher_new();
+
+    GSList *matches = matcher_find_all(matcher, "some text");
+
+    assert_null(matches);
+
+    matcher_free(matcher);
+}
+
+void
+matcher_finds_nothing_when_no_match(void **state)
+{
+    Matcher matcher = matcher_new();
+    matcher_add(matcher, "boothj5", 0);
+
+    GSList *matches = matcher_find_all(matcher, "hello there");
+
+    assert_null(matches);
+
+    matcher_free(matcher);
+}
+
+void
+matcher_finds_single_pattern(void **state)
+{
+    Matcher matcher = matcher_new();
+    matcher_add(matcher, "boothj5", 3);
+
+    GSList *matches = matcher_find_all(matcher, "hi boothj5!");
+
+    assert_int_equal(1, g_slist_length(matches));
+    assert_int_equal(3, _match_at(matches, 0)->id);
+    assert_int_equal(3, _match_at(matches, 0)->start);
+    assert_int_equal(3, _match_at(matches, 0)->offset);
+    assert_int_equal(7, _match_at(matches, 0)->len);
+
+    g_slist_free_full(matches, free);
+    matcher_free(matcher);
+}
+
+void
+matcher_finds_overlapping_patterns(void **state)
+{
+    Matcher matcher = matcher_new();
+    matcher_add(matcher, "he", 0);
+    matcher_add(matcher, "she", 1);
+    matcher_add(matcher, "hers", 2);
+
+    GSList *matches = matcher_find_all(matcher, "ushers");
+
+    assert_int_equal(3, g_slist_length(matches));
+    assert_int_equal(1, _match_at(matches, 0)->id);
+    assert_int_equal(1, _match_at(matches, 0)->start);
+    assert_int_equal(0, _match_at(matches, 1)->id);
+    assert_int_equal(2, _match_at(matches, 1)->start);
+    assert_int_equal(2, _match_at(matches, 2)->id);
+    assert_int_equal(2, _match_at(matches, 2)->start);
+
+    g_slist_free_full(matches, free);
+    matcher_free(matcher);
+}
+
+void
+matcher_finds_repeated_pattern(void **state)
+{
+    Matcher matcher = matcher_new();
+    matcher_add(matcher, "pp", 0);
+
+    GSList *matches = matcher_find_all(matcher, "pppp");
+
+    assert_int_equal(3, g_slist_length(matches));
+    assert_int_equal(0, _match_at(matches, 0)->start);
+    assert_int_equal(1, _match_at(matches, 1)->start);
+    assert_int_equal(2, _match_at(matches, 2)->start);
+
+    g_slist_free_full(matches, free);
+    matcher_free(matcher);
+}
+
+void
+matcher_reports_each_id_for_same_pattern(void **state)
+{
+    Matcher matcher = matcher_new();
+    matcher_add(matcher, "alert", 0);
+    matcher_add(matcher, "alert", 1);
+
+    GSList *matches = matcher_find_all(matcher, "red alert");
+
+    assert_int_equal(2, g_slist_length(matches));
+    int ids = (1 << _match_at(matches, 0)->id) | (1 << _match_at(matches, 1)->id);
+    assert_int_equal(3, ids);
+
+    g_slist_free_full(matches, free);
+    matcher_free(matcher);
+}
+
+void
+matcher_reports_character_offsets(void **state)
+{
+    Matcher matcher = matcher_new();
+    matcher_add(matcher, "玻璃", 0);
+
+    GSList *matches = matcher_find_all(matcher, "我能吞下玻璃而");
+
+    assert_int_equal(1, g_slist_length(matches));
+    assert_int_equal(12, _match_at(matches, 0)->start);
+    assert_int_equal(4, _match_at(matches, 0)->offset);
+    assert_int_equal(6, _match_at(matches, 0)->len);
+
+    g_slist_free_full(matches, free);
+    matcher_free(matcher);
+}
+
+void
+matcher_finds_patterns_added_after_search(void **state)
+{
+    Matcher matcher = matcher_new();
+    matcher_add(matcher, "one", 0);
+    GSList *matches = matcher_find_all(matcher, "one two");
+    g_slist_free_full(matches, free);
+
+    matcher_add(matcher, "two", 1);
+    matches = matcher_find_all(matcher, "one two");
+
+    assert_int_equal(2, g_slist_length(matches));
+    assert_int_equal(0, _match_at(matches, 0)->id);
+    assert_int_equal(1, _match_at(matches, 1)->id);
+    assert_int_equal(4, _match_at(matches, 1)->offset);
+
+    g_slist_free_full(matches, free);
+    matcher_free(matcher);
+}
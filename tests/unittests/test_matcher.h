@@ -0,0 +1,8 @@
+void matcher_finds_nothing_when_empty(void **state);
+void matcher_finds_nothing_when_no_match(void **state);
+void matcher_finds_single_pattern(void **state);
+void matcher_finds_overlapping_patterns(void **state);
+void matcher_finds_repeated_pattern(void **state);
+void matcher_reports_each_id_for_same_pattern(void **state);
+void matcher_reports_character_offsets(void **state);
+void matcher_finds_patterns_added_after_search(void **state);
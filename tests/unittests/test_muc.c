@@ -76,3 +76,69 @@ void test_muc_active(void **state)
 
     assert_true(room_is_active);
 }
+
+void test_muc_roster_sorted_by_nick(void **state)
+{
+    char *room = "room@server.org";
+    muc_join(room, "bob", NULL, FALSE);
+    muc_roster_add(room, "mike", NULL, "participant", "none", NULL, NULL);
+    muc_roster_add(room, "anna", NULL, "participant", "none", NULL, NULL);
+    muc_roster_add(room, "zoe", NULL, "participant", "none", NULL, NULL);
+    muc_roster_add(room, "carl", NULL, "participant", "none", NULL, NULL);
+    muc_roster_remove(room, "zoe");
+
+    GList *occupants = muc_roster(room);
+
+    assert_int_equal(3, g_list_length(occupants));
+    assert_string_equal("anna", ((Occupant*)g_list_nth_data(occupants, 0))->nick);
+    assert_string_equal("carl", ((Occupant*)g_list_nth_data(occupants, 1))->nick);
+    assert_string_equal("mike", ((Occupant*)g_list_nth_data(occupants, 2))->nick);
+
+    g_list_free(occupants);
+}
+
+void test_muc_roster_add_updates_existing_occupant(void **state)
+{
+    char *room = "room@server.org";
+    muc_join(room, "bob", NULL, FALSE);
+    muc_roster_add(room, "anna", NULL, "participant", "none", NULL, NULL);
+    Occupant *before = muc_roster_item(room, "anna");
+
+    gboolean updated = muc_roster_add(room, "anna", "anna@server.org", "moderator", "owner", "away", "lunch");
+
+    Occupant *after = muc_roster_item(room, "anna");
+    assert_true(updated);
+    assert_ptr_equal(before, after);
+    assert_int_equal(MUC_ROLE_MODERATOR, after->role);
+    assert_int_equal(MUC_AFFILIATION_OWNER, after->affiliation);
+    assert_string_equal("anna@server.org", after->jid);
+    assert_string_equal("lunch", after->status);
+
+    GList *occupants = muc_roster(room);
+    assert_int_equal(1, g_list_length(occupants));
+    g_list_free(occupants);
+}
+
+void test_muc_occupants_by_role_sorted_by_nick(void **state)
+{
+    char *room = "room@server.org";
+    muc_join(room, "bob", NULL, FALSE);
+    muc_roster_add(room, "mike", NULL, "participant", "none", NULL, NULL);
+    muc_roster_add(room, "anna", NULL, "moderator", "owner", NULL, NULL);
+    muc_roster_add(room, "zoe", NULL, "participant", "member", NULL, NULL);
+    muc_roster_add(room, "carl", NULL, "participant", "member", NULL, NULL);
+
+    GSList *participants = muc_occupants_by_role(room, MUC_ROLE_PARTICIPANT);
+    GSList *members = muc_occupants_by_affiliation(room, MUC_AFFILIATION_MEMBER);
+
+    assert_int_equal(3, g_slist_length(participants));
+    assert_string_equal("carl", ((Occupant*)g_slist_nth_data(participants, 0))->nick);
+    assert_string_equal("mike", ((Occupant*)g_slist_nth_data(participants, 1))->nick);
+    assert_string_equal("zoe", ((Occupant*)g_slist_nth_data(participants, 2))->nick);
+    assert_int_equal(2, g_slist_length(members));
+    assert_string_equal("carl", ((Occupant*)g_slist_nth_data(members, 0))->nick);
+    assert_string_equal("zoe", ((Occupant*)g_slist_nth_data(members, 1))->nick);
+
+    g_slist_free(participants);
+    g_slist_free(members);
+}
@@ -7,3 +7,6 @@ void test_muc_invites_count_0(void **state);
 void test_muc_invites_count_5(void **state);
 void test_muc_room_is_not_active(void **state);
 void test_muc_active(void **state);
+void test_muc_roster_sorted_by_nick(void **state);
+void test_muc_roster_add_updates_existing_occupant(void **state);
+void test_muc_occupants_by_role_sorted_by_nick(void **state);
@@ -31,3 +31,48 @@ void statuses_muc_defaults_to_all(void **state)
     assert_non_null(setting);
     assert_string_equal("all", setting);
 }
+
+void boolean_updated_after_set(void **state)
+{
+    prefs_set_boolean(PREF_BEEP, FALSE);
+    assert_false(prefs_get_boolean(PREF_BEEP));
+
+    prefs_set_boolean(PREF_BEEP, TRUE);
+    assert_true(prefs_get_boolean(PREF_BEEP));
+}
+
+void peek_string_returns_default(void **state)
+{
+    const char *setting = prefs_peek_string(PREF_STATUSES_MUC);
+
+    assert_non_null(setting);
+    assert_string_equal("all", setting);
+}
+
+void peek_string_returns_updated_value_after_set(void **state)
+{
+    prefs_peek_string(PREF_STATUSES_MUC);
+    prefs_set_string(PREF_STATUSES_MUC, "none");
+
+    assert_string_equal("none", prefs_peek_string(PREF_STATUSES_MUC));
+}
+
+void get_string_returns_copy_of_cached_value(void **state)
+{
+    char *setting = prefs_get_string(PREF_STATUSES_MUC);
+
+    assert_string_equal(prefs_peek_string(PREF_STATUSES_MUC), setting);
+    assert_ptr_not_equal(prefs_peek_string(PREF_STATUSES_MUC), setting);
+    prefs_free_string(setting);
+}
+
+void max_fps_updated_after_set(void **state)
+{
+    assert_int_equal(30, prefs_get_max_fps());
+
+    prefs_set_max_fps(60);
+    assert_int_equal(60, prefs_get_max_fps());
+
+    prefs_set_max_fps(0);
+    assert_int_equal(30, prefs_get_max_fps());
+}
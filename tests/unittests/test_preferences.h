@@ -1,3 +1,8 @@
 void statuses_console_defaults_to_all(void **state);
 void statuses_chat_defaults_to_all(void **state);
 void statuses_muc_defaults_to_all(void **state);
+void boolean_updated_after_set(void **state);
+void peek_string_returns_default(void **state);
+void peek_string_returns_updated_value_after_set(void **state);
+void get_string_returns_copy_of_cached_value(void **state);
+void max_fps_updated_after_set(void **state);
@@ -0,0 +1,130 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "helpers.h"
+#include "xmpp/contact.h"
+#include "xmpp/roster_cache.h"
+#include "xmpp/roster_list.h"
+
+#define TEST_ROSTER_DIR "./tests/files/xdg_data_home/profanity/roster"
+#define TEST_ROSTER_CACHE TEST_ROSTER_DIR "/me_at_server.org"
+
+// closes the cache and starts again with an empty roster, as on reconnect
+static void
+_reload(void)
+{
+    roster_cache_close();
+    roster_destroy();
+    roster_create();
+    roster_cache_load("me@server.org");
+}
+
+void create_roster_cache(void **state)
+{
+    load_preferences(state);
+    create_data_dir(state);
+    remove(TEST_ROSTER_CACHE);
+    roster_create();
+    roster_cache_load("me@server.org");
+}
+
+void remove_roster_cache(void **state)
+{
+    roster_cache_close();
+    roster_destroy();
+    remove(TEST_ROSTER_CACHE);
+    rmdir(TEST_ROSTER_DIR);
+    remove_data_dir(state);
+    close_preferences(state);
+}
+
+void roster_cache_not_loaded_when_missing(void **state)
+{
+    assert_false(roster_cache_is_loaded());
+    assert_null(roster_cache_get_ver());
+}
+
+void roster_cache_loads_saved_contacts(void **state)
+{
+    GSList *groups = g_slist_append(NULL, strdup("friends"));
+    groups = g_slist_append(groups, strdup("work;home"));
+    roster_add("bob@server.org", "Bob", groups, "both", FALSE);
+    roster_add("mike@server.org", NULL, NULL, "to", TRUE);
+    roster_cache_replace("ver1");
+
+    _reload();
+
+    assert_true(roster_cache_is_loaded());
+    assert_string_equal("ver1", roster_cache_get_ver());
+
+    PContact bob = roster_get_contact("bob@server.org");
+    assert_non_null(bob);
+    assert_string_equal("Bob", p_contact_name(bob));
+    assert_string_equal("both", p_contact_subscription(bob));
+    assert_false(p_contact_pending_out(bob));
+    GSList *bob_groups = p_contact_groups(bob);
+    assert_int_equal(2, g_slist_length(bob_groups));
+    assert_string_equal("friends", bob_groups->data);
+    assert_string_equal("work;home", bob_groups->next->data);
+
+    PContact mike = roster_get_contact("mike@server.org");
+    assert_non_null(mike);
+    assert_null(p_contact_name(mike));
+    assert_string_equal("to", p_contact_subscription(mike));
+    assert_true(p_contact_pending_out(mike));
+    assert_null(p_contact_groups(mike));
+}
+
+void roster_cache_keeps_jids_with_brackets(void **state)
+{
+    roster_add("odd[1]@server.org", "Odd", NULL, "both", FALSE);
+    roster_add("]odd@server.org", NULL, NULL, "both", FALSE);
+    roster_cache_replace("ver1");
+
+    _reload();
+
+    assert_true(roster_cache_is_loaded());
+    assert_non_null(roster_get_contact("odd[1]@server.org"));
+    assert_non_null(roster_get_contact("]odd@server.org"));
+}
+
+void roster_cache_saves_pushes_on_close(void **state)
+{
+    roster_add("bob@server.org", "Bob", NULL, "both", FALSE);
+    roster_cache_replace("ver1");
+    _reload();
+
+    roster_add("mike@server.org", "Mike", NULL, "both", FALSE);
+    roster_cache_push("ver2");
+    _reload();
+
+    assert_string_equal("ver2", roster_cache_get_ver());
+    assert_non_null(roster_get_contact("bob@server.org"));
+    assert_non_null(roster_get_contact("mike@server.org"));
+}
+
+void roster_cache_removed_when_roster_unversioned(void **state)
+{
+    roster_add("bob@server.org", "Bob", NULL, "both", FALSE);
+    roster_cache_replace("ver1");
+    _reload();
+    assert_true(roster_cache_is_loaded());
+
+    roster_destroy();
+    roster_create();
+    roster_add("bob@server.org", "Bob", NULL, "both", FALSE);
+    roster_cache_replace(NULL);
+
+    assert_int_equal(-1, access(TEST_ROSTER_CACHE, F_OK));
+    _reload();
+    assert_false(roster_cache_is_loaded());
+    assert_null(roster_cache_get_ver());
+    assert_null(roster_get_contact("bob@server.org"));
+}
@@ -0,0 +1,7 @@
+void create_roster_cache(void **state);
+void remove_roster_cache(void **state);
+void roster_cache_not_loaded_when_missing(void **state);
+void roster_cache_loads_saved_contacts(void **state);
+void roster_cache_keeps_jids_with_brackets(void **state);
+void roster_cache_saves_pushes_on_close(void **state);
+void roster_cache_removed_when_roster_unversioned(void **state);
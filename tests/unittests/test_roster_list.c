@@ -637,3 +637,66 @@ void remove_contact_with_remaining_in_group(void **state)
     g_slist_free_full(groups_res, g_free);
     roster_destroy();
 }
+
+void contacts_reordered_after_name_change(void **state)
+{
+    roster_create();
+    roster_add("bob@server.org", "Bob", NULL, NULL, FALSE);
+    roster_add("dave@server.org", "Dave", NULL, NULL, FALSE);
+
+    roster_change_name(roster_get_contact("bob@server.org"), "Zed");
+
+    GSList *list = roster_get_contacts(ROSTER_ORD_NAME);
+    assert_string_equal("dave@server.org", p_contact_barejid(list->data));
+    assert_string_equal("bob@server.org", p_contact_barejid(g_slist_next(list)->data));
+
+    g_slist_free(list);
+    roster_destroy();
+}
+
+void contacts_reordered_after_presence_update(void **state)
+{
+    roster_create();
+    roster_add("bob@server.org", NULL, NULL, NULL, FALSE);
+    roster_add("dave@server.org", NULL, NULL, NULL, FALSE);
+
+    Resource *resource = resource_new("laptop", RESOURCE_ONLINE, NULL, 10);
+    roster_update_presence("dave@server.org", resource, NULL);
+
+    GSList *list = roster_get_contacts(ROSTER_ORD_PRESENCE);
+    assert_string_equal("dave@server.org", p_contact_barejid(list->data));
+    assert_string_equal("bob@server.org", p_contact_barejid(g_slist_next(list)->data));
+    g_slist_free(list);
+
+    roster_contact_offline("dave@server.org", "laptop", NULL);
+
+    list = roster_get_contacts(ROSTER_ORD_PRESENCE);
+    assert_string_equal("bob@server.org", p_contact_barejid(list->data));
+    assert_string_equal("dave@server.org", p_contact_barejid(g_slist_next(list)->data));
+
+    g_slist_free(list);
+    roster_destroy();
+}
+
+void group_members_follow_group_update(void **state)
+{
+    roster_create();
+
+    GSList *groups = NULL;
+    groups = g_slist_append(groups, strdup("friends"));
+    roster_add("bob@server.org", NULL, groups, NULL, FALSE);
+
+    GSList *new_groups = NULL;
+    new_groups = g_slist_append(new_groups, strdup("work"));
+    roster_update("bob@server.org", NULL, new_groups, NULL, FALSE);
+
+    assert_null(roster_get_group("friends", ROSTER_ORD_NAME));
+    assert_null(roster_get_group(NULL, ROSTER_ORD_NAME));
+
+    GSList *list = roster_get_group("work", ROSTER_ORD_NAME);
+    assert_int_equal(1, g_slist_length(list));
+    assert_string_equal("bob@server.org", p_contact_barejid(list->data));
+
+    g_slist_free(list);
+    roster_destroy();
+}
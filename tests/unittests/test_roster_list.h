@@ -30,3 +30,6 @@ void add_contacts_with_different_groups(void **state);
 void add_contacts_with_same_groups(void **state);
 void add_contacts_with_overlapping_groups(void **state);
 void remove_contact_with_remaining_in_group(void **state);
+void contacts_reordered_after_name_change(void **state);
+void contacts_reordered_after_presence_update(void **state);
+void group_members_follow_group_update(void **state);
@@ -0,0 +1,132 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "helpers.h"
+#include "pgp/sig_cache.h"
+
+#define TEST_SIG_CACHE "./tests/files/xdg_data_home/profanity/sigcache"
+
+static char*
+_sign(int i)
+{
+    return g_strdup_printf("signature %d", i);
+}
+
+static void
+_fill(const char *const barejid, int from, int to)
+{
+    int i;
+    for (i = from; i < to; i++) {
+        char *sign = _sign(i);
+        char *keyid = g_strdup_printf("KEY%d", i);
+        sig_cache_add(barejid, sign, keyid);
+        g_free(keyid);
+        g_free(sign);
+    }
+}
+
+static gboolean
+_contains(const char *const barejid, int i)
+{
+    char *sign = _sign(i);
+    const char *keyid = sig_cache_lookup(barejid, sign);
+    g_free(sign);
+
+    return keyid != NULL;
+}
+
+void create_sig_cache(void **state)
+{
+    create_data_dir(state);
+    remove(TEST_SIG_CACHE);
+    sig_cache_init();
+    sig_cache_load(TEST_SIG_CACHE);
+}
+
+void remove_sig_cache(void **state)
+{
+    sig_cache_close();
+    remove(TEST_SIG_CACHE);
+    remove_data_dir(state);
+}
+
+void sig_cache_finds_added_signature(void **state)
+{
+    sig_cache_add("bob@server.org", "signature", "ABCD1234");
+
+    assert_string_equal("ABCD1234", sig_cache_lookup("bob@server.org", "signature"));
+    assert_null(sig_cache_lookup("bob@server.org", "other signature"));
+}
+
+void sig_cache_separates_contacts(void **state)
+{
+    sig_cache_add("bob@server.org", "signature", "ABCD1234");
+
+    assert_null(sig_cache_lookup("mike@server.org", "signature"));
+}
+
+void sig_cache_drops_add_after_clear(void **state)
+{
+    sig_cache_add("bob@server.org", "signature", "ABCD1234");
+    sig_cache_save();
+    sig_cache_clear();
+
+    sig_cache_add("bob@server.org", "late signature", "ABCD1234");
+    assert_int_equal(0, sig_cache_size());
+
+    sig_cache_load(TEST_SIG_CACHE);
+    assert_non_null(sig_cache_lookup("bob@server.org", "signature"));
+    assert_null(sig_cache_lookup("bob@server.org", "late signature"));
+}
+
+void sig_cache_evicts_least_recently_used(void **state)
+{
+    _fill("bob@server.org", 0, SIG_CACHE_MAX);
+    assert_int_equal(SIG_CACHE_MAX, sig_cache_size());
+
+    assert_true(_contains("bob@server.org", 0));
+    _fill("bob@server.org", SIG_CACHE_MAX, SIG_CACHE_MAX + 1);
+
+    assert_int_equal(SIG_CACHE_MAX, sig_cache_size());
+    assert_true(_contains("bob@server.org", 0));
+    assert_false(_contains("bob@server.org", 1));
+    assert_true(_contains("bob@server.org", 2));
+    assert_true(_contains("bob@server.org", SIG_CACHE_MAX));
+}
+
+void sig_cache_keeps_entries_after_save_and_load(void **state)
+{
+    sig_cache_add("bob@server.org", "signature", "ABCD1234");
+    sig_cache_add("mike@server.org", "signature", "EFGH5678");
+    sig_cache_save();
+    sig_cache_clear();
+    assert_int_equal(0, sig_cache_size());
+
+    sig_cache_load(TEST_SIG_CACHE);
+
+    assert_int_equal(2, sig_cache_size());
+    assert_string_equal("ABCD1234", sig_cache_lookup("bob@server.org", "signature"));
+    assert_string_equal("EFGH5678", sig_cache_lookup("mike@server.org", "signature"));
+}
+
+void sig_cache_keeps_recent_use_after_save_and_load(void **state)
+{
+    _fill("bob@server.org", 0, 10);
+    assert_true(_contains("bob@server.org", 0));
+    sig_cache_save();
+    sig_cache_clear();
+
+    sig_cache_load(TEST_SIG_CACHE);
+    _fill("bob@server.org", 10, SIG_CACHE_MAX + 1);
+
+    assert_int_equal(SIG_CACHE_MAX, sig_cache_size());
+    assert_true(_contains("bob@server.org", 0));
+    assert_false(_contains("bob@server.org", 1));
+    assert_true(_contains("bob@server.org", 2));
+}
@@ -0,0 +1,8 @@
+void create_sig_cache(void **state);
+void remove_sig_cache(void **state);
+void sig_cache_finds_added_signature(void **state);
+void sig_cache_separates_contacts(void **state);
+void sig_cache_drops_add_after_clear(void **state);
+void sig_cache_evicts_least_recently_used(void **state);
+void sig_cache_keeps_entries_after_save_and_load(void **state);
+void sig_cache_keeps_recent_use_after_save_and_load(void **state);
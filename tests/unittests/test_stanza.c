@@ -0,0 +1,82 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+
+#include "xmpp/stanza.h"
+
+void create_xmpp_ctx(void **state)
+{
+    xmpp_ctx_t *ctx = xmpp_ctx_new(NULL, NULL);
+    assert_non_null(ctx);
+    *state = ctx;
+}
+
+void free_xmpp_ctx(void **state)
+{
+    xmpp_ctx_free(*state);
+}
+
+void roster_iq_has_no_ver_when_not_cached(void **state)
+{
+    xmpp_stanza_t *iq = stanza_create_roster_iq(*state, NULL);
+
+    assert_string_equal(STANZA_NAME_IQ, xmpp_stanza_get_name(iq));
+    assert_string_equal(STANZA_TYPE_GET, xmpp_stanza_get_type(iq));
+    assert_string_equal("roster", xmpp_stanza_get_id(iq));
+
+    xmpp_stanza_t *query = xmpp_stanza_get_child_by_name(iq, STANZA_NAME_QUERY);
+    assert_non_null(query);
+    assert_string_equal(XMPP_NS_ROSTER, xmpp_stanza_get_ns(query));
+    assert_null(xmpp_stanza_get_attribute(query, STANZA_ATTR_VER));
+
+    xmpp_stanza_release(iq);
+}
+
+void roster_iq_has_cached_ver(void **state)
+{
+    xmpp_stanza_t *iq = stanza_create_roster_iq(*state, "ver14");
+
+    xmpp_stanza_t *query = xmpp_stanza_get_child_by_name(iq, STANZA_NAME_QUERY);
+    assert_non_null(query);
+    assert_string_equal(XMPP_NS_ROSTER, xmpp_stanza_get_ns(query));
+    assert_string_equal("ver14", xmpp_stanza_get_attribute(query, STANZA_ATTR_VER));
+
+    xmpp_stanza_release(iq);
+}
+
+void sm_enable_does_not_ask_resume(void **state)
+{
+    xmpp_stanza_t *enable = stanza_create_sm_enable(*state);
+
+    assert_string_equal(STANZA_NAME_ENABLE, xmpp_stanza_get_name(enable));
+    assert_string_equal(STANZA_NS_SM, xmpp_stanza_get_ns(enable));
+    assert_null(xmpp_stanza_get_attribute(enable, "resume"));
+
+    xmpp_stanza_release(enable);
+}
+
+void sm_request_has_no_h(void **state)
+{
+    xmpp_stanza_t *request = stanza_create_sm_request(*state);
+
+    assert_string_equal(STANZA_NAME_SM_REQUEST, xmpp_stanza_get_name(request));
+    assert_string_equal(STANZA_NS_SM, xmpp_stanza_get_ns(request));
+    assert_null(xmpp_stanza_get_attribute(request, STANZA_ATTR_H));
+
+    xmpp_stanza_release(request);
+}
+
+void sm_ack_has_h(void **state)
+{
+    xmpp_stanza_t *ack = stanza_create_sm_ack(*state, 4294967295u);
+
+    assert_string_equal(STANZA_NAME_SM_ACK, xmpp_stanza_get_name(ack));
+    assert_string_equal(STANZA_NS_SM, xmpp_stanza_get_ns(ack));
+    assert_string_equal("4294967295", xmpp_stanza_get_attribute(ack, STANZA_ATTR_H));
+
+    xmpp_stanza_release(ack);
+}
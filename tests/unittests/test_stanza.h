@@ -0,0 +1,7 @@
+void create_xmpp_ctx(void **state);
+void free_xmpp_ctx(void **state);
+void roster_iq_has_no_ver_when_not_cached(void **state);
+void roster_iq_has_cached_ver(void **state);
+void sm_enable_does_not_ask_resume(void **state);
+void sm_request_has_no_h(void **state);
+void sm_ack_has_h(void **state);
@@ -0,0 +1,146 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+
+#include "xmpp/stream_mgmt.h"
+
+// queues count stanzas named "msg1", "msg2" and so on
+static void
+_queue(int count)
+{
+    int i;
+    for (i = 1; i <= count; i++) {
+        char *text = g_strdup_printf("msg%d", i);
+        stream_mgmt_queue(text);
+        g_free(text);
+    }
+}
+
+void create_stream_mgmt(void **state)
+{
+    stream_mgmt_init();
+}
+
+void remove_stream_mgmt(void **state)
+{
+    stream_mgmt_shutdown();
+}
+
+void stream_mgmt_ack_drops_handled_stanzas(void **state)
+{
+    stream_mgmt_enabled();
+    _queue(3);
+
+    stream_mgmt_acked("2");
+
+    GList *unacked = stream_mgmt_get_unacked();
+    assert_int_equal(1, g_list_length(unacked));
+    assert_string_equal("msg3", unacked->data);
+}
+
+void stream_mgmt_ack_counts_from_previous_ack(void **state)
+{
+    stream_mgmt_enabled();
+    _queue(3);
+
+    stream_mgmt_acked("1");
+    stream_mgmt_acked("2");
+
+    GList *unacked = stream_mgmt_get_unacked();
+    assert_int_equal(1, g_list_length(unacked));
+    assert_string_equal("msg3", unacked->data);
+}
+
+void stream_mgmt_over_ack_empties_queue(void **state)
+{
+    stream_mgmt_enabled();
+    _queue(2);
+
+    stream_mgmt_acked("5");
+
+    assert_false(stream_mgmt_has_unacked());
+
+    // later counts carry on from what the server reported
+    _queue(1);
+    stream_mgmt_acked("6");
+
+    assert_false(stream_mgmt_has_unacked());
+}
+
+void stream_mgmt_ack_wraps_around(void **state)
+{
+    stream_mgmt_enabled();
+    stream_mgmt_acked("4294967294");
+    _queue(3);
+
+    stream_mgmt_acked("1");
+
+    assert_false(stream_mgmt_has_unacked());
+}
+
+void stream_mgmt_ack_without_h_keeps_queue(void **state)
+{
+    stream_mgmt_enabled();
+    _queue(2);
+
+    stream_mgmt_acked(NULL);
+
+    assert_int_equal(2, g_list_length(stream_mgmt_get_unacked()));
+}
+
+void stream_mgmt_take_unacked_leaves_empty_queue(void **state)
+{
+    stream_mgmt_enabled();
+    _queue(2);
+
+    GQueue *unacked = stream_mgmt_take_unacked();
+
+    assert_int_equal(2, g_queue_get_length(unacked));
+    assert_false(stream_mgmt_has_unacked());
+
+    g_queue_foreach(unacked, (GFunc)free, NULL);
+    g_queue_free(unacked);
+}
+
+void stream_mgmt_counts_handled_from_enabled(void **state)
+{
+    stream_mgmt_handled();
+    stream_mgmt_enabled();
+    stream_mgmt_handled();
+    stream_mgmt_handled();
+
+    assert_int_equal(2, stream_mgmt_get_handled());
+}
+
+void stream_mgmt_clear_forgets_stream(void **state)
+{
+    stream_mgmt_enabled();
+    _queue(2);
+    stream_mgmt_handled();
+
+    stream_mgmt_clear();
+
+    assert_false(stream_mgmt_has_unacked());
+    assert_int_equal(0, stream_mgmt_get_handled());
+}
+
+void stream_mgmt_ack_after_clear_counts_from_zero(void **state)
+{
+    stream_mgmt_enabled();
+    _queue(2);
+    stream_mgmt_acked("2");
+
+    // a new stream starts its count again
+    stream_mgmt_clear();
+    stream_mgmt_enabled();
+    _queue(2);
+    stream_mgmt_acked("1");
+
+    GList *unacked = stream_mgmt_get_unacked();
+    assert_int_equal(1, g_list_length(unacked));
+    assert_string_equal("msg2", unacked->data);
+}
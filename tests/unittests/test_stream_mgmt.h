@@ -0,0 +1,11 @@
+void create_stream_mgmt(void **state);
+void remove_stream_mgmt(void **state);
+void stream_mgmt_ack_drops_handled_stanzas(void **state);
+void stream_mgmt_ack_counts_from_previous_ack(void **state);
+void stream_mgmt_over_ack_empties_queue(void **state);
+void stream_mgmt_ack_wraps_around(void **state);
+void stream_mgmt_ack_without_h_keeps_queue(void **state);
+void stream_mgmt_take_unacked_leaves_empty_queue(void **state);
+void stream_mgmt_counts_handled_from_enabled(void **state);
+void stream_mgmt_clear_forgets_stream(void **state);
+void stream_mgmt_ack_after_clear_counts_from_zero(void **state);
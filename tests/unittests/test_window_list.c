@@ -0,0 +1,177 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "ui/ui.h"
+#include "ui/window_list.h"
+#include "xmpp/xmpp.h"
+#include "xmpp/roster_list.h"
+
+static ProfWin*
+_console(void)
+{
+    ProfConsoleWin *console = malloc(sizeof(ProfConsoleWin));
+    console->window.type = WIN_CONSOLE;
+
+    return &console->window;
+}
+
+static ProfWin*
+_chat(const char *const barejid)
+{
+    ProfChatWin *chatwin = calloc(1, sizeof(ProfChatWin));
+    chatwin->window.type = WIN_CHAT;
+    chatwin->barejid = strdup(barejid);
+    chatwin->memcheck = PROFCHATWIN_MEMCHECK;
+
+    return &chatwin->window;
+}
+
+static ProfWin*
+_muc(const char *const roomjid)
+{
+    ProfMucWin *mucwin = calloc(1, sizeof(ProfMucWin));
+    mucwin->window.type = WIN_MUC;
+    mucwin->roomjid = strdup(roomjid);
+    mucwin->memcheck = PROFMUCWIN_MEMCHECK;
+
+    return &mucwin->window;
+}
+
+static ProfWin*
+_muc_conf(const char *const roomjid)
+{
+    ProfMucConfWin *confwin = calloc(1, sizeof(ProfMucConfWin));
+    confwin->window.type = WIN_MUC_CONFIG;
+    confwin->roomjid = strdup(roomjid);
+    confwin->memcheck = PROFCONFWIN_MEMCHECK;
+
+    return &confwin->window;
+}
+
+static ProfWin*
+_private(const char *const fulljid)
+{
+    ProfPrivateWin *privwin = calloc(1, sizeof(ProfPrivateWin));
+    privwin->window.type = WIN_PRIVATE;
+    privwin->fulljid = strdup(fulljid);
+    privwin->memcheck = PROFPRIVATEWIN_MEMCHECK;
+
+    return &privwin->window;
+}
+
+static ProfWin*
+_plugin(const char *const plugin_name, const char *const tag)
+{
+    ProfPluginWin *pluginwin = calloc(1, sizeof(ProfPluginWin));
+    pluginwin->super.type = WIN_PLUGIN;
+    pluginwin->plugin_name = strdup(plugin_name);
+    pluginwin->tag = strdup(tag);
+    pluginwin->memcheck = PROFPLUGINWIN_MEMCHECK;
+
+    return &pluginwin->super;
+}
+
+void create_window_list(void **state)
+{
+    roster_create();
+    will_return(win_create_console, _console());
+    wins_init();
+}
+
+void destroy_window_list(void **state)
+{
+    wins_destroy();
+    roster_destroy();
+}
+
+void finds_new_windows_by_jid_and_tag(void **state)
+{
+    will_return(win_create_chat, _chat("bob@server.org"));
+    ProfWin *chat = wins_new_chat("bob@server.org");
+    will_return(win_create_muc, _muc("room@conference.server.org"));
+    ProfWin *muc = wins_new_muc("room@conference.server.org");
+    will_return(win_create_muc_config, _muc_conf("room@conference.server.org"));
+    ProfWin *muc_conf = wins_new_muc_config("room@conference.server.org", NULL);
+    will_return(win_create_private, _private("room@conference.server.org/mike"));
+    ProfWin *private = wins_new_private("room@conference.server.org/mike");
+    will_return(win_create_plugin, _plugin("plugin.py", "tag"));
+    ProfWin *plugin = wins_new_plugin("plugin.py", "tag");
+
+    assert_ptr_equal(chat, wins_get_chat("bob@server.org"));
+    assert_ptr_equal(muc, wins_get_muc("room@conference.server.org"));
+    assert_ptr_equal(muc_conf, wins_get_muc_conf("room@conference.server.org"));
+    assert_ptr_equal(private, wins_get_private("room@conference.server.org/mike"));
+    assert_ptr_equal(plugin, wins_get_plugin("tag"));
+    assert_true(wins_chat_exists("bob@server.org"));
+}
+
+void returns_null_for_unknown_windows(void **state)
+{
+    will_return(win_create_chat, _chat("bob@server.org"));
+    wins_new_chat("bob@server.org");
+
+    assert_null(wins_get_chat("alice@server.org"));
+    assert_null(wins_get_chat(NULL));
+    assert_null(wins_get_muc("bob@server.org"));
+    assert_null(wins_get_private("bob@server.org"));
+    assert_null(wins_get_plugin("bob@server.org"));
+    assert_false(wins_chat_exists("alice@server.org"));
+}
+
+void closed_window_not_found(void **state)
+{
+    will_return(win_create_chat, _chat("bob@server.org"));
+    ProfWin *chat = wins_new_chat("bob@server.org");
+    will_return(win_create_private, _private("room@conference.server.org/mike"));
+    ProfWin *private = wins_new_private("room@conference.server.org/mike");
+
+    will_return(connection_get_status, JABBER_DISCONNECTED);
+    wins_close_by_num(wins_get_num(chat));
+
+    assert_null(wins_get_chat("bob@server.org"));
+    assert_ptr_equal(private, wins_get_private("room@conference.server.org/mike"));
+}
+
+void reopened_window_replaces_closed_window(void **state)
+{
+    will_return(win_create_muc, _muc("room@conference.server.org"));
+    ProfWin *muc1 = wins_new_muc("room@conference.server.org");
+    wins_close_by_num(wins_get_num(muc1));
+
+    will_return(win_create_muc, _muc("room@conference.server.org"));
+    ProfWin *muc2 = wins_new_muc("room@conference.server.org");
+
+    assert_ptr_equal(muc2, wins_get_muc("room@conference.server.org"));
+}
+
+void private_window_found_by_new_nick(void **state)
+{
+    will_return(win_create_private, _private("room@conference.server.org/mike"));
+    ProfWin *private = wins_new_private("room@conference.server.org/mike");
+
+    wins_private_nick_change("room@conference.server.org", "mike", "mikey");
+
+    assert_null(wins_get_private("room@conference.server.org/mike"));
+    assert_ptr_equal(private, wins_get_private("room@conference.server.org/mikey"));
+    assert_string_equal("room@conference.server.org/mikey", ((ProfPrivateWin*)private)->fulljid);
+}
+
+void swapped_window_still_found(void **state)
+{
+    will_return(win_create_chat, _chat("bob@server.org"));
+    ProfWin *chat = wins_new_chat("bob@server.org");
+    will_return(win_create_chat, _chat("alice@server.org"));
+    ProfWin *other = wins_new_chat("alice@server.org");
+
+    wins_swap(wins_get_num(chat), 5);
+    wins_swap(wins_get_num(other), 5);
+
+    assert_int_equal(5, wins_get_num(other));
+    assert_ptr_equal(chat, wins_get_chat("bob@server.org"));
+    assert_ptr_equal(other, wins_get_chat("alice@server.org"));
+}
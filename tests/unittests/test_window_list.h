@@ -0,0 +1,8 @@
+void create_window_list(void **state);
+void destroy_window_list(void **state);
+void finds_new_windows_by_jid_and_tag(void **state);
+void returns_null_for_unknown_windows(void **state);
+void closed_window_not_found(void **state);
+void reopened_window_replaces_closed_window(void **state);
+void private_window_found_by_new_nick(void **state);
+void swapped_window_still_found(void **state);
@@ -83,6 +83,15 @@ void chatwin_set_outgoing_char(ProfChatWin *chatwin, const char *const ch) {}
 void chatwin_unset_outgoing_char(ProfChatWin *chatwin) {}
 
 void ui_sigwinch_handler(int sig) {}
+gint ui_frame_timeout(void)
+{
+    return -1;
+}
+
+int ui_get_resize_fd(void)
+{
+    return -1;
+}
 
 unsigned long ui_get_idle_time(void)
 {
@@ -165,6 +174,10 @@ void ui_contact_online(char *barejid, Resource *resource, GDateTime *last_activi
 void ui_contact_typing(const char * const barejid, const char * const resource) {}
 void chatwin_incoming_msg(ProfChatWin *chatwin, const char * const resource, const char * const message, GDateTime *timestamp, gboolean win_created, prof_enc_t enc_mode) {}
 void chatwin_receipt_received(ProfChatWin *chatwin, const char * const id) {}
+gboolean chatwin_history_page_up(ProfChatWin *chatwin)
+{
+    return FALSE;
+}
 
 void privwin_incoming_msg(ProfPrivateWin *privatewin, const char * const message, GDateTime *timestamp) {}
 
@@ -300,12 +313,16 @@ void ui_handle_login_account_success(ProfAccount *account, int secured) {}
 void ui_update_presence(const resource_presence_t resource_presence,
     const char * const message, const char * const show) {}
 
-char* inp_readline(void)
+char* inp_readline(gint timeout)
 {
     return NULL;
 }
 
 void inp_nonblocking(gboolean reset) {}
+gint inp_get_timeout(void)
+{
+    return 0;
+}
 
 void ui_inp_history_append(char *inp) {}
 
@@ -435,6 +452,7 @@ void cons_occupants_setting(void) {}
 void cons_roster_setting(void) {}
 void cons_presence_setting(void) {}
 void cons_wrap_setting(void) {}
+void cons_fuzzy_setting(void) {}
 void cons_winstidy_setting(void) {}
 void cons_encwarn_setting(void) {}
 void cons_time_setting(void) {}
@@ -457,6 +475,7 @@ void cons_reconnect_setting(void) {}
 void cons_autoping_setting(void) {}
 void cons_autoconnect_setting(void) {}
 void cons_inpblock_setting(void) {}
+void cons_maxfps_setting(void) {}
 void cons_tray_setting(void) {}
 
 void cons_show_contact_online(PContact contact, Resource *resource, GDateTime *last_activity)
@@ -478,12 +497,18 @@ void status_bar_inactive(const int win) {}
 void status_bar_active(const int win) {}
 void status_bar_new(const int win) {}
 void status_bar_set_all_inactive(void) {}
+int status_bar_clock_timeout(void)
+{
+    return -1;
+}
 
 // roster window
 void rosterwin_roster(void) {}
+void rosterwin_update(void) {}
 
 // occupants window
 void occupantswin_occupants(const char * const room) {}
+void occupantswin_update(void) {}
 
 // window interface
 ProfWin* win_create_console(void)
@@ -500,19 +525,19 @@ ProfWin* win_create_chat(const char * const barejid)
 }
 ProfWin* win_create_muc(const char * const roomjid)
 {
-    return NULL;
+    return (ProfWin*)mock();
 }
 ProfWin* win_create_muc_config(const char * const title, DataForm *form)
 {
-    return NULL;
+    return (ProfWin*)mock();
 }
 ProfWin* win_create_private(const char * const fulljid)
 {
-    return NULL;
+    return (ProfWin*)mock();
 }
 ProfWin* win_create_plugin(const char *const plugin_name, const char * const tag)
 {
-    return NULL;
+    return (ProfWin*)mock();
 }
 
 void win_update_virtual(ProfWin *window) {}
@@ -557,6 +582,10 @@ void notify_message(const char *const name, int win, const char *const text) {}
 void notify_room_message(const char * const handle, const char * const room,
     int win, const char * const text) {}
 void notify_remind(void) {}
+gint notify_remind_timeout(void)
+{
+    return -1;
+}
 void notify_invite(const char * const from, const char * const room,
     const char * const reason) {}
 void notify_subscription(const char * const from) {}
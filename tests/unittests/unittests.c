@@ -36,6 +36,15 @@
 #include "test_form.h"
 #include "test_callbacks.h"
 #include "test_plugins_disco.h"
+#include "test_buffer.h"
+#include "test_matcher.h"
+#include "test_log_index.h"
+#include "test_window_list.h"
+#include "test_capabilities.h"
+#include "test_sig_cache.h"
+#include "test_roster_cache.h"
+#include "test_stanza.h"
+#include "test_stream_mgmt.h"
 
 int main(int argc, char* argv[]) {
     setlocale(LC_ALL, "");
@@ -90,6 +99,18 @@ int main(int argc, char* argv[]) {
         unit_test(add_two_adds_two),
         unit_test(add_two_same_adds_one),
         unit_test(add_two_same_updates),
+        unit_test(complete_cycles_back_to_first_match),
+        unit_test(complete_after_removing_last_found),
+        unit_test(add_many_and_complete),
+        unit_test(fuzzy_matches_subsequence),
+        unit_test(fuzzy_ignores_case),
+        unit_test(fuzzy_ranks_prefix_before_substring),
+        unit_test(fuzzy_ranks_used_items_first),
+        unit_test(fuzzy_keeps_usage_after_clear),
+        unit_test(fuzzy_returns_null_when_no_match),
+        unit_test(fuzzy_finds_item_added_after_search),
+        unit_test(fuzzy_narrows_extended_search),
+        unit_test(fuzzy_typing_stays_within_budget),
 
         unit_test(create_jid_from_null_returns_null),
         unit_test(create_jid_from_empty_string_returns_null),
@@ -200,6 +221,9 @@ int main(int argc, char* argv[]) {
         unit_test(add_contacts_with_same_groups),
         unit_test(add_contacts_with_overlapping_groups),
         unit_test(remove_contact_with_remaining_in_group),
+        unit_test(contacts_reordered_after_name_change),
+        unit_test(contacts_reordered_after_presence_update),
+        unit_test(group_members_follow_group_update),
 
         unit_test_setup_teardown(returns_false_when_chat_session_does_not_exist,
             init_chat_sessions,
@@ -421,6 +445,21 @@ int main(int argc, char* argv[]) {
         unit_test_setup_teardown(statuses_muc_defaults_to_all,
             load_preferences,
             close_preferences),
+        unit_test_setup_teardown(boolean_updated_after_set,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(peek_string_returns_default,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(peek_string_returns_updated_value_after_set,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(get_string_returns_copy_of_cached_value,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(max_fps_updated_after_set,
+            load_preferences,
+            close_preferences),
 
         unit_test_setup_teardown(console_shows_online_presence_when_set_online,
             load_preferences,
@@ -462,6 +501,9 @@ int main(int argc, char* argv[]) {
         unit_test_setup_teardown(test_muc_invites_count_5, muc_before_test, muc_after_test),
         unit_test_setup_teardown(test_muc_room_is_not_active, muc_before_test, muc_after_test),
         unit_test_setup_teardown(test_muc_active, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_roster_sorted_by_nick, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_roster_add_updates_existing_occupant, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_occupants_by_role_sorted_by_nick, muc_before_test, muc_after_test),
 
         unit_test(cmd_bookmark_shows_message_when_disconnected),
         unit_test(cmd_bookmark_shows_message_when_disconnecting),
@@ -592,6 +634,19 @@ int main(int argc, char* argv[]) {
 
         unit_test(returns_no_commands),
         unit_test(returns_commands),
+        unit_test(no_timed_timeout_when_no_timed_functions),
+        unit_test(timed_timeout_is_earliest_due),
+        unit_test(timed_timeout_ignores_removed_plugin),
+        unit_test(timed_function_not_run_before_due),
+        unit_test_setup_teardown(no_hooks_when_no_plugins,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(has_hook_when_plugin_implements_it,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(hook_stats_count_calls,
+            load_preferences,
+            close_preferences),
 
         unit_test(returns_empty_list_when_none),
         unit_test(returns_added_feature),
@@ -600,6 +655,183 @@ int main(int argc, char* argv[]) {
         unit_test(does_not_add_duplicate_feature),
         unit_test(removes_plugin_features),
         unit_test(does_not_remove_feature_when_more_than_one_reference),
+
+        unit_test(empty_buffer_has_size_zero),
+        unit_test(yield_out_of_range_returns_null),
+        unit_test(push_one_and_yield),
+        unit_test(push_keeps_order),
+        unit_test(push_beyond_capacity_evicts_oldest),
+        unit_test(push_many_keeps_last_entries),
+        unit_test(create_with_capacity_sets_capacity),
+        unit_test(yield_by_id_returns_entry),
+        unit_test(yield_by_id_returns_null_when_evicted),
+        unit_test(mark_received_marks_entry),
+        unit_test(mark_received_returns_false_when_already_received),
+        unit_test(yield_by_id_survives_eviction_of_duplicate_id),
+        unit_test(push_front_adds_before_existing),
+        unit_test(push_front_does_nothing_when_full),
+
+        unit_test(matcher_finds_nothing_when_empty),
+        unit_test(matcher_finds_nothing_when_no_match),
+        unit_test(matcher_finds_single_pattern),
+        unit_test(matcher_finds_overlapping_patterns),
+        unit_test(matcher_finds_repeated_pattern),
+        unit_test(matcher_reports_each_id_for_same_pattern),
+        unit_test(matcher_reports_character_offsets),
+        unit_test(matcher_finds_patterns_added_after_search),
+
+        unit_test_setup_teardown(search_finds_backfilled_line,
+            create_log_index_dir,
+            remove_log_index_dir),
+        unit_test_setup_teardown(search_finds_room_line,
+            create_log_index_dir,
+            remove_log_index_dir),
+        unit_test_setup_teardown(search_ignores_case_and_punctuation,
+            create_log_index_dir,
+            remove_log_index_dir),
+        unit_test_setup_teardown(search_skips_timestamp_and_short_tokens,
+            create_log_index_dir,
+            remove_log_index_dir),
+        unit_test_setup_teardown(search_requires_all_tokens,
+            create_log_index_dir,
+            remove_log_index_dir),
+        unit_test_setup_teardown(search_returns_latest_matches_up_to_max,
+            create_log_index_dir,
+            remove_log_index_dir),
+        unit_test_setup_teardown(add_line_indexes_next_line,
+            create_log_index_dir,
+            remove_log_index_dir),
+        unit_test_setup_teardown(add_line_after_gap_is_indexed_when_flushed,
+            create_log_index_dir,
+            remove_log_index_dir),
+        unit_test_setup_teardown(backfill_resumes_from_indexed_offset,
+            create_log_index_dir,
+            remove_log_index_dir),
+        unit_test_setup_teardown(backfill_skips_unterminated_line,
+            create_log_index_dir,
+            remove_log_index_dir),
+        unit_test_setup_teardown(connect_twice_keeps_one_index,
+            create_log_index_dir,
+            remove_log_index_dir),
+        unit_test_setup_teardown(index_is_kept_in_segments_across_connects,
+            create_log_index_dir,
+            remove_log_index_dir),
+
+        unit_test_setup_teardown(finds_new_windows_by_jid_and_tag,
+            create_window_list,
+            destroy_window_list),
+        unit_test_setup_teardown(returns_null_for_unknown_windows,
+            create_window_list,
+            destroy_window_list),
+        unit_test_setup_teardown(closed_window_not_found,
+            create_window_list,
+            destroy_window_list),
+        unit_test_setup_teardown(reopened_window_replaces_closed_window,
+            create_window_list,
+            destroy_window_list),
+        unit_test_setup_teardown(private_window_found_by_new_nick,
+            create_window_list,
+            destroy_window_list),
+        unit_test_setup_teardown(swapped_window_still_found,
+            create_window_list,
+            destroy_window_list),
+
+        unit_test_setup_teardown(caps_cache_loads_saved_entries,
+            create_caps_cache,
+            remove_caps_cache),
+        unit_test_setup_teardown(caps_cache_truncates_damaged_tail,
+            create_caps_cache,
+            remove_caps_cache),
+        unit_test_setup_teardown(caps_cache_truncates_damaged_record,
+            create_caps_cache,
+            remove_caps_cache),
+        unit_test_setup_teardown(caps_cache_discards_unknown_format,
+            create_caps_cache,
+            remove_caps_cache),
+        unit_test_setup_teardown(caps_cache_migrates_key_file,
+            create_caps_cache,
+            remove_caps_cache),
+
+#ifdef HAVE_LIBGPGME
+        unit_test_setup_teardown(sig_cache_finds_added_signature,
+            create_sig_cache,
+            remove_sig_cache),
+        unit_test_setup_teardown(sig_cache_separates_contacts,
+            create_sig_cache,
+            remove_sig_cache),
+        unit_test_setup_teardown(sig_cache_drops_add_after_clear,
+            create_sig_cache,
+            remove_sig_cache),
+        unit_test_setup_teardown(sig_cache_evicts_least_recently_used,
+            create_sig_cache,
+            remove_sig_cache),
+        unit_test_setup_teardown(sig_cache_keeps_entries_after_save_and_load,
+            create_sig_cache,
+            remove_sig_cache),
+        unit_test_setup_teardown(sig_cache_keeps_recent_use_after_save_and_load,
+            create_sig_cache,
+            remove_sig_cache),
+#endif
+
+        unit_test_setup_teardown(roster_cache_not_loaded_when_missing,
+            create_roster_cache,
+            remove_roster_cache),
+        unit_test_setup_teardown(roster_cache_loads_saved_contacts,
+            create_roster_cache,
+            remove_roster_cache),
+        unit_test_setup_teardown(roster_cache_keeps_jids_with_brackets,
+            create_roster_cache,
+            remove_roster_cache),
+        unit_test_setup_teardown(roster_cache_saves_pushes_on_close,
+            create_roster_cache,
+            remove_roster_cache),
+        unit_test_setup_teardown(roster_cache_removed_when_roster_unversioned,
+            create_roster_cache,
+            remove_roster_cache),
+
+        unit_test_setup_teardown(roster_iq_has_no_ver_when_not_cached,
+            create_xmpp_ctx,
+            free_xmpp_ctx),
+        unit_test_setup_teardown(roster_iq_has_cached_ver,
+            create_xmpp_ctx,
+            free_xmpp_ctx),
+        unit_test_setup_teardown(sm_enable_does_not_ask_resume,
+            create_xmpp_ctx,
+            free_xmpp_ctx),
+        unit_test_setup_teardown(sm_request_has_no_h,
+            create_xmpp_ctx,
+            free_xmpp_ctx),
+        unit_test_setup_teardown(sm_ack_has_h,
+            create_xmpp_ctx,
+            free_xmpp_ctx),
+
+        unit_test_setup_teardown(stream_mgmt_ack_drops_handled_stanzas,
+            create_stream_mgmt,
+            remove_stream_mgmt),
+        unit_test_setup_teardown(stream_mgmt_ack_counts_from_previous_ack,
+            create_stream_mgmt,
+            remove_stream_mgmt),
+        unit_test_setup_teardown(stream_mgmt_over_ack_empties_queue,
+            create_stream_mgmt,
+            remove_stream_mgmt),
+        unit_test_setup_teardown(stream_mgmt_ack_wraps_around,
+            create_stream_mgmt,
+            remove_stream_mgmt),
+        unit_test_setup_teardown(stream_mgmt_ack_without_h_keeps_queue,
+            create_stream_mgmt,
+            remove_stream_mgmt),
+        unit_test_setup_teardown(stream_mgmt_take_unacked_leaves_empty_queue,
+            create_stream_mgmt,
+            remove_stream_mgmt),
+        unit_test_setup_teardown(stream_mgmt_counts_handled_from_enabled,
+            create_stream_mgmt,
+            remove_stream_mgmt),
+        unit_test_setup_teardown(stream_mgmt_clear_forgets_stream,
+            create_stream_mgmt,
+            remove_stream_mgmt),
+        unit_test_setup_teardown(stream_mgmt_ack_after_clear_counts_from_zero,
+            create_stream_mgmt,
+            remove_stream_mgmt),
     };
 
     return run_tests(all_tests);
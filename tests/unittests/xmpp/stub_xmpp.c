@@ -9,6 +9,10 @@
 void session_init(void) {}
 void session_init_activity(void) {}
 void session_check_autoaway(void) {}
+gint session_reconnect_timeout(void)
+{
+    return -1;
+}
 
 jabber_conn_status_t session_connect_with_details(const char * const jid,
     const char * const passwd, const char * const altdomain, const int port, const char *const tls_policy)
@@ -204,22 +208,6 @@ void iq_room_role_list(const char * const room, char *role) {}
 void iq_last_activity_request(gchar *jid) {}
 void iq_autoping_check(void) {}
 
-// caps functions
-void caps_add_feature(char *feature) {}
-void caps_remove_feature(char *feature) {}
-EntityCapabilities* caps_lookup(const char * const jid)
-{
-    return NULL;
-}
-
-void caps_close(void) {}
-void caps_destroy(EntityCapabilities *caps) {}
-void caps_reset_ver(void) {}
-gboolean caps_jid_has_feature(const char *const jid, const char *const feature)
-{
-    return FALSE;
-}
-
 gboolean bookmark_add(const char *jid, const char *nick, const char *password, const char *autojoin_str)
 {
     check_expected(jid);